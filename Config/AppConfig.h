@@ -0,0 +1,80 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Application Configuration Header File
+ *
+ *  This is a header file which is be used to configure some of
+ *  the application's compile time options, as an alternative to
+ *  specifying the compile time constants supplied through a
+ *  makefile or build system.
+ *
+ *  For information on what each token does, refer to the
+ *  \ref Sec_Options section of the application documentation.
+ */
+
+#ifndef _APP_CONFIG_H_
+#define _APP_CONFIG_H_
+
+	#define USART_TO_USB_BUFFER_SIZE         1024
+	#define USB_TO_USART_BUFFER_SIZE         256
+//	#define CDC_TXRX_EPBANKS                 2
+	#define USE_LOCKFREE_RING_BUFFER
+
+	#define TIMER1_PRESCALER                 8
+
+	#define RX_TIMEOUT_POLICY                RX_TIMEOUT_POLICY_CharTimes
+	#define RX_TIMEOUT_FIXED_US              500
+	#define RX_TIMEOUT_CHAR_TIMES            3
+	#define RX_TIMEOUT_EWMA_SHIFT            3
+	#define RX_TIMEOUT_EWMA_GAPS             4
+
+//	#define SOF_FLUSH_SCHEDULER
+	#define SOF_FLUSH_LEAD_US                100
+
+	#define FLOW_CONTROL                     FLOW_CONTROL_None
+	#define FLOW_CONTROL_HIGH_WATERMARK      (USART_TO_USB_BUFFER_SIZE * 3 / 4)
+	#define FLOW_CONTROL_LOW_WATERMARK       (USART_TO_USB_BUFFER_SIZE / 4)
+	#define FLOW_CONTROL_RTS_PORT            PORTB
+	#define FLOW_CONTROL_RTS_DDR             DDRB
+	#define FLOW_CONTROL_RTS_MASK            (1 << 7)
+	#define FLOW_CONTROL_CTS_PIN             PIND
+	#define FLOW_CONTROL_CTS_PORT            PORTD
+	#define FLOW_CONTROL_CTS_DDR             DDRD
+	#define FLOW_CONTROL_CTS_MASK            (1 << 5)
+
+	#define LINE_CODING_MAX_ERROR_PERMILLE   40
+
+	#define EVENT_CHAR_FLUSH
+
+	#define LATENCY_TRACE
+	#define LATENCY_TRACE_SAMPLE_SHIFT       5
+
+#endif
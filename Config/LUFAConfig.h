@@ -57,7 +57,7 @@
 //		#define NO_CLASS_DRIVER_AUTOFLUSH
 
 		/* General USB Driver Related Tokens: */
-//		#define ORDERED_EP_CONFIG
+		#define ORDERED_EP_CONFIG
 		#define USE_STATIC_OPTIONS               (USB_DEVICE_OPT_FULLSPEED | USB_OPT_REG_ENABLED | USB_OPT_AUTO_PLL)
 		#define USB_DEVICE_ONLY
 //		#define USB_HOST_ONLY
@@ -75,6 +75,8 @@
 		#define FIXED_NUM_CONFIGURATIONS         1
 //		#define CONTROL_ONLY_DEVICE
 		#define INTERRUPT_CONTROL_ENDPOINT
+//		#define INTERRUPT_DATA_ENDPOINTS
+//		#define DEFERRED_DEVICE_EVENTS           (USB_DEVICE_EVENT_Connect | USB_DEVICE_EVENT_Disconnect | USB_DEVICE_EVENT_Reset)
 //		#define NO_DEVICE_REMOTE_WAKEUP
 //		#define NO_DEVICE_SELF_POWER
 
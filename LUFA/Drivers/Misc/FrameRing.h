@@ -0,0 +1,502 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Variable length frame ring buffer, for queuing whole packets in a single storage array.
+ *
+ *  Frame ring buffer, storing length-prefixed variable length records in one contiguous storage array so
+ *  that frame boundaries are preserved without a fixed size slot per frame.
+ */
+
+/** \ingroup Group_MiscDrivers
+ *  \defgroup Group_FrameRing Variable Length Frame Ring Buffer - LUFA/Drivers/Misc/FrameRing.h
+ *  \brief Ring buffer of variable length frames.
+ *
+ *  \section Sec_FrameRing_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - None
+ *
+ *  \section Sec_FrameRing_ModDescription Module Description
+ *  Ring buffer of variable length frames, for protocols which must preserve packet boundaries such as RNDIS,
+ *  MIDI or a framed serial link. Each frame is stored as a two byte length prefix followed by its payload, in
+ *  a single storage array shared by all frames, so that many short frames or a few long ones may be buffered
+ *  in the same memory.
+ *
+ *  Every frame is kept contiguous in the storage array. When a frame does not fit in the space remaining before
+ *  the end of the array, that space is skipped and the frame is stored from the start of the array instead. This
+ *  allows frames to be written in place through \ref FrameRing_Reserve() and \ref FrameRing_Commit(), and read in
+ *  place through \ref FrameRing_Peek() and \ref FrameRing_Release(), without an intermediate copy. A frame may
+ *  therefore be at most half the size of the storage array minus its prefix to be guaranteed to eventually fit.
+ *
+ *  When a new frame does not fit, the buffer either rejects it (\ref FRAME_RING_POLICY_DropNewest) or discards
+ *  the oldest stored frames until it does (\ref FRAME_RING_POLICY_DropOldest). Either way the number of dropped
+ *  frames is counted, and the memory used never exceeds the storage array.
+ *
+ *  As with the \ref Group_RingBuff module, insertion and removal may occur from different execution threads, but
+ *  only one thread may insert and only one may remove from a single buffer. The shared counters are updated once
+ *  per frame inside a short atomic lock.
+ *
+ *  \section Sec_FrameRing_ExampleUsage Example Usage
+ *  The following snippet is an example of how this module may be used within a typical
+ *  application.
+ *
+ *  \code
+ *      // Create the buffer structure and its underlying storage array
+ *      FrameRing_t Buffer;
+ *      uint8_t     BufferData[512];
+ *
+ *      // Initialize the buffer with the created storage array
+ *      FrameRing_InitBuffer(&Buffer, BufferData, sizeof(BufferData), FRAME_RING_POLICY_DropNewest);
+ *
+ *      // Build a frame in place, then make it visible to the reader with its final length
+ *      uint8_t* Frame = FrameRing_Reserve(&Buffer, 64);
+ *
+ *      if (Frame)
+ *      {
+ *          uint16_t FrameLength = BuildFrame(Frame, 64);
+ *          FrameRing_Commit(&Buffer, FrameLength);
+ *      }
+ *
+ *      // Process each stored frame in place, then release it
+ *      uint16_t FrameLength;
+ *
+ *      while ((Frame = FrameRing_Peek(&Buffer, &FrameLength)) != NULL)
+ *      {
+ *          ProcessFrame(Frame, FrameLength);
+ *          FrameRing_Release(&Buffer);
+ *      }
+ *  \endcode
+ *
+ *  @{
+ */
+
+#ifndef __FRAME_RING_H__
+#define __FRAME_RING_H__
+
+	/* Includes: */
+		#include "../../Common/Common.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Number of bytes of storage used by the length prefix of each frame. */
+			#define FRAME_RING_PREFIX_SIZE        2
+
+			/** Maximum length of a single frame's payload, in bytes. */
+			#define FRAME_RING_MAX_FRAME_LENGTH   0xFFFE
+
+		/* Enums: */
+			/** Enum for the possible policies applied when a new frame does not fit in a \ref FrameRing_t buffer. */
+			enum FrameRing_Policies_t
+			{
+				FRAME_RING_POLICY_DropNewest = 0, /**< The new frame is rejected, stored frames are kept. */
+				FRAME_RING_POLICY_DropOldest = 1, /**< The oldest stored frames are discarded until the new frame fits.
+				                                   *
+				                                   *   \warning As this removes frames from the inserting thread, it may
+				                                   *            only be used when the same thread also removes frames,
+				                                   *            or while the removing thread is not processing a frame.
+				                                   */
+			};
+
+		/* Type Defines: */
+			/** \brief Frame Ring Buffer Management Structure.
+			 *
+			 *  Type define for a new frame ring buffer object. Buffers should be initialized via a call to
+			 *  \ref FrameRing_InitBuffer() before use.
+			 */
+			typedef struct
+			{
+				uint8_t* Start; /**< Pointer to the start of the buffer's underlying storage array. */
+				uint16_t Size; /**< Size of the buffer's underlying storage array. */
+				uint16_t In; /**< Offset at which the next frame is stored, private to the inserting thread. */
+				uint16_t Out; /**< Offset of the next frame to be removed, private to the removing thread. */
+				uint16_t Used; /**< Number of bytes of the storage array occupied by stored frames and skipped space. */
+				uint16_t Frames; /**< Number of frames currently stored in the buffer. */
+				uint16_t Dropped; /**< Number of frames dropped due to lack of space, saturating at 0xFFFF. */
+				uint16_t ReservedOffset; /**< Offset of the frame currently reserved by the inserting thread. */
+				uint16_t ReservedSkip; /**< Bytes skipped before the end of the array for the reserved frame. */
+				uint8_t  Policy; /**< Policy applied when a new frame does not fit, a value from \ref FrameRing_Policies_t. */
+			} FrameRing_t;
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#define FRAME_RING_SKIP_MARKER        0xFFFF
+
+		/* Inline Functions: */
+			static inline uint16_t FrameRing_ReadPrefix(const uint8_t* const Prefix) ATTR_ALWAYS_INLINE;
+			static inline uint16_t FrameRing_ReadPrefix(const uint8_t* const Prefix)
+			{
+				return (Prefix[0] | ((uint16_t)Prefix[1] << 8));
+			}
+
+			static inline void FrameRing_WritePrefix(uint8_t* const Prefix,
+			                                         const uint16_t Length) ATTR_ALWAYS_INLINE;
+			static inline void FrameRing_WritePrefix(uint8_t* const Prefix,
+			                                         const uint16_t Length)
+			{
+				Prefix[0] = (Length & 0xFF);
+				Prefix[1] = (Length >> 8);
+			}
+
+			static inline uint16_t FrameRing_GetUsed(FrameRing_t* const Buffer) ATTR_ALWAYS_INLINE;
+			static inline uint16_t FrameRing_GetUsed(FrameRing_t* const Buffer)
+			{
+				uint16_t Used;
+
+				uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+				GlobalInterruptDisable();
+
+				Used = Buffer->Used;
+
+				SetGlobalInterruptMask(CurrentGlobalInt);
+				return Used;
+			}
+
+			static inline void FrameRing_CountDrop(FrameRing_t* const Buffer) ATTR_ALWAYS_INLINE;
+			static inline void FrameRing_CountDrop(FrameRing_t* const Buffer)
+			{
+				uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+				GlobalInterruptDisable();
+
+				if (Buffer->Dropped != 0xFFFF)
+				  Buffer->Dropped++;
+
+				SetGlobalInterruptMask(CurrentGlobalInt);
+			}
+	#endif
+
+	/* Inline Functions: */
+		/** Initializes a frame ring buffer ready for use. Buffers must be initialized via this function
+		 *  before any operations are called upon them. Already initialized buffers may be reset
+		 *  by re-initializing them using this function.
+		 *
+		 *  \param[out] Buffer   Pointer to a frame ring buffer structure to initialize.
+		 *  \param[out] DataPtr  Pointer to a global array that will hold the frames stored into the buffer.
+		 *  \param[in]  Size     Number of bytes in the underlying data array, including the frame length prefixes.
+		 *  \param[in]  Policy   Policy applied when a new frame does not fit, a value from \ref FrameRing_Policies_t.
+		 */
+		static inline void FrameRing_InitBuffer(FrameRing_t* Buffer,
+		                                        uint8_t* const DataPtr,
+		                                        const uint16_t Size,
+		                                        const uint8_t Policy) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline void FrameRing_InitBuffer(FrameRing_t* Buffer,
+		                                        uint8_t* const DataPtr,
+		                                        const uint16_t Size,
+		                                        const uint8_t Policy)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Buffer->Start          = DataPtr;
+			Buffer->Size           = Size;
+			Buffer->In             = 0;
+			Buffer->Out            = 0;
+			Buffer->Used           = 0;
+			Buffer->Frames         = 0;
+			Buffer->Dropped        = 0;
+			Buffer->ReservedOffset = 0;
+			Buffer->ReservedSkip   = 0;
+			Buffer->Policy         = Policy;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+		}
+
+		/** Retrieves the current number of frames stored in a particular buffer. This value is computed
+		 *  by entering an atomic lock on the buffer.
+		 *
+		 *  \param[in] Buffer  Pointer to a frame ring buffer structure whose frame count is to be retrieved.
+		 *
+		 *  \return Number of frames currently stored in the buffer.
+		 */
+		static inline uint16_t FrameRing_GetFrameCount(FrameRing_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t FrameRing_GetFrameCount(FrameRing_t* const Buffer)
+		{
+			uint16_t Frames;
+
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Frames = Buffer->Frames;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+			return Frames;
+		}
+
+		/** Atomically determines if the specified frame ring buffer contains any frames.
+		 *
+		 *  \param[in] Buffer  Pointer to a frame ring buffer structure to check.
+		 *
+		 *  \return Boolean \c true if the buffer contains no frames, \c false otherwise.
+		 */
+		static inline bool FrameRing_IsEmpty(FrameRing_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline bool FrameRing_IsEmpty(FrameRing_t* const Buffer)
+		{
+			return (FrameRing_GetFrameCount(Buffer) == 0);
+		}
+
+		/** Retrieves the number of frames dropped by a particular buffer since it was initialized, saturating
+		 *  at 0xFFFF.
+		 *
+		 *  \param[in] Buffer  Pointer to a frame ring buffer structure whose drop count is to be retrieved.
+		 *
+		 *  \return Number of frames dropped due to lack of space.
+		 */
+		static inline uint16_t FrameRing_GetDroppedCount(FrameRing_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t FrameRing_GetDroppedCount(FrameRing_t* const Buffer)
+		{
+			uint16_t Dropped;
+
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Dropped = Buffer->Dropped;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+			return Dropped;
+		}
+
+		/** Returns the next frame stored in the buffer, without removing it. The frame's payload may be processed
+		 *  in place until it is released via a call to \ref FrameRing_Release().
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may remove from a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a frame ring buffer structure to retrieve from.
+		 *  \param[out]    Length  Pointer to a location where the length of the frame's payload is stored.
+		 *
+		 *  \return Pointer to the frame's payload, or \c NULL if the buffer contains no frames.
+		 */
+		static inline uint8_t* FrameRing_Peek(FrameRing_t* const Buffer,
+		                                      uint16_t* const Length) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint8_t* FrameRing_Peek(FrameRing_t* const Buffer,
+		                                      uint16_t* const Length)
+		{
+			if (FrameRing_IsEmpty(Buffer))
+			  return NULL;
+
+			uint16_t BytesToEnd = (Buffer->Size - Buffer->Out);
+
+			/* Skip the unused space left before the end of the array when the writer wrapped around */
+			if ((BytesToEnd < FRAME_RING_PREFIX_SIZE) ||
+			    (FrameRing_ReadPrefix(&Buffer->Start[Buffer->Out]) == FRAME_RING_SKIP_MARKER))
+			{
+				Buffer->Out = 0;
+
+				uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+				GlobalInterruptDisable();
+
+				Buffer->Used -= BytesToEnd;
+
+				SetGlobalInterruptMask(CurrentGlobalInt);
+			}
+
+			*Length = FrameRing_ReadPrefix(&Buffer->Start[Buffer->Out]);
+			return &Buffer->Start[Buffer->Out + FRAME_RING_PREFIX_SIZE];
+		}
+
+		/** Removes the frame last returned by \ref FrameRing_Peek() from the buffer, freeing its storage.
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may remove from a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a frame ring buffer structure to remove from.
+		 */
+		static inline void FrameRing_Release(FrameRing_t* const Buffer) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void FrameRing_Release(FrameRing_t* const Buffer)
+		{
+			uint16_t RecordSize = (FRAME_RING_PREFIX_SIZE + FrameRing_ReadPrefix(&Buffer->Start[Buffer->Out]));
+
+			Buffer->Out += RecordSize;
+
+			if (Buffer->Out == Buffer->Size)
+			  Buffer->Out = 0;
+
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Buffer->Used -= RecordSize;
+			Buffer->Frames--;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+		}
+
+		/** Reserves contiguous space for a new frame in the buffer, so that it may be written in place. The frame
+		 *  becomes visible to the removing thread once it is committed via a call to \ref FrameRing_Commit(); a
+		 *  reservation that is not committed is simply abandoned by the next call to this function.
+		 *
+		 *  If the frame does not fit, the buffer's policy is applied: under \ref FRAME_RING_POLICY_DropNewest no
+		 *  space is reserved, and under \ref FRAME_RING_POLICY_DropOldest stored frames are removed until it fits.
+		 *  In both cases each dropped frame is counted.
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may insert into a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer     Pointer to a frame ring buffer structure to insert into.
+		 *  \param[in]     MaxLength  Maximum length of the new frame's payload, up to \ref FRAME_RING_MAX_FRAME_LENGTH.
+		 *
+		 *  \return Pointer to the space reserved for the frame's payload, or \c NULL if the frame could not be stored.
+		 */
+		static inline uint8_t* FrameRing_Reserve(FrameRing_t* const Buffer,
+		                                         const uint16_t MaxLength) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint8_t* FrameRing_Reserve(FrameRing_t* const Buffer,
+		                                         const uint16_t MaxLength)
+		{
+			if ((MaxLength > FRAME_RING_MAX_FRAME_LENGTH) || (MaxLength > (Buffer->Size - FRAME_RING_PREFIX_SIZE)))
+			{
+				FrameRing_CountDrop(Buffer);
+				return NULL;
+			}
+
+			uint16_t RecordSize = (FRAME_RING_PREFIX_SIZE + MaxLength);
+
+			for (;;)
+			{
+				uint16_t FreeBytes  = (Buffer->Size - FrameRing_GetUsed(Buffer));
+				uint16_t BytesToEnd = (Buffer->Size - Buffer->In);
+
+				if ((RecordSize <= BytesToEnd) && (RecordSize <= FreeBytes))
+				{
+					Buffer->ReservedOffset = Buffer->In;
+					Buffer->ReservedSkip   = 0;
+					break;
+				}
+				else if ((FreeBytes > BytesToEnd) && (RecordSize <= (FreeBytes - BytesToEnd)))
+				{
+					Buffer->ReservedOffset = 0;
+					Buffer->ReservedSkip   = BytesToEnd;
+					break;
+				}
+
+				if ((Buffer->Policy != FRAME_RING_POLICY_DropOldest) || FrameRing_IsEmpty(Buffer))
+				{
+					FrameRing_CountDrop(Buffer);
+					return NULL;
+				}
+
+				uint16_t DroppedLength;
+
+				if (FrameRing_Peek(Buffer, &DroppedLength))
+				{
+					FrameRing_Release(Buffer);
+					FrameRing_CountDrop(Buffer);
+				}
+			}
+
+			return &Buffer->Start[Buffer->ReservedOffset + FRAME_RING_PREFIX_SIZE];
+		}
+
+		/** Commits the frame reserved by the last call to \ref FrameRing_Reserve(), making it visible to the
+		 *  removing thread. The stored counters are updated in a single atomic operation.
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may insert into a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a frame ring buffer structure to insert into.
+		 *  \param[in]     Length  Final length of the frame's payload, which must not exceed the reserved length.
+		 */
+		static inline void FrameRing_Commit(FrameRing_t* const Buffer,
+		                                    const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void FrameRing_Commit(FrameRing_t* const Buffer,
+		                                    const uint16_t Length)
+		{
+			uint16_t RecordSize = (FRAME_RING_PREFIX_SIZE + Length);
+
+			/* Mark the skipped space so that the reader wraps around with the writer */
+			if (Buffer->ReservedSkip >= FRAME_RING_PREFIX_SIZE)
+			  FrameRing_WritePrefix(&Buffer->Start[Buffer->In], FRAME_RING_SKIP_MARKER);
+
+			FrameRing_WritePrefix(&Buffer->Start[Buffer->ReservedOffset], Length);
+
+			Buffer->In = (Buffer->ReservedOffset + RecordSize);
+
+			if (Buffer->In == Buffer->Size)
+			  Buffer->In = 0;
+
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Buffer->Used += (Buffer->ReservedSkip + RecordSize);
+			Buffer->Frames++;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+
+			Buffer->ReservedSkip = 0;
+		}
+
+		/** Copies a complete frame into the buffer, via \ref FrameRing_Reserve() and \ref FrameRing_Commit().
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may insert into a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a frame ring buffer structure to insert into.
+		 *  \param[in]     Data    Pointer to the frame's payload.
+		 *  \param[in]     Length  Length of the frame's payload, up to \ref FRAME_RING_MAX_FRAME_LENGTH.
+		 *
+		 *  \return Boolean \c true if the frame was stored, \c false if it was dropped.
+		 */
+		static inline bool FrameRing_Insert(FrameRing_t* const Buffer,
+		                                    const uint8_t* const Data,
+		                                    const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline bool FrameRing_Insert(FrameRing_t* const Buffer,
+		                                    const uint8_t* const Data,
+		                                    const uint16_t Length)
+		{
+			uint8_t* Frame = FrameRing_Reserve(Buffer, Length);
+
+			if (!(Frame))
+			  return false;
+
+			memcpy(Frame, Data, Length);
+			FrameRing_Commit(Buffer, Length);
+
+			return true;
+		}
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
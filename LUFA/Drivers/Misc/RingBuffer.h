@@ -101,6 +101,11 @@
 			extern "C" {
 		#endif
 
+	/* Preprocessor Checks: */
+		#if defined(__RING_BUFFER_SPSC_H__)
+			#error RingBuffer.h and RingBufferSPSC.h cannot be included in the same source file.
+		#endif
+
 	/* Type Defines: */
 		/** \brief Ring Buffer Management Structure.
 		 *
@@ -297,6 +302,209 @@
 			return *Buffer->Out;
 		}
 
+		/** Retrieves the largest contiguous span of stored data in the ring buffer, starting at the next element
+		 *  to be removed, without removing it. The span ends either at the last stored element or at the end of
+		 *  the buffer's underlying storage array, whichever comes first, so that the data may be processed in a
+		 *  single pass without wrap checks. Once processed, the data should be released via a call to
+		 *  \ref RingBuffer_RemoveSpan().
+		 *
+		 *  \note The returned length is guaranteed to only be the minimum number of contiguous bytes available;
+		 *        more data may be inserted by another thread while the span is being processed.
+		 *
+		 *  \param[in]  Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out] Length  Pointer to a location where the number of contiguous bytes in the span is stored.
+		 *
+		 *  \return Pointer to the first element of the span.
+		 */
+		static inline uint8_t* RingBuffer_PeekSpan(RingBuffer_t* const Buffer,
+		                                           uint16_t* const Length) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint8_t* RingBuffer_PeekSpan(RingBuffer_t* const Buffer,
+		                                           uint16_t* const Length)
+		{
+			uint16_t Count      = RingBuffer_GetCount(Buffer);
+			uint16_t BytesToEnd = (Buffer->End - Buffer->Out);
+
+			*Length = (Count < BytesToEnd) ? Count : BytesToEnd;
+			return Buffer->Out;
+		}
+
+		/** Removes a number of elements from the ring buffer at once, after they have been processed in place
+		 *  through a span obtained from \ref RingBuffer_PeekSpan() or \ref RingBuffer_PeekSegments(). The stored
+		 *  count is updated in a single atomic operation regardless of the number of elements removed.
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may remove from a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to remove from.
+		 *  \param[in]     Length  Number of elements to remove, which must not exceed the number of stored elements.
+		 */
+		static inline void RingBuffer_RemoveSpan(RingBuffer_t* Buffer,
+		                                         const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void RingBuffer_RemoveSpan(RingBuffer_t* Buffer,
+		                                         const uint16_t Length)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			uint16_t BytesToEnd = (Buffer->End - Buffer->Out);
+
+			if (Length < BytesToEnd)
+			  Buffer->Out += Length;
+			else
+			  Buffer->Out = Buffer->Start + (Length - BytesToEnd);
+
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Buffer->Count -= Length;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+		}
+
+		/** Retrieves all stored data in the ring buffer without removing it, as up to two contiguous segments. The
+		 *  first segment starts at the next element to be removed; if the stored data wraps around the end of the
+		 *  buffer's underlying storage array, the second segment holds the remainder from the start of the array,
+		 *  otherwise it is empty. Once processed, the data should be released via a call to
+		 *  \ref RingBuffer_RemoveSpan().
+		 *
+		 *  \note The returned lengths are guaranteed to only be the minimum number of bytes available; more data
+		 *        may be inserted by another thread while the segments are being processed.
+		 *
+		 *  \param[in]  Buffer        Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out] FirstLength   Pointer to a location where the number of bytes in the first segment is stored.
+		 *  \param[out] Second        Pointer to a location where a pointer to the second segment is stored.
+		 *  \param[out] SecondLength  Pointer to a location where the number of bytes in the second segment is stored.
+		 *
+		 *  \return Pointer to the first element of the first segment.
+		 */
+		static inline uint8_t* RingBuffer_PeekSegments(RingBuffer_t* const Buffer,
+		                                               uint16_t* const FirstLength,
+		                                               uint8_t** const Second,
+		                                               uint16_t* const SecondLength) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1)
+		                                                                             ATTR_NON_NULL_PTR_ARG(2) ATTR_NON_NULL_PTR_ARG(3)
+		                                                                             ATTR_NON_NULL_PTR_ARG(4);
+		static inline uint8_t* RingBuffer_PeekSegments(RingBuffer_t* const Buffer,
+		                                               uint16_t* const FirstLength,
+		                                               uint8_t** const Second,
+		                                               uint16_t* const SecondLength)
+		{
+			uint16_t Count      = RingBuffer_GetCount(Buffer);
+			uint16_t BytesToEnd = (Buffer->End - Buffer->Out);
+
+			if (Count > BytesToEnd)
+			{
+				*FirstLength  = BytesToEnd;
+				*SecondLength = (Count - BytesToEnd);
+			}
+			else
+			{
+				*FirstLength  = Count;
+				*SecondLength = 0;
+			}
+
+			*Second = Buffer->Start;
+			return Buffer->Out;
+		}
+
+		/** Inserts a block of elements into the ring buffer, stopping early if the buffer becomes full. The data
+		 *  is copied in at most two contiguous segments, and the stored count is updated in a single atomic
+		 *  operation regardless of the number of elements inserted.
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may insert into a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *  \param[in]     Data    Pointer to the block of data elements to insert into the buffer.
+		 *  \param[in]     Length  Number of data elements in the block.
+		 *
+		 *  \return Number of elements inserted into the buffer.
+		 */
+		static inline uint16_t RingBuffer_InsertBlock(RingBuffer_t* Buffer,
+		                                              const uint8_t* Data,
+		                                              uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint16_t RingBuffer_InsertBlock(RingBuffer_t* Buffer,
+		                                              const uint8_t* Data,
+		                                              uint16_t Length)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			uint16_t FreeCount = RingBuffer_GetFreeCount(Buffer);
+
+			if (Length > FreeCount)
+			  Length = FreeCount;
+
+			if (!(Length))
+			  return 0;
+
+			uint16_t BytesToEnd = (Buffer->End - Buffer->In);
+
+			if (Length < BytesToEnd)
+			{
+				memcpy(Buffer->In, Data, Length);
+				Buffer->In += Length;
+			}
+			else
+			{
+				memcpy(Buffer->In, Data, BytesToEnd);
+				memcpy(Buffer->Start, &Data[BytesToEnd], (Length - BytesToEnd));
+				Buffer->In = Buffer->Start + (Length - BytesToEnd);
+			}
+
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Buffer->Count += Length;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+
+			return Length;
+		}
+
+		/** Removes a block of elements from the ring buffer, stopping early if the buffer becomes empty. The data
+		 *  is copied out in at most two contiguous segments, and the stored count is updated in a single atomic
+		 *  operation regardless of the number of elements removed.
+		 *
+		 *  \warning Only one execution thread (main program thread or an ISR) may remove from a single buffer
+		 *           otherwise data corruption may occur. Insertion and removal may occur from different execution
+		 *           threads.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out]    Data    Pointer to a location where the removed data elements are to be stored.
+		 *  \param[in]     Length  Maximum number of data elements to remove.
+		 *
+		 *  \return Number of elements removed from the buffer.
+		 */
+		static inline uint16_t RingBuffer_RemoveBlock(RingBuffer_t* Buffer,
+		                                              uint8_t* Data,
+		                                              uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint16_t RingBuffer_RemoveBlock(RingBuffer_t* Buffer,
+		                                              uint8_t* Data,
+		                                              uint16_t Length)
+		{
+			uint8_t* Second;
+			uint16_t FirstLength;
+			uint16_t SecondLength;
+			uint8_t* First = RingBuffer_PeekSegments(Buffer, &FirstLength, &Second, &SecondLength);
+
+			if (Length <= FirstLength)
+			{
+				memcpy(Data, First, Length);
+			}
+			else
+			{
+				if (Length > (FirstLength + SecondLength))
+				  Length = (FirstLength + SecondLength);
+
+				memcpy(Data, First, FirstLength);
+				memcpy(&Data[FirstLength], Second, (Length - FirstLength));
+			}
+
+			RingBuffer_RemoveSpan(Buffer, Length);
+
+			return Length;
+		}
+
 	/* Disable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
 			}
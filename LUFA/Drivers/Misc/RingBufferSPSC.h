@@ -0,0 +1,478 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Lock-free single producer, single consumer ring (circular) buffer of bytes.
+ *
+ *  Lock-free variant of the lightweight ring buffer, for one inserting and one removing thread. It offers
+ *  the same interface as \ref Group_RingBuff, but never disables interrupts.
+ */
+
+/** \ingroup Group_MiscDrivers
+ *  \defgroup Group_RingBuffSPSC Lock-Free Byte Ring Buffer - LUFA/Drivers/Misc/RingBufferSPSC.h
+ *  \brief Lock-free single producer, single consumer ring buffer of bytes.
+ *
+ *  \section Sec_RingBuffSPSC_Dependencies Module Source Dependencies
+ *  The following files must be built with any user project that uses this module:
+ *    - None
+ *
+ *  \section Sec_RingBuffSPSC_ModDescription Module Description
+ *  Lock-free variant of the lightweight ring buffer, offering the same interface as the \ref Group_RingBuff
+ *  module so that either may be used by an application through a compile time switch. Only one of the two
+ *  headers may be included in a single source file.
+ *
+ *  Instead of a shared byte count updated inside a critical section, the buffer keeps two free running
+ *  16-bit indices: the insertion index is written only by the inserting thread, and the removal index only
+ *  by the removing thread. The stored count is the difference between the two, and elements are located by
+ *  masking the indices, so the buffer size must be a power of two.
+ *
+ *  As 16-bit values are accessed one byte at a time on the 8-bit architectures, each index is stored low
+ *  byte first after the data it publishes, and read repeatedly until two reads agree. An index read from an
+ *  ISR which preempted the other thread's store may then lag behind its true value, which only makes the
+ *  buffer appear fuller (to the inserting thread) or emptier (to the removing thread) than it is until the
+ *  next read. For this to hold, the buffer size may be at most 16384 bytes.
+ *
+ *  Exactly one execution thread may insert into, and exactly one may remove from, a single buffer.
+ *
+ *  \section Sec_RingBuffSPSC_ExampleUsage Example Usage
+ *  The following snippet is an example of how this module may be used within a typical
+ *  application.
+ *
+ *  \code
+ *      // Create the buffer structure and its underlying storage array, whose size must be a power of two
+ *      RingBuffer_t Buffer;
+ *      uint8_t      BufferData[128];
+ *
+ *      // Initialize the buffer with the created storage array
+ *      RingBuffer_InitBuffer(&Buffer, BufferData, sizeof(BufferData));
+ *
+ *      // Insert some data into the buffer from the producer thread
+ *      RingBuffer_Insert(&Buffer, 'H');
+ *      RingBuffer_Insert(&Buffer, 'I');
+ *
+ *      // Print contents of the buffer one character at a time from the consumer thread
+ *      uint16_t BufferCount = RingBuffer_GetCount(&Buffer);
+ *
+ *      while (BufferCount--)
+ *        putc(RingBuffer_Remove(&Buffer));
+ *  \endcode
+ *
+ *  @{
+ */
+
+#ifndef __RING_BUFFER_SPSC_H__
+#define __RING_BUFFER_SPSC_H__
+
+	/* Includes: */
+		#include "../../Common/Common.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if defined(__RING_BUFFER_H__)
+			#error RingBuffer.h and RingBufferSPSC.h cannot be included in the same source file.
+		#endif
+
+	/* Type Defines: */
+		/** \brief Lock-Free Ring Buffer Management Structure.
+		 *
+		 *  Type define for a new lock-free ring buffer object. Buffers should be initialized via a call to
+		 *  \ref RingBuffer_InitBuffer() before use.
+		 */
+		typedef struct
+		{
+			uint8_t* Start; /**< Pointer to the start of the buffer's underlying storage array. */
+			uint16_t Size; /**< Size of the buffer's underlying storage array. */
+			uint16_t Mask; /**< Mask applied to the indices to locate an element in the storage array. */
+			volatile uint16_t In; /**< Free running insertion index, written only by the inserting thread. */
+			volatile uint16_t Out; /**< Free running removal index, written only by the removing thread. */
+		} RingBuffer_t;
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Inline Functions: */
+			static inline uint16_t RingBuffer_LoadIndex(const volatile uint16_t* const Index) ATTR_ALWAYS_INLINE;
+			static inline uint16_t RingBuffer_LoadIndex(const volatile uint16_t* const Index)
+			{
+				uint16_t Value;
+
+				do
+				{
+					Value = *Index;
+				} while (Value != *Index);
+
+				return Value;
+			}
+
+			static inline void RingBuffer_StoreIndex(volatile uint16_t* const Index,
+			                                         const uint16_t Value) ATTR_ALWAYS_INLINE;
+			static inline void RingBuffer_StoreIndex(volatile uint16_t* const Index,
+			                                         const uint16_t Value)
+			{
+				GCC_MEMORY_BARRIER();
+
+				#if (ARCH == ARCH_UC3)
+				*Index = Value;
+				#else
+				((volatile uint8_t*)Index)[0] = (Value & 0xFF);
+				((volatile uint8_t*)Index)[1] = (Value >> 8);
+				#endif
+			}
+	#endif
+
+	/* Inline Functions: */
+		/** Initializes a ring buffer ready for use. Buffers must be initialized via this function
+		 *  before any operations are called upon them, and before either thread may access them.
+		 *
+		 *  \param[out] Buffer   Pointer to a ring buffer structure to initialize.
+		 *  \param[out] DataPtr  Pointer to a global array that will hold the data stored into the ring buffer.
+		 *  \param[out] Size     Maximum number of bytes that can be stored in the underlying data array, which must
+		 *                       be a power of two no larger than 16384.
+		 */
+		static inline void RingBuffer_InitBuffer(RingBuffer_t* Buffer,
+		                                         uint8_t* const DataPtr,
+		                                         const uint16_t Size) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline void RingBuffer_InitBuffer(RingBuffer_t* Buffer,
+		                                         uint8_t* const DataPtr,
+		                                         const uint16_t Size)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			Buffer->Start = DataPtr;
+			Buffer->Size  = Size;
+			Buffer->Mask  = (Size - 1);
+			Buffer->In    = 0;
+			Buffer->Out   = 0;
+		}
+
+		/** Retrieves the current number of bytes stored in a particular buffer.
+		 *
+		 *  \note The value returned by this function is guaranteed to only be the minimum number of bytes
+		 *        stored in the given buffer when called from the removing thread, and the maximum number of
+		 *        bytes when called from the inserting thread.
+		 *
+		 *  \param[in] Buffer  Pointer to a ring buffer structure whose count is to be computed.
+		 *
+		 *  \return Number of bytes currently stored in the buffer.
+		 */
+		static inline uint16_t RingBuffer_GetCount(RingBuffer_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t RingBuffer_GetCount(RingBuffer_t* const Buffer)
+		{
+			uint16_t Count = (RingBuffer_LoadIndex(&Buffer->In) - RingBuffer_LoadIndex(&Buffer->Out));
+
+			/* A lagging insertion index can make the count appear negative, a lagging removal index too large */
+			if ((int16_t)Count < 0)
+			  return 0;
+			else if (Count > Buffer->Size)
+			  return Buffer->Size;
+
+			return Count;
+		}
+
+		/** Retrieves the free space in a particular buffer.
+		 *
+		 *  \note The value returned by this function is guaranteed to only be the minimum number of bytes
+		 *        free in the given buffer when called from the inserting thread.
+		 *
+		 *  \param[in] Buffer  Pointer to a ring buffer structure whose free count is to be computed.
+		 *
+		 *  \return Number of free bytes in the buffer.
+		 */
+		static inline uint16_t RingBuffer_GetFreeCount(RingBuffer_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint16_t RingBuffer_GetFreeCount(RingBuffer_t* const Buffer)
+		{
+			return (Buffer->Size - RingBuffer_GetCount(Buffer));
+		}
+
+		/** Determines if the specified ring buffer contains any data. This should be tested before removing
+		 *  data from the buffer, to ensure that the buffer does not underflow.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *
+		 *  \return Boolean \c true if the buffer contains no data, \c false otherwise.
+		 */
+		static inline bool RingBuffer_IsEmpty(RingBuffer_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline bool RingBuffer_IsEmpty(RingBuffer_t* const Buffer)
+		{
+			return (RingBuffer_GetCount(Buffer) == 0);
+		}
+
+		/** Determines if the specified ring buffer contains any free space. This should be tested before
+		 *  storing data to the buffer, to ensure that no data is lost due to a buffer overrun.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *
+		 *  \return Boolean \c true if the buffer contains no free space, \c false otherwise.
+		 */
+		static inline bool RingBuffer_IsFull(RingBuffer_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline bool RingBuffer_IsFull(RingBuffer_t* const Buffer)
+		{
+			return (RingBuffer_GetCount(Buffer) == Buffer->Size);
+		}
+
+		/** Inserts an element into the ring buffer.
+		 *
+		 *  \warning Only one execution thread may insert into a single buffer.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *  \param[in]     Data    Data element to insert into the buffer.
+		 */
+		static inline void RingBuffer_Insert(RingBuffer_t* Buffer,
+		                                     const uint8_t Data) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void RingBuffer_Insert(RingBuffer_t* Buffer,
+		                                     const uint8_t Data)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			uint16_t In = Buffer->In;
+
+			Buffer->Start[In & Buffer->Mask] = Data;
+
+			RingBuffer_StoreIndex(&Buffer->In, (In + 1));
+		}
+
+		/** Removes an element from the ring buffer.
+		 *
+		 *  \warning Only one execution thread may remove from a single buffer.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *
+		 *  \return Next data element stored in the buffer.
+		 */
+		static inline uint8_t RingBuffer_Remove(RingBuffer_t* Buffer) ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint8_t RingBuffer_Remove(RingBuffer_t* Buffer)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			uint16_t Out  = Buffer->Out;
+			uint8_t  Data = Buffer->Start[Out & Buffer->Mask];
+
+			RingBuffer_StoreIndex(&Buffer->Out, (Out + 1));
+
+			return Data;
+		}
+
+		/** Returns the next element stored in the ring buffer, without removing it.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *
+		 *  \return Next data element stored in the buffer.
+		 */
+		static inline uint8_t RingBuffer_Peek(RingBuffer_t* const Buffer) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1);
+		static inline uint8_t RingBuffer_Peek(RingBuffer_t* const Buffer)
+		{
+			return Buffer->Start[Buffer->Out & Buffer->Mask];
+		}
+
+		/** Retrieves the largest contiguous span of stored data in the ring buffer, starting at the next element
+		 *  to be removed, without removing it. Once processed, the data should be released via a call to
+		 *  \ref RingBuffer_RemoveSpan().
+		 *
+		 *  \param[in]  Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out] Length  Pointer to a location where the number of contiguous bytes in the span is stored.
+		 *
+		 *  \return Pointer to the first element of the span.
+		 */
+		static inline uint8_t* RingBuffer_PeekSpan(RingBuffer_t* const Buffer,
+		                                           uint16_t* const Length) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint8_t* RingBuffer_PeekSpan(RingBuffer_t* const Buffer,
+		                                           uint16_t* const Length)
+		{
+			uint16_t Count      = RingBuffer_GetCount(Buffer);
+			uint16_t Offset     = (Buffer->Out & Buffer->Mask);
+			uint16_t BytesToEnd = (Buffer->Size - Offset);
+
+			*Length = (Count < BytesToEnd) ? Count : BytesToEnd;
+			return &Buffer->Start[Offset];
+		}
+
+		/** Removes a number of elements from the ring buffer at once, after they have been processed in place
+		 *  through a span obtained from \ref RingBuffer_PeekSpan() or \ref RingBuffer_PeekSegments().
+		 *
+		 *  \warning Only one execution thread may remove from a single buffer.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to remove from.
+		 *  \param[in]     Length  Number of elements to remove, which must not exceed the number of stored elements.
+		 */
+		static inline void RingBuffer_RemoveSpan(RingBuffer_t* Buffer,
+		                                         const uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+		static inline void RingBuffer_RemoveSpan(RingBuffer_t* Buffer,
+		                                         const uint16_t Length)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			RingBuffer_StoreIndex(&Buffer->Out, (Buffer->Out + Length));
+		}
+
+		/** Retrieves all stored data in the ring buffer without removing it, as up to two contiguous segments. The
+		 *  first segment starts at the next element to be removed; if the stored data wraps around the end of the
+		 *  buffer's underlying storage array, the second segment holds the remainder from the start of the array,
+		 *  otherwise it is empty. Once processed, the data should be released via a call to
+		 *  \ref RingBuffer_RemoveSpan().
+		 *
+		 *  \param[in]  Buffer        Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out] FirstLength   Pointer to a location where the number of bytes in the first segment is stored.
+		 *  \param[out] Second        Pointer to a location where a pointer to the second segment is stored.
+		 *  \param[out] SecondLength  Pointer to a location where the number of bytes in the second segment is stored.
+		 *
+		 *  \return Pointer to the first element of the first segment.
+		 */
+		static inline uint8_t* RingBuffer_PeekSegments(RingBuffer_t* const Buffer,
+		                                               uint16_t* const FirstLength,
+		                                               uint8_t** const Second,
+		                                               uint16_t* const SecondLength) ATTR_WARN_UNUSED_RESULT ATTR_NON_NULL_PTR_ARG(1)
+		                                                                             ATTR_NON_NULL_PTR_ARG(2) ATTR_NON_NULL_PTR_ARG(3)
+		                                                                             ATTR_NON_NULL_PTR_ARG(4);
+		static inline uint8_t* RingBuffer_PeekSegments(RingBuffer_t* const Buffer,
+		                                               uint16_t* const FirstLength,
+		                                               uint8_t** const Second,
+		                                               uint16_t* const SecondLength)
+		{
+			uint16_t Count      = RingBuffer_GetCount(Buffer);
+			uint16_t Offset     = (Buffer->Out & Buffer->Mask);
+			uint16_t BytesToEnd = (Buffer->Size - Offset);
+
+			if (Count > BytesToEnd)
+			{
+				*FirstLength  = BytesToEnd;
+				*SecondLength = (Count - BytesToEnd);
+			}
+			else
+			{
+				*FirstLength  = Count;
+				*SecondLength = 0;
+			}
+
+			*Second = Buffer->Start;
+			return &Buffer->Start[Offset];
+		}
+
+		/** Inserts a block of elements into the ring buffer, stopping early if the buffer becomes full. The data
+		 *  is copied in at most two contiguous segments, and the insertion index is published once for the
+		 *  whole block.
+		 *
+		 *  \warning Only one execution thread may insert into a single buffer.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to insert into.
+		 *  \param[in]     Data    Pointer to the block of data elements to insert into the buffer.
+		 *  \param[in]     Length  Number of data elements in the block.
+		 *
+		 *  \return Number of elements inserted into the buffer.
+		 */
+		static inline uint16_t RingBuffer_InsertBlock(RingBuffer_t* Buffer,
+		                                              const uint8_t* Data,
+		                                              uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint16_t RingBuffer_InsertBlock(RingBuffer_t* Buffer,
+		                                              const uint8_t* Data,
+		                                              uint16_t Length)
+		{
+			GCC_FORCE_POINTER_ACCESS(Buffer);
+
+			uint16_t FreeCount = RingBuffer_GetFreeCount(Buffer);
+
+			if (Length > FreeCount)
+			  Length = FreeCount;
+
+			if (!(Length))
+			  return 0;
+
+			uint16_t In         = Buffer->In;
+			uint16_t Offset     = (In & Buffer->Mask);
+			uint16_t BytesToEnd = (Buffer->Size - Offset);
+
+			if (Length <= BytesToEnd)
+			{
+				memcpy(&Buffer->Start[Offset], Data, Length);
+			}
+			else
+			{
+				memcpy(&Buffer->Start[Offset], Data, BytesToEnd);
+				memcpy(Buffer->Start, &Data[BytesToEnd], (Length - BytesToEnd));
+			}
+
+			RingBuffer_StoreIndex(&Buffer->In, (In + Length));
+
+			return Length;
+		}
+
+		/** Removes a block of elements from the ring buffer, stopping early if the buffer becomes empty. The data
+		 *  is copied out in at most two contiguous segments, and the removal index is published once for the
+		 *  whole block.
+		 *
+		 *  \warning Only one execution thread may remove from a single buffer.
+		 *
+		 *  \param[in,out] Buffer  Pointer to a ring buffer structure to retrieve from.
+		 *  \param[out]    Data    Pointer to a location where the removed data elements are to be stored.
+		 *  \param[in]     Length  Maximum number of data elements to remove.
+		 *
+		 *  \return Number of elements removed from the buffer.
+		 */
+		static inline uint16_t RingBuffer_RemoveBlock(RingBuffer_t* Buffer,
+		                                              uint8_t* Data,
+		                                              uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+		static inline uint16_t RingBuffer_RemoveBlock(RingBuffer_t* Buffer,
+		                                              uint8_t* Data,
+		                                              uint16_t Length)
+		{
+			uint8_t* Second;
+			uint16_t FirstLength;
+			uint16_t SecondLength;
+			uint8_t* First = RingBuffer_PeekSegments(Buffer, &FirstLength, &Second, &SecondLength);
+
+			if (Length <= FirstLength)
+			{
+				memcpy(Data, First, Length);
+			}
+			else
+			{
+				if (Length > (FirstLength + SecondLength))
+				  Length = (FirstLength + SecondLength);
+
+				memcpy(Data, First, FirstLength);
+				memcpy(&Data[FirstLength], Second, (Length - FirstLength));
+			}
+
+			RingBuffer_RemoveSpan(Buffer, Length);
+
+			return Length;
+		}
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
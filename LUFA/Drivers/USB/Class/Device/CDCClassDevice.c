@@ -39,6 +39,23 @@
 
 void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 {
+	#if defined(CDC_DEVICE_DEFERRED_CONTROL_REQUESTS)
+	if (CDCInterfaceInfo->State.LineEncodingDataPending)
+	{
+		if (!(Endpoint_IsSETUPReceived()))
+		{
+			if (Endpoint_IsOUTReceived())
+			  CDC_Device_CompleteSetLineEncoding(CDCInterfaceInfo);
+
+			return;
+		}
+
+		/* The host has abandoned the pending request in favour of a new one */
+		Endpoint_DisableReadyInterrupt();
+		CDCInterfaceInfo->State.LineEncodingDataPending = false;
+	}
+	#endif
+
 	if (!(Endpoint_IsSETUPReceived()))
 	  return;
 
@@ -69,6 +86,11 @@ void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t* const CDCInter
 			{
 				Endpoint_ClearSETUP();
 
+				#if defined(CDC_DEVICE_DEFERRED_CONTROL_REQUESTS)
+				/* Complete the request from the control endpoint interrupt once the data stage arrives */
+				CDCInterfaceInfo->State.LineEncodingDataPending = true;
+				Endpoint_EnableReadyInterrupt();
+				#else
 				while (!(Endpoint_IsOUTReceived()))
 				{
 					if (USB_DeviceState == DEVICE_STATE_Unattached)
@@ -84,6 +106,7 @@ void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t* const CDCInter
 				Endpoint_ClearStatusStage();
 
 				EVENT_CDC_Device_LineEncodingChanged(CDCInterfaceInfo);
+				#endif
 			}
 
 			break;
@@ -112,6 +135,22 @@ void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t* const CDCInter
 	}
 }
 
+#if defined(CDC_DEVICE_DEFERRED_CONTROL_REQUESTS)
+static void CDC_Device_CompleteSetLineEncoding(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
+{
+	CDCInterfaceInfo->State.LineEncoding.BaudRateBPS = Endpoint_Read_32_LE();
+	CDCInterfaceInfo->State.LineEncoding.CharFormat  = Endpoint_Read_8();
+	CDCInterfaceInfo->State.LineEncoding.ParityType  = Endpoint_Read_8();
+	CDCInterfaceInfo->State.LineEncoding.DataBits    = Endpoint_Read_8();
+
+	Endpoint_ClearOUT();
+	Endpoint_ClearStatusStage();
+
+	CDCInterfaceInfo->State.LineEncodingDataPending   = false;
+	CDCInterfaceInfo->State.LineEncodingChangePending = true;
+}
+#endif
+
 bool CDC_Device_ConfigureEndpoints(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 {
 	memset(&CDCInterfaceInfo->State, 0x00, sizeof(CDCInterfaceInfo->State));
@@ -134,6 +173,8 @@ bool CDC_Device_ConfigureEndpoints(USB_ClassInfo_CDC_Device_t* const CDCInterfac
 
 void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 {
+	CDC_Device_ProcessDeferredRequests(CDCInterfaceInfo);
+
 	if ((USB_DeviceState != DEVICE_STATE_Configured) || !(CDCInterfaceInfo->State.LineEncoding.BaudRateBPS))
 	  return;
 
@@ -145,6 +186,16 @@ void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 	#endif
 }
 
+void CDC_Device_ProcessDeferredRequests(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
+{
+	if (!(CDCInterfaceInfo->State.LineEncodingChangePending))
+	  return;
+
+	CDCInterfaceInfo->State.LineEncodingChangePending = false;
+
+	EVENT_CDC_Device_LineEncodingChanged(CDCInterfaceInfo);
+}
+
 uint8_t CDC_Device_SendString(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo,
                               const char* const String)
 {
@@ -209,6 +260,44 @@ uint8_t CDC_Device_SendByte(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo,
 	return ENDPOINT_READYWAIT_NoError;
 }
 
+uint16_t CDC_Device_SendSpan(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo,
+                             const uint8_t* Buffer,
+                             uint16_t Length)
+{
+	if ((USB_DeviceState != DEVICE_STATE_Configured) || !(CDCInterfaceInfo->State.LineEncoding.BaudRateBPS))
+	  return 0;
+
+	uint16_t BytesSent = 0;
+
+	Endpoint_SelectEndpoint(CDCInterfaceInfo->Config.DataINEndpoint.Address);
+
+	while (Length && Endpoint_IsINReady())
+	{
+		uint16_t BankFree    = (CDCInterfaceInfo->Config.DataINEndpoint.Size - Endpoint_BytesInEndpoint());
+		uint16_t BytesToCopy = (Length < BankFree) ? Length : BankFree;
+		bool     BankFull    = (BytesToCopy == BankFree);
+
+		Length    -= BytesToCopy;
+		BytesSent += BytesToCopy;
+
+		while (BytesToCopy--)
+		  Endpoint_Write_8(*(Buffer++));
+
+		if (BankFull)
+		{
+			Endpoint_ClearIN();
+
+			#if (ARCH == ARCH_AVR8) || (ARCH == ARCH_UC3)
+			/* Only keep filling while the hardware has another bank to stage data into as this one is sent */
+			if (Endpoint_GetBusyBanks() >= CDCInterfaceInfo->Config.DataINEndpoint.Banks)
+			  break;
+			#endif
+		}
+	}
+
+	return BytesSent;
+}
+
 uint8_t CDC_Device_Flush(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 {
 	if ((USB_DeviceState != DEVICE_STATE_Configured) || !(CDCInterfaceInfo->State.LineEncoding.BaudRateBPS))
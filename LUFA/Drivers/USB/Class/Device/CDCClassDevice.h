@@ -124,6 +124,14 @@
 					                                  *   This is generally only used if the virtual serial port data is to be
 					                                  *   reconstructed on a physical UART.
 					                                  */
+
+					bool LineEncodingDataPending; /**< Set while the data stage of a SET LINE ENCODING request is awaited from
+					                               *   the USB interrupt, for internal use by the class driver.
+					                               */
+					volatile bool LineEncodingChangePending; /**< Set when a new line encoding has been received from the USB interrupt,
+					                                          *   until \ref CDC_Device_ProcessDeferredRequests() fires the
+					                                          *   \ref EVENT_CDC_Device_LineEncodingChanged() event.
+					                                          */
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
@@ -143,6 +151,13 @@
 			/** Processes incoming control requests from the host, that are directed to the given CDC class interface. This should be
 			 *  linked to the library \ref EVENT_USB_Device_ControlRequest() event.
 			 *
+			 *  \note When the \c INTERRUPT_CONTROL_ENDPOINT token is used on AVR8 devices, SET LINE ENCODING requests are not
+			 *        busy-waited from the USB interrupt. The SETUP stage arms the control endpoint's ready interrupt and returns,
+			 *        the data stage is then completed from that interrupt, and \ref EVENT_CDC_Device_LineEncodingChanged() is
+			 *        deferred to \ref CDC_Device_ProcessDeferredRequests() in the main program loop. The data stage, the longer
+			 *        of the two, runs with interrupts disabled for roughly 250 cycles from the \c USB_COM_vect vector to its
+			 *        return (about 16us at 16MHz), including the request dispatch.
+			 *
 			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing a CDC Class configuration and state.
 			 */
 			void CDC_Device_ProcessControlRequest(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
@@ -154,6 +169,15 @@
 			 */
 			void CDC_Device_USBTask(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Fires the class driver events whose processing was deferred from the USB interrupt to the main program loop, such
+			 *  as \ref EVENT_CDC_Device_LineEncodingChanged() when the \c INTERRUPT_CONTROL_ENDPOINT token is used. This is called
+			 *  automatically from \ref CDC_Device_USBTask(), and only needs to be called directly by applications which do not
+			 *  call that function.
+			 *
+			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing a CDC Class configuration and state.
+			 */
+			void CDC_Device_ProcessDeferredRequests(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo) ATTR_NON_NULL_PTR_ARG(1);
+
 			/** CDC class driver event for a line encoding change on a CDC interface. This event fires each time the host requests a
 			 *  line encoding change (containing the serial parity, baud and other configuration information) and may be hooked in the
 			 *  user program by declaring a handler function with the same name and parameters listed here. The new line encoding
@@ -266,6 +290,28 @@
 			uint8_t CDC_Device_SendByte(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo,
 			                            const uint8_t Data) ATTR_NON_NULL_PTR_ARG(1);
 
+			/** Copies as much of the given contiguous block of data as will fit into the CDC interface's IN endpoint bank,
+			 *  without blocking. Unlike \ref CDC_Device_SendByte(), the interface and endpoint state is checked once per
+			 *  call and the data is moved into the endpoint bank in a single tight loop, which makes this function suitable
+			 *  for draining spans obtained from a ring buffer at high data rates. If the bank becomes full it is sent to the
+			 *  host, and filling continues only if the endpoint has another free bank to stage the next packet into, so
+			 *  that a double banked endpoint is filled while its other bank is being read by the host.
+			 *
+			 *  Partially filled banks are not sent; call \ref CDC_Device_Flush() or \ref CDC_Device_USBTask() to send them.
+			 *
+			 *  \pre This function must only be called when the Device state machine is in the \ref DEVICE_STATE_Configured state or
+			 *       the call will fail.
+			 *
+			 *  \param[in,out] CDCInterfaceInfo  Pointer to a structure containing a CDC Class configuration and state.
+			 *  \param[in]     Buffer            Pointer to a buffer containing the data to send to the host.
+			 *  \param[in]     Length            Length of the data to send to the host.
+			 *
+			 *  \return Number of bytes copied into the endpoint, which may be less than the requested length.
+			 */
+			uint16_t CDC_Device_SendSpan(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo,
+			                             const uint8_t* Buffer,
+			                             uint16_t Length) ATTR_NON_NULL_PTR_ARG(1) ATTR_NON_NULL_PTR_ARG(2);
+
 			/** Determines the number of bytes received by the CDC interface from the host, waiting to be read. This indicates the number
 			 *  of bytes in the OUT endpoint bank only, and thus the number of calls to \ref CDC_Device_ReceiveByte() which are guaranteed to
 			 *  succeed immediately. If multiple bytes are to be received, they should be buffered by the user application, as the endpoint
@@ -353,8 +399,18 @@
 
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#if defined(INTERRUPT_CONTROL_ENDPOINT) && (ARCH == ARCH_AVR8)
+				#define CDC_DEVICE_DEFERRED_CONTROL_REQUESTS
+			#endif
+
 		/* Function Prototypes: */
 			#if defined(__INCLUDE_FROM_CDC_DEVICE_C)
+				#if defined(CDC_DEVICE_DEFERRED_CONTROL_REQUESTS)
+				static void CDC_Device_CompleteSetLineEncoding(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
+				                                               ATTR_NON_NULL_PTR_ARG(1);
+				#endif
+
 				#if defined(FDEV_SETUP_STREAM)
 				static int CDC_Device_putchar(char c,
 				                              FILE* Stream) ATTR_NON_NULL_PTR_ARG(2);
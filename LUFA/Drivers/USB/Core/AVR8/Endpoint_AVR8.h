@@ -137,6 +137,36 @@
 				#define ENDPOINT_TOTAL_ENDPOINTS            1
 			#endif
 
+			#if defined(USB_SERIES_4_AVR) || defined(USB_SERIES_6_AVR) || defined(USB_SERIES_7_AVR) || defined(__DOXYGEN__)
+				/** Total size in bytes of the USB controller's dual-port RAM, from which the banks of all allocated
+				 *  endpoints (including the default control endpoint) are taken. This can be compared against the
+				 *  sum of \ref ENDPOINT_DPRAM_USAGE() for each endpoint of a configuration, to check at compile time
+				 *  that the configuration's endpoints can all be allocated.
+				 */
+				#define ENDPOINT_DPRAM_SIZE                 832
+			#else
+				#define ENDPOINT_DPRAM_SIZE                 176
+			#endif
+
+			/** Computes the bank size allocated by the USB controller for an endpoint of the given size, which
+			 *  is rounded up to the next supported power of two. The result is a constant expression, usable in
+			 *  preprocessor conditionals when the size is also a constant.
+			 *
+			 *  \param[in] Size  Size of the endpoint's bank as given to \ref Endpoint_ConfigureEndpoint(), in bytes.
+			 */
+			#define ENDPOINT_HW_BANK_SIZE(Size)             (((Size) <= 8)  ? 8  : ((Size) <= 16)  ? 16  : \
+			                                                 ((Size) <= 32) ? 32 : ((Size) <= 64)  ? 64  : \
+			                                                 ((Size) <= 128) ? 128 : ((Size) <= 256) ? 256 : 512)
+
+			/** Computes the number of bytes of the USB controller's dual-port RAM used by an endpoint of the given
+			 *  size and number of banks. The result is a constant expression, usable in preprocessor conditionals
+			 *  when the size and number of banks are also constants.
+			 *
+			 *  \param[in] Size   Size of the endpoint's bank as given to \ref Endpoint_ConfigureEndpoint(), in bytes.
+			 *  \param[in] Banks  Number of banks of the endpoint, either 1 or 2.
+			 */
+			#define ENDPOINT_DPRAM_USAGE(Size, Banks)       (ENDPOINT_HW_BANK_SIZE(Size) * (((Banks) > 1) ? 2 : 1))
+
 		/* Enums: */
 			/** Enum for the possible error return codes of the \ref Endpoint_WaitUntilReady() function.
 			 *
@@ -230,6 +260,18 @@
 				#endif
 			}
 
+			/** Retrieves the size of each bank of the currently selected endpoint, as set when it was configured.
+			 *
+			 *  \ingroup Group_EndpointRW_AVR8
+			 *
+			 *  \return Size in bytes of each of the currently selected endpoint's banks.
+			 */
+			static inline uint16_t Endpoint_GetBankSize(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+			static inline uint16_t Endpoint_GetBankSize(void)
+			{
+				return ((uint16_t)8 << ((UECFG1X >> EPSIZE0) & 0x07));
+			}
+
 			/** Determines the currently selected endpoint's direction.
 			 *
 			 *  \return The currently selected endpoint's direction, as a \c ENDPOINT_DIR_* mask.
@@ -370,6 +412,50 @@
 				return ((UESTA0X & (1 << CFGOK)) ? true : false);
 			}
 
+			/** Enables the ready interrupt of the currently selected endpoint, which fires when an OUT endpoint has
+			 *  received a packet from the host, or when an IN endpoint has a bank free to accept new data. When the
+			 *  \c INTERRUPT_DATA_ENDPOINTS token is defined, the interrupt is dispatched to the
+			 *  \ref EVENT_USB_Device_EndpointReady() event. On the control endpoint, when the \c INTERRUPT_CONTROL_ENDPOINT
+			 *  token is defined, the OUT data stage of a request is instead dispatched to \ref EVENT_USB_Device_ControlRequest().
+			 *
+			 *  \note The library disables the interrupt each time it fires, so that a condition not cleared by the
+			 *        event handler does not retrigger it continuously; this function must be called again to request
+			 *        the next notification once the handler or main program is ready for it.
+			 *
+			 *  \ingroup Group_EndpointPacketManagement_AVR8
+			 */
+			static inline void Endpoint_EnableReadyInterrupt(void) ATTR_ALWAYS_INLINE;
+			static inline void Endpoint_EnableReadyInterrupt(void)
+			{
+				UEIENX |= ((UECFG0X & (1 << EPDIR)) ? (1 << TXINE) : (1 << RXOUTE));
+			}
+
+			/** Disables the ready interrupt of the currently selected endpoint.
+			 *
+			 *  \see \ref Endpoint_EnableReadyInterrupt() for more information on the endpoint ready interrupt.
+			 *
+			 *  \ingroup Group_EndpointPacketManagement_AVR8
+			 */
+			static inline void Endpoint_DisableReadyInterrupt(void) ATTR_ALWAYS_INLINE;
+			static inline void Endpoint_DisableReadyInterrupt(void)
+			{
+				UEIENX &= ~((1 << TXINE) | (1 << RXOUTE));
+			}
+
+			/** Determines if the ready interrupt of the currently selected endpoint is enabled.
+			 *
+			 *  \see \ref Endpoint_EnableReadyInterrupt() for more information on the endpoint ready interrupt.
+			 *
+			 *  \ingroup Group_EndpointPacketManagement_AVR8
+			 *
+			 *  \return Boolean \c true if the ready interrupt is enabled, \c false otherwise.
+			 */
+			static inline bool Endpoint_IsReadyInterruptEnabled(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+			static inline bool Endpoint_IsReadyInterruptEnabled(void)
+			{
+				return ((UEIENX & ((1 << TXINE) | (1 << RXOUTE))) ? true : false);
+			}
+
 			/** Returns a mask indicating which INTERRUPT type endpoints have interrupted - i.e. their
 			 *  interrupt duration has elapsed. Which endpoints have interrupted can be determined by
 			 *  masking the return value against <tt>(1 << <i>{Endpoint Number}</i>)</tt>.
@@ -74,6 +74,187 @@ void USB_INT_ClearAllInterrupts(void)
 	#endif
 }
 
+#if defined(USB_CAN_BE_DEVICE)
+#if defined(DEFERRED_DEVICE_EVENTS)
+static volatile uint8_t USB_Device_PendingEvents;
+#if defined(INTERRUPT_CONTROL_ENDPOINT)
+static volatile bool    USB_Device_SETUPInterruptHeld;
+#endif
+#endif
+
+static inline void USB_Device_DispatchEvent(const uint8_t Event) ATTR_ALWAYS_INLINE;
+static inline void USB_Device_DispatchEvent(const uint8_t Event)
+{
+	switch (Event)
+	{
+		case USB_DEVICE_EVENT_Connect:
+			EVENT_USB_Device_Connect();
+			break;
+		case USB_DEVICE_EVENT_Disconnect:
+			EVENT_USB_Device_Disconnect();
+			break;
+		case USB_DEVICE_EVENT_Suspend:
+			EVENT_USB_Device_Suspend();
+			break;
+		case USB_DEVICE_EVENT_WakeUp:
+			EVENT_USB_Device_WakeUp();
+			break;
+		case USB_DEVICE_EVENT_Reset:
+			EVENT_USB_Device_Reset();
+			break;
+		#if !defined(NO_SOF_EVENTS)
+		case USB_DEVICE_EVENT_StartOfFrame:
+			EVENT_USB_Device_StartOfFrame();
+			break;
+		#endif
+	}
+}
+
+#if defined(DEFERRED_DEVICE_EVENTS) && defined(INTERRUPT_CONTROL_ENDPOINT)
+static void USB_Device_HoldSETUPInterrupt(const bool Hold)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+
+	if (Hold)
+	  USB_INT_Disable(USB_INT_RXSTPI);
+	else
+	  USB_INT_Enable(USB_INT_RXSTPI);
+
+	USB_Device_SETUPInterruptHeld = Hold;
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+#endif
+
+static inline void USB_Device_RaiseEvent(const uint8_t Event) ATTR_ALWAYS_INLINE;
+static inline void USB_Device_RaiseEvent(const uint8_t Event)
+{
+	#if defined(DEFERRED_DEVICE_EVENTS)
+	if (DEFERRED_DEVICE_EVENTS & Event)
+	{
+		/* Each event is marked pending until dispatched, so that none is lost and repeats are merged */
+		USB_Device_PendingEvents |= Event;
+
+		/* Control requests are held off until the event has been dispatched, so that the events they raise, such as
+		 * a configuration change, cannot be fired from the control endpoint interrupt before it */
+		#if defined(INTERRUPT_CONTROL_ENDPOINT)
+		USB_Device_HoldSETUPInterrupt(true);
+		#endif
+		return;
+	}
+	#endif
+
+	USB_Device_DispatchEvent(Event);
+}
+
+static inline void USB_Device_WaitForPLL(void) ATTR_ALWAYS_INLINE;
+static inline void USB_Device_WaitForPLL(void)
+{
+	#if defined(DEFERRED_DEVICE_EVENTS)
+	/* Let other interrupts run while the PLL locks, with the sources of this interrupt masked so that it cannot nest */
+	#if defined(USB_SERIES_4_AVR) || defined(USB_SERIES_6_AVR) || defined(USB_SERIES_7_AVR)
+	uint8_t PrevUSBCON = USBCON;
+	#endif
+	#if defined(USB_CAN_BE_BOTH)
+	uint8_t PrevOTGIEN = OTGIEN;
+	#endif
+	#if defined(USB_CAN_BE_HOST)
+	uint8_t PrevUHIEN  = UHIEN;
+	#endif
+	uint8_t PrevUDIEN  = UDIEN;
+
+	USB_INT_DisableAllInterrupts();
+	GlobalInterruptEnable();
+
+	while (!(USB_PLL_IsReady()));
+
+	GlobalInterruptDisable();
+
+	#if defined(USB_SERIES_4_AVR) || defined(USB_SERIES_6_AVR) || defined(USB_SERIES_7_AVR)
+	USBCON = PrevUSBCON;
+	#endif
+	#if defined(USB_CAN_BE_BOTH)
+	OTGIEN = PrevOTGIEN;
+	#endif
+	#if defined(USB_CAN_BE_HOST)
+	UHIEN  = PrevUHIEN;
+	#endif
+	UDIEN  = PrevUDIEN;
+	#else
+	while (!(USB_PLL_IsReady()));
+	#endif
+}
+
+#if defined(DEFERRED_DEVICE_EVENTS)
+static void USB_Device_FlushDeferredEvents(void)
+{
+	static const uint8_t DispatchOrder[] =
+		{
+			USB_DEVICE_EVENT_Disconnect,
+			USB_DEVICE_EVENT_Connect,
+			USB_DEVICE_EVENT_Suspend,
+			USB_DEVICE_EVENT_WakeUp,
+			USB_DEVICE_EVENT_Reset,
+			USB_DEVICE_EVENT_StartOfFrame,
+		};
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint8_t PendingEvents = USB_Device_PendingEvents;
+	uint8_t DeviceState   = USB_DeviceState;
+
+	USB_Device_PendingEvents = 0;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	/* The order in which different events were raised is not kept, so the event which led to the current device
+	 * state is dispatched last and the application ends up seeing the same state as the library */
+	uint8_t FinalEvent = 0;
+
+	if (DeviceState == DEVICE_STATE_Unattached)
+	  FinalEvent = USB_DEVICE_EVENT_Disconnect;
+	else if (DeviceState == DEVICE_STATE_Suspended)
+	  FinalEvent = USB_DEVICE_EVENT_Suspend;
+
+	for (uint8_t i = 0; i < sizeof(DispatchOrder); i++)
+	{
+		uint8_t Event = DispatchOrder[i];
+
+		if ((PendingEvents & Event) && (Event != FinalEvent))
+		  USB_Device_DispatchEvent(Event);
+	}
+
+	if (PendingEvents & FinalEvent)
+	  USB_Device_DispatchEvent(FinalEvent);
+}
+
+void USB_Device_ProcessDeferredEvents(void)
+{
+	if (!(USB_Device_PendingEvents))
+	  return;
+
+	USB_Device_FlushDeferredEvents();
+
+	/* Control requests are released only once no event raised since is left pending */
+	#if defined(INTERRUPT_CONTROL_ENDPOINT)
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	if (!(USB_Device_PendingEvents))
+	  USB_Device_HoldSETUPInterrupt(false);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+	#endif
+}
+#endif
+#endif
+
 ISR(USB_GEN_vect, ISR_BLOCK)
 {
 	#if defined(USB_CAN_BE_DEVICE)
@@ -82,7 +263,7 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 	{
 		USB_INT_Clear(USB_INT_SOFI);
 
-		EVENT_USB_Device_StartOfFrame();
+		USB_Device_RaiseEvent(USB_DEVICE_EVENT_StartOfFrame);
 	}
 	#endif
 
@@ -96,11 +277,11 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 			if (!(USB_Options & USB_OPT_MANUAL_PLL))
 			{
 				USB_PLL_On();
-				while (!(USB_PLL_IsReady()));
+				USB_Device_WaitForPLL();
 			}
 
 			USB_DeviceState = DEVICE_STATE_Powered;
-			EVENT_USB_Device_Connect();
+			USB_Device_RaiseEvent(USB_DEVICE_EVENT_Connect);
 		}
 		else
 		{
@@ -108,7 +289,7 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 			  USB_PLL_Off();
 
 			USB_DeviceState = DEVICE_STATE_Unattached;
-			EVENT_USB_Device_Disconnect();
+			USB_Device_RaiseEvent(USB_DEVICE_EVENT_Disconnect);
 		}
 	}
 	#endif
@@ -125,10 +306,10 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 
 		#if defined(USB_SERIES_2_AVR) && !defined(NO_LIMITED_CONTROLLER_CONNECT)
 		USB_DeviceState = DEVICE_STATE_Unattached;
-		EVENT_USB_Device_Disconnect();
+		USB_Device_RaiseEvent(USB_DEVICE_EVENT_Disconnect);
 		#else
 		USB_DeviceState = DEVICE_STATE_Suspended;
-		EVENT_USB_Device_Suspend();
+		USB_Device_RaiseEvent(USB_DEVICE_EVENT_Suspend);
 		#endif
 	}
 
@@ -137,7 +318,7 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 		if (!(USB_Options & USB_OPT_MANUAL_PLL))
 		{
 			USB_PLL_On();
-			while (!(USB_PLL_IsReady()));
+			USB_Device_WaitForPLL();
 		}
 
 		USB_CLK_Unfreeze();
@@ -153,9 +334,9 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 		  USB_DeviceState = (USB_Device_IsAddressSet()) ? DEVICE_STATE_Addressed : DEVICE_STATE_Powered;
 
 		#if defined(USB_SERIES_2_AVR) && !defined(NO_LIMITED_CONTROLLER_CONNECT)
-		EVENT_USB_Device_Connect();
+		USB_Device_RaiseEvent(USB_DEVICE_EVENT_Connect);
 		#else
-		EVENT_USB_Device_WakeUp();
+		USB_Device_RaiseEvent(USB_DEVICE_EVENT_WakeUp);
 		#endif
 	}
 
@@ -174,10 +355,13 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 		                           USB_Device_ControlEndpointSize, 1);
 
 		#if defined(INTERRUPT_CONTROL_ENDPOINT)
+		#if defined(DEFERRED_DEVICE_EVENTS)
+		if (!(USB_Device_SETUPInterruptHeld))
+		#endif
 		USB_INT_Enable(USB_INT_RXSTPI);
 		#endif
 
-		EVENT_USB_Device_Reset();
+		USB_Device_RaiseEvent(USB_DEVICE_EVENT_Reset);
 	}
 	#endif
 
@@ -257,20 +441,65 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 	#endif
 }
 
-#if defined(INTERRUPT_CONTROL_ENDPOINT) && defined(USB_CAN_BE_DEVICE)
+#if (defined(INTERRUPT_CONTROL_ENDPOINT) || defined(INTERRUPT_DATA_ENDPOINTS)) && defined(USB_CAN_BE_DEVICE)
 ISR(USB_COM_vect, ISR_BLOCK)
 {
 	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
 
-	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
-	USB_INT_Disable(USB_INT_RXSTPI);
+	#if defined(INTERRUPT_DATA_ENDPOINTS)
+	uint8_t EndpointInterrupts = Endpoint_GetEndpointInterrupts();
 
-	GlobalInterruptEnable();
+	for (uint8_t EPNum = 1; EPNum < ENDPOINT_TOTAL_ENDPOINTS; EPNum++)
+	{
+		if (!(EndpointInterrupts & (1 << EPNum)))
+		  continue;
 
-	USB_Device_ProcessControlRequest();
+		Endpoint_SelectEndpoint(EPNum);
+		Endpoint_DisableReadyInterrupt();
+
+		uint8_t EndpointAddress = (EPNum | Endpoint_GetEndpointDirection());
+
+		/* The endpoint's own interrupt source is disabled, so other interrupts may be serviced while it is handled */
+		GlobalInterruptEnable();
+
+		EVENT_USB_Device_EndpointReady(EndpointAddress);
+
+		GlobalInterruptDisable();
+	}
+	#endif
+
+	#if defined(INTERRUPT_CONTROL_ENDPOINT)
+	#if defined(INTERRUPT_DATA_ENDPOINTS)
+	if (EndpointInterrupts & (1 << ENDPOINT_CONTROLEP))
+	#endif
+	{
+		Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+
+		if (Endpoint_IsSETUPReceived())
+		{
+			USB_INT_Disable(USB_INT_RXSTPI);
+
+			GlobalInterruptEnable();
+
+			USB_Device_ProcessControlRequest();
+
+			Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+
+			#if defined(DEFERRED_DEVICE_EVENTS)
+			if (!(USB_Device_SETUPInterruptHeld))
+			#endif
+			USB_INT_Enable(USB_INT_RXSTPI);
+		}
+		else if (Endpoint_IsReadyInterruptEnabled() && Endpoint_IsOUTReceived())
+		{
+			/* Data stage of a request deferred by its handler, the request header from the SETUP stage is still valid */
+			Endpoint_DisableReadyInterrupt();
+
+			EVENT_USB_Device_ControlRequest();
+		}
+	}
+	#endif
 
-	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
-	USB_INT_Enable(USB_INT_RXSTPI);
 	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
 }
 #endif
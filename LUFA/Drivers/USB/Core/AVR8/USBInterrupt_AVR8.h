@@ -364,6 +364,10 @@
 		/* Function Prototypes: */
 			void USB_INT_ClearAllInterrupts(void);
 			void USB_INT_DisableAllInterrupts(void);
+
+			#if defined(USB_CAN_BE_DEVICE) && defined(DEFERRED_DEVICE_EVENTS)
+			void USB_Device_ProcessDeferredEvents(void);
+			#endif
 	#endif
 
 	/* Disable C linkage for C++ Compilers: */
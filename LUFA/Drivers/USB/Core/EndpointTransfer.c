@@ -0,0 +1,184 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+#define  __INCLUDE_FROM_USB_DRIVER
+#include "USBMode.h"
+
+#if defined(USB_CAN_BE_DEVICE) && !defined(CONTROL_ONLY_DEVICE)
+
+#define  __INCLUDE_FROM_ENDPOINTTRANSFER_C
+#include "EndpointTransfer.h"
+
+static Endpoint_Transfer_t* Endpoint_TransferQueue[ENDPOINT_TOTAL_ENDPOINTS];
+
+/* Masks of the OUT endpoints whose current bank was left partly read by a completed transfer, and of those among them
+ * whose bank holds a short packet; the packet size can no longer be told from the bytes remaining in such a bank */
+static uint16_t Endpoint_TransferPartialBanks;
+static uint16_t Endpoint_TransferShortBanks;
+
+static uint8_t Endpoint_Transfer_Advance(Endpoint_Transfer_t* const Transfer)
+{
+	uint8_t  ErrorCode;
+	uint16_t EPMask = ((uint16_t)1 << (Transfer->Address & ENDPOINT_EPNUM_MASK));
+
+	if (USB_DeviceState != DEVICE_STATE_Configured)
+	{
+		Endpoint_TransferPartialBanks &= ~EPMask;
+		Endpoint_TransferShortBanks   &= ~EPMask;
+
+		return ENDPOINT_RWSTREAM_DeviceDisconnected;
+	}
+
+	Endpoint_SelectEndpoint(Transfer->Address);
+
+	if (Endpoint_IsStalled())
+	  return ENDPOINT_RWSTREAM_EndpointStalled;
+
+	if (Transfer->Address & ENDPOINT_DIR_IN)
+	{
+		if (!(Endpoint_IsINReady()))
+		  return ENDPOINT_RWSTREAM_IncompleteTransfer;
+
+		if (Transfer->Flags & ENDPOINT_TRANSFER_FLAG_PendingZLP)
+		{
+			Endpoint_ClearIN();
+			return ENDPOINT_RWSTREAM_NoError;
+		}
+
+		if ((ErrorCode = Endpoint_Write_Stream_LE(Transfer->Buffer, Transfer->Length,
+		                                          &Transfer->BytesProcessed)) != ENDPOINT_RWSTREAM_NoError)
+		{
+			return ErrorCode;
+		}
+
+		bool BankFull = !(Endpoint_IsReadWriteAllowed());
+		Endpoint_ClearIN();
+
+		if (BankFull && (Transfer->Flags & ENDPOINT_TRANSFER_FLAG_TerminateZLP))
+		{
+			Transfer->Flags |= ENDPOINT_TRANSFER_FLAG_PendingZLP;
+			return ENDPOINT_RWSTREAM_IncompleteTransfer;
+		}
+	}
+	else
+	{
+		if (!(Endpoint_IsOUTReceived()))
+		  return ENDPOINT_RWSTREAM_IncompleteTransfer;
+
+		bool ShortPacket;
+
+		if (Endpoint_TransferPartialBanks & EPMask)
+		  ShortPacket = (Endpoint_TransferShortBanks & EPMask);
+		else
+		  ShortPacket = (Endpoint_BytesInEndpoint() < Endpoint_GetBankSize());
+
+		Endpoint_TransferPartialBanks &= ~EPMask;
+		Endpoint_TransferShortBanks   &= ~EPMask;
+
+		ErrorCode = Endpoint_Read_Stream_LE(Transfer->Buffer, Transfer->Length, &Transfer->BytesProcessed);
+
+		/* The stream function releases the bank once it is emptied; a short packet, including a zero length
+		 * packet, ends the transfer with the bytes received so far */
+		if (ErrorCode == ENDPOINT_RWSTREAM_IncompleteTransfer)
+		  return (ShortPacket ? ENDPOINT_RWSTREAM_NoError : ENDPOINT_RWSTREAM_IncompleteTransfer);
+		else if (ErrorCode != ENDPOINT_RWSTREAM_NoError)
+		  return ErrorCode;
+
+		if (!(Endpoint_BytesInEndpoint()))
+		{
+			Endpoint_ClearOUT();
+		}
+		else
+		{
+			Endpoint_TransferPartialBanks |= EPMask;
+
+			if (ShortPacket)
+			  Endpoint_TransferShortBanks |= EPMask;
+		}
+	}
+
+	Transfer->BytesProcessed = Transfer->Length;
+	return ENDPOINT_RWSTREAM_NoError;
+}
+
+static void Endpoint_Transfer_Complete(const uint8_t EPNum,
+                                       const uint8_t ErrorCode)
+{
+	Endpoint_Transfer_t* Transfer = Endpoint_TransferQueue[EPNum];
+
+	Endpoint_TransferQueue[EPNum] = Transfer->Next;
+	Transfer->Flags &= ~ENDPOINT_TRANSFER_FLAG_PendingZLP;
+
+	if (Transfer->Callback != NULL)
+	  Transfer->Callback(Transfer, ErrorCode);
+}
+
+void Endpoint_Transfer_Submit(Endpoint_Transfer_t* const Transfer)
+{
+	Endpoint_Transfer_t** QueueTail = &Endpoint_TransferQueue[Transfer->Address & ENDPOINT_EPNUM_MASK];
+
+	while (*QueueTail != NULL)
+	  QueueTail = &(*QueueTail)->Next;
+
+	Transfer->BytesProcessed = 0;
+	Transfer->Flags         &= ~ENDPOINT_TRANSFER_FLAG_PendingZLP;
+	Transfer->Next           = NULL;
+
+	*QueueTail = Transfer;
+}
+
+void Endpoint_Transfer_Pump(void)
+{
+	for (uint8_t EPNum = 1; EPNum < ENDPOINT_TOTAL_ENDPOINTS; EPNum++)
+	{
+		if (Endpoint_TransferQueue[EPNum] == NULL)
+		  continue;
+
+		uint8_t ErrorCode = Endpoint_Transfer_Advance(Endpoint_TransferQueue[EPNum]);
+
+		if (ErrorCode != ENDPOINT_RWSTREAM_IncompleteTransfer)
+		  Endpoint_Transfer_Complete(EPNum, ErrorCode);
+	}
+}
+
+void Endpoint_Transfer_Abort(const uint8_t Address)
+{
+	uint8_t EPNum = (Address & ENDPOINT_EPNUM_MASK);
+
+	while (Endpoint_TransferQueue[EPNum] != NULL)
+	  Endpoint_Transfer_Complete(EPNum, ENDPOINT_RWSTREAM_IncompleteTransfer);
+}
+
+bool Endpoint_Transfer_IsPending(const uint8_t Address)
+{
+	return (Endpoint_TransferQueue[Address & ENDPOINT_EPNUM_MASK] != NULL);
+}
+
+#endif
@@ -0,0 +1,188 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *  \brief Non-blocking queued endpoint transfers.
+ *  \copydetails Group_EndpointTransfer
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the USB driver
+ *        dispatch header located in LUFA/Drivers/USB/USB.h.
+ */
+
+/** \ingroup Group_EndpointRW
+ *  \defgroup Group_EndpointTransfer Non-Blocking Queued Transfers
+ *  \brief Non-blocking queued endpoint transfers.
+ *
+ *  Functions, macros and types related to queuing stream transfers on device endpoints, so that they are
+ *  advanced as far as the endpoint banks allow without ever waiting on the host.
+ *
+ *  Each transfer is described by an application owned \ref Endpoint_Transfer_t structure, which is queued on
+ *  its endpoint via \ref Endpoint_Transfer_Submit(). Transfers on the same endpoint are processed in submission
+ *  order, while transfers on different endpoints progress independently. A call to \ref Endpoint_Transfer_Pump()
+ *  from the main program loop moves as much data as each endpoint's banks currently allow through the resumable
+ *  \c Endpoint_*_Stream_LE() functions, and returns immediately if an endpoint is not ready. When a transfer
+ *  finishes or fails, it is removed from its queue and its completion callback is run from the pump.
+ *
+ *  <b>Example Usage:</b>
+ *  \code
+ *  static uint8_t             Report[300];
+ *  static Endpoint_Transfer_t ReportTransfer;
+ *
+ *  static void ReportSent(Endpoint_Transfer_t* const Transfer,
+ *                         const uint8_t ErrorCode)
+ *  {
+ *      // Transfer finished - ErrorCode is a value from the Endpoint_Stream_RW_ErrorCodes_t enum
+ *  }
+ *
+ *  ReportTransfer.Address  = DATA_IN_EPADDR;
+ *  ReportTransfer.Buffer   = Report;
+ *  ReportTransfer.Length   = sizeof(Report);
+ *  ReportTransfer.Flags    = ENDPOINT_TRANSFER_FLAG_TerminateZLP;
+ *  ReportTransfer.Callback = ReportSent;
+ *  Endpoint_Transfer_Submit(&ReportTransfer);
+ *
+ *  for (;;)
+ *  {
+ *      Endpoint_Transfer_Pump();
+ *      USB_USBTask();
+ *  }
+ *  \endcode
+ *
+ *  @{
+ */
+
+#ifndef __ENDPOINT_TRANSFER_H__
+#define __ENDPOINT_TRANSFER_H__
+
+	/* Includes: */
+		#include "../../../Common/Common.h"
+		#include "USBMode.h"
+		#include "USBTask.h"
+		#include "Endpoint.h"
+		#include "EndpointStream.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_USB_DRIVER)
+			#error Do not include this file directly. Include LUFA/Drivers/USB/USB.h instead.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			/** Flag for \ref Endpoint_Transfer_t::Flags, indicating that an IN transfer whose last packet fills
+			 *  the endpoint bank should be terminated with a zero length packet, so that the host can detect the
+			 *  end of the transfer.
+			 */
+			#define ENDPOINT_TRANSFER_FLAG_TerminateZLP   (1 << 0)
+
+		/* Type Defines: */
+			/** \brief Queued Endpoint Transfer Structure.
+			 *
+			 *  Type define for a queued endpoint transfer. The application fills in the public fields before
+			 *  submitting the transfer via \ref Endpoint_Transfer_Submit(), and must not alter the structure or
+			 *  its buffer until the transfer's completion callback has run.
+			 */
+			typedef struct USB_Endpoint_Transfer
+			{
+				uint8_t  Address; /**< Address of the endpoint to transfer on, including its direction. */
+				void*    Buffer; /**< Pointer to the data to send, or the location to store received data. */
+				uint16_t Length; /**< Total number of bytes to transfer. */
+				uint8_t  Flags; /**< Mask of \c ENDPOINT_TRANSFER_FLAG_* flags. */
+				void     (* Callback)(struct USB_Endpoint_Transfer* const Transfer,
+				                      const uint8_t ErrorCode); /**< Optional completion callback, run from
+				                                                 *   \ref Endpoint_Transfer_Pump() with a value from
+				                                                 *   the \ref Endpoint_Stream_RW_ErrorCodes_t enum.
+				                                                 */
+
+				uint16_t BytesProcessed; /**< Number of bytes transferred so far, updated by the library. Once
+				                          *   the transfer has completed, this is the number of bytes sent or
+				                          *   received.
+				                          */
+
+				struct USB_Endpoint_Transfer* Next; /**< Next queued transfer on the same endpoint, private to the library. */
+			} Endpoint_Transfer_t;
+
+		/* Function Prototypes: */
+			/** Queues a transfer on its endpoint, after any transfers already pending on that endpoint. The transfer
+			 *  is only advanced by calls to \ref Endpoint_Transfer_Pump().
+			 *
+			 *  IN transfers end by sending their last, possibly partial, packet to the host. OUT transfers end once
+			 *  \ref Endpoint_Transfer_t::Length bytes have been read; any remaining bytes in the last packet are left
+			 *  in the endpoint bank for the next transfer. An OUT transfer also ends early, without error, once it has
+			 *  read a packet shorter than the endpoint's bank size, including a zero length packet, in which case
+			 *  \ref Endpoint_Transfer_t::BytesProcessed holds the number of bytes received.
+			 *
+			 *  \note This routine should not be used on CONTROL type endpoints, and must not be called from an
+			 *        interrupt.
+			 *
+			 *  \param[in,out] Transfer  Pointer to the transfer to queue.
+			 */
+			void Endpoint_Transfer_Submit(Endpoint_Transfer_t* const Transfer) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Advances every pending transfer as far as its endpoint's banks currently allow, without waiting for
+			 *  the host. Completion callbacks of transfers that finish or fail are run from this function, and may
+			 *  submit further transfers. This should be called regularly from the main program loop.
+			 */
+			void Endpoint_Transfer_Pump(void);
+
+			/** Removes all pending transfers from the given endpoint's queue, running each one's completion callback
+			 *  with the \ref ENDPOINT_RWSTREAM_IncompleteTransfer error code.
+			 *
+			 *  \param[in] Address  Address of the endpoint whose transfers are to be aborted.
+			 */
+			void Endpoint_Transfer_Abort(const uint8_t Address);
+
+			/** Determines if any transfer is pending on the given endpoint.
+			 *
+			 *  \param[in] Address  Address of the endpoint to check.
+			 *
+			 *  \return Boolean \c true if a transfer is queued on the endpoint, \c false otherwise.
+			 */
+			bool Endpoint_Transfer_IsPending(const uint8_t Address) ATTR_WARN_UNUSED_RESULT;
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#define ENDPOINT_TRANSFER_FLAG_PendingZLP     (1 << 7)
+	#endif
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
@@ -73,6 +73,30 @@
 		#endif
 
 	/* Public Interface - May be used in end-application: */
+		/* Macros: */
+			#if defined(USB_CAN_BE_DEVICE) || defined(__DOXYGEN__)
+			/** \name Deferrable Device Event Masks */
+			//@{
+			/** Mask for the \ref EVENT_USB_Device_Connect() event, for use in the \c DEFERRED_DEVICE_EVENTS compile time token. */
+			#define USB_DEVICE_EVENT_Connect           (1 << 0)
+
+			/** Mask for the \ref EVENT_USB_Device_Disconnect() event, for use in the \c DEFERRED_DEVICE_EVENTS compile time token. */
+			#define USB_DEVICE_EVENT_Disconnect        (1 << 1)
+
+			/** Mask for the \ref EVENT_USB_Device_Suspend() event, for use in the \c DEFERRED_DEVICE_EVENTS compile time token. */
+			#define USB_DEVICE_EVENT_Suspend           (1 << 2)
+
+			/** Mask for the \ref EVENT_USB_Device_WakeUp() event, for use in the \c DEFERRED_DEVICE_EVENTS compile time token. */
+			#define USB_DEVICE_EVENT_WakeUp            (1 << 3)
+
+			/** Mask for the \ref EVENT_USB_Device_Reset() event, for use in the \c DEFERRED_DEVICE_EVENTS compile time token. */
+			#define USB_DEVICE_EVENT_Reset             (1 << 4)
+
+			/** Mask for the \ref EVENT_USB_Device_StartOfFrame() event, for use in the \c DEFERRED_DEVICE_EVENTS compile time token. */
+			#define USB_DEVICE_EVENT_StartOfFrame      (1 << 5)
+			//@}
+			#endif
+
 		/* Pseudo-Functions for Doxygen: */
 		#if !defined(__INCLUDE_FROM_EVENTS_C) || defined(__DOXYGEN__)
 			/** Event for USB mode pin level change. This event fires when the USB interface is set to dual role
@@ -245,6 +269,13 @@
 			 *        or appropriate class specification. In all instances, the library has already read the
 			 *        request SETUP parameters into the \ref USB_ControlRequest structure which should then be used
 			 *        by the application to determine how to handle the issued request.
+			 *        \n\n
+			 *
+			 *  \note When the \c INTERRUPT_CONTROL_ENDPOINT token is used on AVR8 devices, a handler may return after
+			 *        clearing the SETUP packet and enabling the control endpoint's ready interrupt via
+			 *        \ref Endpoint_EnableReadyInterrupt(). This event then fires again, without a SETUP packet, once the
+			 *        OUT data stage packet of the request has been received, so that the request can be completed
+			 *        without busy-waiting inside the USB interrupt.
 			 */
 			void EVENT_USB_Device_ControlRequest(void);
 
@@ -325,6 +356,33 @@
 			 *        \ref Group_USBManagement documentation).
 			 */
 			void EVENT_USB_Device_StartOfFrame(void);
+
+			/** Event for a data endpoint becoming ready, when enabled. This event fires from the USB controller's
+			 *  communication interrupt when an OUT endpoint has received a packet from the host, or when an IN
+			 *  endpoint has a bank free to accept new data, so that it may be serviced immediately rather than
+			 *  polled from the main program loop. The given endpoint is selected when the event fires.
+			 *
+			 *  This event is run from an interrupt with global interrupts enabled again, as for control requests
+			 *  when \c INTERRUPT_CONTROL_ENDPOINT is defined, so that other interrupts are not held off while the
+			 *  handler moves the endpoint data. The handler cannot be re-entered for the same endpoint, whose ready
+			 *  interrupt stays disabled until it is enabled again; enabling it from the handler itself while another
+			 *  bank is waiting fires the event again, nested into the current one.
+			 *
+			 *  \pre This event is only dispatched if the \c INTERRUPT_DATA_ENDPOINTS token is defined, and for each
+			 *       endpoint only once its ready interrupt has been enabled via \ref Endpoint_EnableReadyInterrupt().
+			 *       The interrupt is disabled again before the event fires, and must be re-enabled to request the next
+			 *       notification.
+			 *       \n\n
+			 *
+			 *  \note This event does not exist if the \c USB_HOST_ONLY token is supplied to the compiler (see
+			 *        \ref Group_USBManagement documentation).
+			 *        \n\n
+			 *
+			 *  \note This event is currently only dispatched on the AVR8 architecture.
+			 *
+			 *  \param[in] EndpointAddress  Address of the endpoint which has become ready, including its direction.
+			 */
+			void EVENT_USB_Device_EndpointReady(const uint8_t EndpointAddress);
 		#endif
 
 	/* Private Interface - For use in library only: */
@@ -357,6 +415,7 @@
 					void EVENT_USB_Device_WakeUp(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
 					void EVENT_USB_Device_Reset(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
 					void EVENT_USB_Device_StartOfFrame(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
+					void EVENT_USB_Device_EndpointReady(const uint8_t EndpointAddress) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
 				#endif
 			#endif
 	#endif
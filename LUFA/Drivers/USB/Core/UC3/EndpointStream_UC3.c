@@ -39,6 +39,98 @@
 #include "EndpointStream_UC3.h"
 
 #if !defined(CONTROL_ONLY_DEVICE)
+static void Endpoint_Write_Block_PRV(const uint8_t* Buffer,
+                                     uint16_t Length)
+{
+	volatile uint8_t* FIFOPos = USB_Endpoint_FIFOPos[USB_Endpoint_SelectedEndpoint];
+
+	while (Length && ((uintptr_t)FIFOPos & 0x03))
+	{
+		*(FIFOPos++) = *(Buffer++);
+		Length--;
+	}
+
+	volatile uint32_t* FIFOWordPos = (volatile uint32_t*)FIFOPos;
+
+	if (!((uintptr_t)Buffer & 0x03))
+	{
+		const uint32_t* BufferWord = (const uint32_t*)Buffer;
+
+		while (Length >= 4)
+		{
+			*(FIFOWordPos++) = *(BufferWord++);
+			Length -= 4;
+		}
+
+		Buffer = (const uint8_t*)BufferWord;
+	}
+	else
+	{
+		while (Length >= 4)
+		{
+			*(FIFOWordPos++) = (((uint32_t)Buffer[0] << 24) | ((uint32_t)Buffer[1] << 16) |
+			                    ((uint32_t)Buffer[2] << 8)  |  (uint32_t)Buffer[3]);
+			Buffer += 4;
+			Length -= 4;
+		}
+	}
+
+	FIFOPos = (volatile uint8_t*)FIFOWordPos;
+
+	while (Length--)
+	  *(FIFOPos++) = *(Buffer++);
+
+	USB_Endpoint_FIFOPos[USB_Endpoint_SelectedEndpoint] = FIFOPos;
+}
+
+static void Endpoint_Read_Block_PRV(uint8_t* Buffer,
+                                    uint16_t Length)
+{
+	volatile uint8_t* FIFOPos = USB_Endpoint_FIFOPos[USB_Endpoint_SelectedEndpoint];
+
+	while (Length && ((uintptr_t)FIFOPos & 0x03))
+	{
+		*(Buffer++) = *(FIFOPos++);
+		Length--;
+	}
+
+	volatile uint32_t* FIFOWordPos = (volatile uint32_t*)FIFOPos;
+
+	if (!((uintptr_t)Buffer & 0x03))
+	{
+		uint32_t* BufferWord = (uint32_t*)Buffer;
+
+		while (Length >= 4)
+		{
+			*(BufferWord++) = *(FIFOWordPos++);
+			Length -= 4;
+		}
+
+		Buffer = (uint8_t*)BufferWord;
+	}
+	else
+	{
+		while (Length >= 4)
+		{
+			uint32_t Word = *(FIFOWordPos++);
+
+			Buffer[0] = (Word >> 24);
+			Buffer[1] = (Word >> 16);
+			Buffer[2] = (Word >> 8);
+			Buffer[3] = (Word & 0xFF);
+			Buffer += 4;
+			Length -= 4;
+		}
+	}
+
+	FIFOPos = (volatile uint8_t*)FIFOWordPos;
+
+	while (Length--)
+	  *(Buffer++) = *(FIFOPos++);
+
+	USB_Endpoint_FIFOPos[USB_Endpoint_SelectedEndpoint] = FIFOPos;
+}
+
 uint8_t Endpoint_Discard_Stream(uint16_t Length,
                                 uint16_t* const BytesProcessed)
 {
@@ -117,6 +209,43 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+uint16_t Endpoint_Fill_Bank(const uint8_t Address,
+                            const EndpointFillCallbackPtr_t Callback,
+                            void* const Context)
+{
+	Endpoint_SelectEndpoint(Address);
+
+	if (!(Endpoint_IsINReady()))
+	  return 0;
+
+	uint16_t BytesWritten = Callback(Endpoint_GetBankSize() - Endpoint_BytesInEndpoint(), Context);
+
+	if (BytesWritten)
+	  Endpoint_ClearIN();
+
+	return BytesWritten;
+}
+
+uint16_t Endpoint_Consume_Bank(const uint8_t Address,
+                               const EndpointConsumeCallbackPtr_t Callback,
+                               void* const Context)
+{
+	Endpoint_SelectEndpoint(Address);
+
+	if (!(Endpoint_IsOUTReceived()))
+	  return 0;
+
+	uint16_t BytesConsumed = 0;
+
+	if (Endpoint_BytesInEndpoint())
+	  BytesConsumed = Callback(Endpoint_BytesInEndpoint(), Context);
+
+	if (!(Endpoint_BytesInEndpoint()))
+	  Endpoint_ClearOUT();
+
+	return BytesConsumed;
+}
+
 /* The following abuses the C preprocessor in order to copy-paste common code with slight alterations,
  * so that the code needs to be written once. It is a crude form of templating to reduce code maintenance. */
 
@@ -126,6 +255,8 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(*BufferPtr)
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Bytes)   Endpoint_Write_Block_PRV(BufferPtr, Bytes)
+#define  TEMPLATE_BANK_BYTES_AVAILABLE()           (Endpoint_GetBankSize() - Endpoint_BytesInEndpoint())
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_Stream_BE
@@ -142,6 +273,8 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *BufferPtr = Endpoint_Read_8()
+#define  TEMPLATE_TRANSFER_BLOCK(BufferPtr, Bytes)   Endpoint_Read_Block_PRV(BufferPtr, Bytes)
+#define  TEMPLATE_BANK_BYTES_AVAILABLE()           Endpoint_BytesInEndpoint()
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_BE
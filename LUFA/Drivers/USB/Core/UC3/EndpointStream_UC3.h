@@ -65,7 +65,87 @@
 		#endif
 
 	/* Public Interface - May be used in end-application: */
+		/* Type Defines: */
+			/** Type define for a callback which fills the currently selected IN endpoint's bank in place, via
+			 *  \ref Endpoint_Write_8() and related functions, or a stream function limited to the given length.
+			 *
+			 *  \param[in]     BytesFree  Number of bytes that may be written into the bank.
+			 *  \param[in,out] Context    Pointer to application defined state, as given to \ref Endpoint_Fill_Bank().
+			 *
+			 *  \return Number of bytes written into the bank.
+			 */
+			typedef uint16_t (* EndpointFillCallbackPtr_t)(uint16_t BytesFree, void* Context);
+
+			/** Type define for a callback which consumes data from the currently selected OUT endpoint's bank in place,
+			 *  via \ref Endpoint_Read_8() and related functions, or a stream function limited to the given length.
+			 *
+			 *  \param[in]     BytesAvailable  Number of bytes that may be read from the bank.
+			 *  \param[in,out] Context         Pointer to application defined state, as given to \ref Endpoint_Consume_Bank().
+			 *
+			 *  \return Number of bytes read from the bank.
+			 */
+			typedef uint16_t (* EndpointConsumeCallbackPtr_t)(uint16_t BytesAvailable, void* Context);
+
 		/* Function Prototypes: */
+			/** \name Callback functions for in-place bank access */
+			//@{
+
+			/** Selects the given IN endpoint and, if its current bank can accept data, calls the given callback to write
+			 *  directly into the bank, without an intermediate RAM buffer. Once the callback returns, the bank is sent
+			 *  to the host via \ref Endpoint_ClearIN() if any data was written to it. This function does not block if
+			 *  no bank is available.
+			 *
+			 *  <b>Example Usage:</b>
+			 *  \code
+			 *  static uint16_t FillFromRingBuffer(uint16_t BytesFree, void* Context)
+			 *  {
+			 *      RingBuffer_t* Buffer = (RingBuffer_t*)Context;
+			 *      uint16_t      Count  = MIN(RingBuffer_GetCount(Buffer), BytesFree);
+			 *
+			 *      for (uint16_t i = 0; i < Count; i++)
+			 *        Endpoint_Write_8(RingBuffer_Remove(Buffer));
+			 *
+			 *      return Count;
+			 *  }
+			 *
+			 *  Endpoint_Fill_Bank(CDC_TX_EPADDR, FillFromRingBuffer, &USARTtoUSB_Buffer);
+			 *  \endcode
+			 *
+			 *  \note A bank filled completely is sent as a full packet; if this ends a transfer, the application is
+			 *        responsible for terminating it with a zero length packet.
+			 *
+			 *  \note This routine should not be used on CONTROL type endpoints.
+			 *
+			 *  \param[in]     Address   Address of the IN endpoint to fill.
+			 *  \param[in]     Callback  Callback which writes the data into the endpoint's bank.
+			 *  \param[in,out] Context   Pointer to application defined state, passed through to the callback.
+			 *
+			 *  \return Number of bytes written into the endpoint's bank and sent.
+			 */
+			uint16_t Endpoint_Fill_Bank(const uint8_t Address,
+			                            const EndpointFillCallbackPtr_t Callback,
+			                            void* const Context) ATTR_NON_NULL_PTR_ARG(2);
+
+			/** Selects the given OUT endpoint and, if a packet has been received from the host, calls the given callback
+			 *  to read directly from the bank, without an intermediate RAM buffer. Once the callback has consumed all
+			 *  data in the bank, it is released via \ref Endpoint_ClearOUT(); otherwise it is kept so that the
+			 *  remainder is offered to the callback on the next call, and the host is NAKed meanwhile. This function
+			 *  does not block if no packet has been received.
+			 *
+			 *  \note This routine should not be used on CONTROL type endpoints.
+			 *
+			 *  \param[in]     Address   Address of the OUT endpoint to consume from.
+			 *  \param[in]     Callback  Callback which reads the data from the endpoint's bank.
+			 *  \param[in,out] Context   Pointer to application defined state, passed through to the callback.
+			 *
+			 *  \return Number of bytes consumed from the endpoint's bank.
+			 */
+			uint16_t Endpoint_Consume_Bank(const uint8_t Address,
+			                               const EndpointConsumeCallbackPtr_t Callback,
+			                               void* const Context) ATTR_NON_NULL_PTR_ARG(2);
+
+			//@}
+
 			/** \name Stream functions for null data */
 			//@{
 
@@ -232,6 +232,18 @@
 				return (&AVR32_USBB.UESTA0)[USB_Endpoint_SelectedEndpoint].byct;
 			}
 
+			/** Retrieves the size of each bank of the currently selected endpoint, as set when it was configured.
+			 *
+			 *  \ingroup Group_EndpointRW_UC3
+			 *
+			 *  \return Size in bytes of each of the currently selected endpoint's banks.
+			 */
+			static inline uint16_t Endpoint_GetBankSize(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+			static inline uint16_t Endpoint_GetBankSize(void)
+			{
+				return ((uint16_t)8 << (&AVR32_USBB.UECFG0)[USB_Endpoint_SelectedEndpoint].epsize);
+			}
+
 			/** Determines the currently selected endpoint's direction.
 			 *
 			 *  \return The currently selected endpoint's direction, as a \c ENDPOINT_DIR_* mask.
@@ -68,10 +68,24 @@ uint8_t TEMPLATE_FUNC_NAME (TEMPLATE_BUFFER_TYPE const Buffer,
 		}
 		else
 		{
+			#if defined(TEMPLATE_TRANSFER_BLOCK)
+			uint16_t BytesInPass = TEMPLATE_BANK_BYTES_AVAILABLE();
+
+			if (BytesInPass > Length)
+			  BytesInPass = Length;
+			else if (!(BytesInPass))
+			  BytesInPass = 1;
+
+			TEMPLATE_TRANSFER_BLOCK(DataStream, BytesInPass);
+			TEMPLATE_BUFFER_MOVE(DataStream, BytesInPass);
+			Length          -= BytesInPass;
+			BytesInTransfer += BytesInPass;
+			#else
 			TEMPLATE_TRANSFER_BYTE(DataStream);
 			TEMPLATE_BUFFER_MOVE(DataStream, 1);
 			Length--;
 			BytesInTransfer++;
+			#endif
 		}
 	}
 
@@ -84,6 +98,8 @@ uint8_t TEMPLATE_FUNC_NAME (TEMPLATE_BUFFER_TYPE const Buffer,
 #undef TEMPLATE_CLEAR_ENDPOINT
 #undef TEMPLATE_BUFFER_OFFSET
 #undef TEMPLATE_BUFFER_MOVE
+#undef TEMPLATE_TRANSFER_BLOCK
+#undef TEMPLATE_BANK_BYTES_AVAILABLE
 
 #endif
 
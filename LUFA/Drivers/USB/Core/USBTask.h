@@ -67,6 +67,10 @@
 			#error Do not include this file directly. Include LUFA/Drivers/USB/USB.h instead.
 		#endif
 
+		#if defined(DEFERRED_DEVICE_EVENTS) && (ARCH != ARCH_AVR8)
+			#error The DEFERRED_DEVICE_EVENTS token is currently only supported on the AVR8 architecture.
+		#endif
+
 	/* Public Interface - May be used in end-application: */
 		/* Global Variables: */
 			/** Indicates if the USB interface is currently initialized but not necessarily connected to a host
@@ -166,6 +170,11 @@
 			 *  If in device mode (only), the control endpoint can instead be managed via interrupts entirely by the library
 			 *  by defining the INTERRUPT_CONTROL_ENDPOINT token and passing it to the compiler via the -D switch.
 			 *
+			 *  When the \c DEFERRED_DEVICE_EVENTS token is defined, the device events it selects are queued by the USB
+			 *  interrupt and fired from this task, which must then be called regularly in device mode. With
+			 *  \c INTERRUPT_CONTROL_ENDPOINT also defined, control requests are held off from the moment such an event is
+			 *  queued until this task has fired it.
+			 *
 			 *  \see \ref Group_Events for more information on the USB events.
 			 *
 			 *  \ingroup Group_USBManagement
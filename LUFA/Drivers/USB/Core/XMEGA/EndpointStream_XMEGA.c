@@ -117,6 +117,43 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	return ENDPOINT_RWSTREAM_NoError;
 }
 
+uint16_t Endpoint_Fill_Bank(const uint8_t Address,
+                            const EndpointFillCallbackPtr_t Callback,
+                            void* const Context)
+{
+	Endpoint_SelectEndpoint(Address);
+
+	if (!(Endpoint_IsINReady()))
+	  return 0;
+
+	uint16_t BytesWritten = Callback(Endpoint_GetBankSize() - Endpoint_BytesInEndpoint(), Context);
+
+	if (BytesWritten)
+	  Endpoint_ClearIN();
+
+	return BytesWritten;
+}
+
+uint16_t Endpoint_Consume_Bank(const uint8_t Address,
+                               const EndpointConsumeCallbackPtr_t Callback,
+                               void* const Context)
+{
+	Endpoint_SelectEndpoint(Address);
+
+	if (!(Endpoint_IsOUTReceived()))
+	  return 0;
+
+	uint16_t BytesConsumed = 0;
+
+	if (Endpoint_BytesInEndpoint())
+	  BytesConsumed = Callback(Endpoint_BytesInEndpoint(), Context);
+
+	if (!(Endpoint_BytesInEndpoint()))
+	  Endpoint_ClearOUT();
+
+	return BytesConsumed;
+}
+
 /* The following abuses the C preprocessor in order to copy-paste common code with slight alterations,
  * so that the code needs to be written once. It is a crude form of templating to reduce code maintenance. */
 
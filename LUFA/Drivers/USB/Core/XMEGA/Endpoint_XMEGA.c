@@ -106,6 +106,62 @@ void Endpoint_ClearOUT(void)
 	USB_Endpoint_SelectedFIFO->Position  = 0;
 }
 
+bool Endpoint_StartMultiPacket(void* const Buffer,
+                               const uint16_t Length,
+                               const uint8_t Flags)
+{
+	if (Length > ENDPOINT_MULTIPACKET_MAX_LENGTH)
+	  return false;
+
+	if ((USB_Endpoint_SelectedHandle->CTRL & USB_EP_TYPE_gm) == USB_EP_TYPE_CONTROL_gc)
+	  return false;
+
+	USB_Endpoint_SelectedHandle->STATUS |= USB_EP_BUSNACK0_bm;
+	USB_Endpoint_SelectedHandle->CTRL   |= USB_EP_MULTIPKT_bm;
+	USB_Endpoint_SelectedHandle->DATAPTR = (intptr_t)Buffer;
+
+	if (USB_Endpoint_SelectedEndpoint & ENDPOINT_DIR_IN)
+	{
+		USB_Endpoint_SelectedHandle->AUXDATA = 0;
+		USB_Endpoint_SelectedHandle->CNT     = (Flags & ENDPOINT_MULTIPACKET_FLAG_AutoZLP) ? (Length | ENDPOINT_CNT_AUTOZLP_MASK) : Length;
+	}
+	else
+	{
+		USB_Endpoint_SelectedHandle->AUXDATA = Length;
+		USB_Endpoint_SelectedHandle->CNT     = 0;
+	}
+
+	USB_Endpoint_SelectedHandle->STATUS &= ~(USB_EP_TRNCOMPL0_bm | USB_EP_BUSNACK0_bm | USB_EP_OVF_bm);
+
+	return true;
+}
+
+uint16_t Endpoint_EndMultiPacket(void)
+{
+	uint16_t BytesTransferred;
+
+	USB_Endpoint_SelectedHandle->STATUS |= USB_EP_BUSNACK0_bm;
+	USB_Endpoint_SelectedHandle->CTRL   &= ~USB_EP_MULTIPKT_bm;
+
+	if (USB_Endpoint_SelectedEndpoint & ENDPOINT_DIR_IN)
+	{
+		BytesTransferred = USB_Endpoint_SelectedHandle->AUXDATA;
+		USB_Endpoint_SelectedHandle->CNT     = 0;
+	}
+	else
+	{
+		BytesTransferred = (USB_Endpoint_SelectedHandle->CNT & ~ENDPOINT_CNT_AUTOZLP_MASK);
+		USB_Endpoint_SelectedHandle->CNT     = 0;
+		USB_Endpoint_SelectedFIFO->Length    = 0;
+		USB_Endpoint_SelectedHandle->STATUS &= ~(USB_EP_TRNCOMPL0_bm | USB_EP_BUSNACK0_bm | USB_EP_OVF_bm);
+	}
+
+	USB_Endpoint_SelectedHandle->DATAPTR = (intptr_t)USB_Endpoint_SelectedFIFO->Data;
+	USB_Endpoint_SelectedFIFO->Position  = 0;
+
+	return BytesTransferred;
+}
+
 void Endpoint_StallTransaction(void)
 {
 	USB_Endpoint_SelectedHandle->CTRL |= USB_EP_STALL_bm;
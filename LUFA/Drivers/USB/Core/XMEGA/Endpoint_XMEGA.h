@@ -104,8 +104,25 @@
 				#endif
 			#endif
 
+			/** Maximum number of bytes which may be moved in a single multi-packet transfer started via
+			 *  \ref Endpoint_StartMultiPacket(), limited by the width of the controller's byte counters.
+			 */
+			#define ENDPOINT_MULTIPACKET_MAX_LENGTH         1023
+
+			/** \name Multi-Packet Transfer Flags */
+			//@{
+			/** Flag for \ref Endpoint_StartMultiPacket(), indicating that the controller should automatically
+			 *  append a Zero Length Packet to an IN transfer whose length is an exact multiple of the endpoint
+			 *  size, so that the host can detect the end of the transfer.
+			 */
+			#define ENDPOINT_MULTIPACKET_FLAG_AutoZLP       (1 << 0)
+			//@}
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
+		/* Macros: */
+			#define ENDPOINT_CNT_AUTOZLP_MASK               0x8000
+
 		/* Type Defines: */
 			typedef struct
 			{
@@ -270,6 +287,18 @@
 				  return (USB_Endpoint_SelectedFIFO->Length - USB_Endpoint_SelectedFIFO->Position);
 			}
 
+			/** Retrieves the size of each bank of the currently selected endpoint, as set when it was configured.
+			 *
+			 *  \ingroup Group_EndpointRW_XMEGA
+			 *
+			 *  \return Size in bytes of each of the currently selected endpoint's banks.
+			 */
+			static inline uint16_t Endpoint_GetBankSize(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+			static inline uint16_t Endpoint_GetBankSize(void)
+			{
+				return ((uint16_t)8 << ((USB_Endpoint_SelectedHandle->CTRL & USB_EP_BUFSIZE_gm) >> USB_EP_BUFSIZE_gp));
+			}
+
 			/** Get the endpoint address of the currently selected endpoint. This is typically used to save
 			 *  the currently selected endpoint so that it can be restored after another endpoint has been
 			 *  manipulated.
@@ -392,6 +421,60 @@
 			 */
 			void Endpoint_ClearOUT(void);
 
+			/** Starts a zero-copy multi-packet transfer on the currently selected non-CONTROL endpoint. The
+			 *  endpoint's data pointer is redirected from its internal FIFO to the given application buffer
+			 *  and the controller's multi-packet mode is enabled, so that the whole buffer is sent to or filled
+			 *  from the host without any CPU intervention between packets. Once the transfer completes (see
+			 *  \ref Endpoint_IsMultiPacketComplete()) the endpoint must be returned to normal packet operation
+			 *  via \ref Endpoint_EndMultiPacket().
+			 *
+			 *  For IN endpoints the transfer completes once all the given bytes (and the optional trailing Zero
+			 *  Length Packet) have been sent. For OUT endpoints the transfer completes once the buffer has been
+			 *  filled or the host sends a short packet; in this case the buffer length should be a multiple of
+			 *  the endpoint size so that the controller never writes past the end of the buffer.
+			 *
+			 *  \ingroup Group_EndpointPacketManagement_XMEGA
+			 *
+			 *  \note The buffer must remain valid and untouched by the application until
+			 *        \ref Endpoint_EndMultiPacket() has been called.
+			 *
+			 *  \param[in,out] Buffer  Pointer to the application buffer to send from or receive into.
+			 *  \param[in]     Length  Number of bytes to send, or the size of the receive buffer.
+			 *  \param[in]     Flags   Mask of \c ENDPOINT_MULTIPACKET_FLAG_* flags for the transfer.
+			 *
+			 *  \return Boolean \c true if the transfer was started, \c false if the length exceeds
+			 *          \ref ENDPOINT_MULTIPACKET_MAX_LENGTH or the endpoint is a CONTROL type endpoint.
+			 */
+			bool Endpoint_StartMultiPacket(void* const Buffer,
+			                               const uint16_t Length,
+			                               const uint8_t Flags) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Determines if a multi-packet transfer started on the currently selected endpoint via
+			 *  \ref Endpoint_StartMultiPacket() has completed.
+			 *
+			 *  \ingroup Group_EndpointPacketManagement_XMEGA
+			 *
+			 *  \return Boolean \c true if the transfer has completed, \c false otherwise.
+			 */
+			static inline bool Endpoint_IsMultiPacketComplete(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+			static inline bool Endpoint_IsMultiPacketComplete(void)
+			{
+				return ((USB_Endpoint_SelectedHandle->STATUS & USB_EP_TRNCOMPL0_bm) ? true : false);
+			}
+
+			/** Ends a multi-packet transfer on the currently selected endpoint, returning the endpoint to normal
+			 *  single packet operation through its internal FIFO. If the transfer has not yet completed it is
+			 *  aborted, and any packet the controller is processing at that moment may be lost.
+			 *
+			 *  After this call an IN endpoint is ready for a new packet, and an OUT endpoint is armed to receive
+			 *  the next packet from the host into its FIFO.
+			 *
+			 *  \ingroup Group_EndpointPacketManagement_XMEGA
+			 *
+			 *  \return Number of bytes sent to or received from the host during the transfer.
+			 */
+			uint16_t Endpoint_EndMultiPacket(void);
+
 			/** Stalls the current endpoint, indicating to the host that a logical problem occurred with the
 			 *  indicated endpoint and that the current transfer sequence should be aborted. This provides a
 			 *  way for devices to indicate invalid commands to the host so that the current transfer can be
@@ -402,6 +402,7 @@
 			#include "Core/Endpoint.h"
 			#include "Core/DeviceStandardReq.h"
 			#include "Core/EndpointStream.h"
+			#include "Core/EndpointTransfer.h"
 		#endif
 
 		#if defined(USB_CAN_BE_BOTH) || defined(__DOXYGEN__)
@@ -0,0 +1,150 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Event character flushing of the data received from the USART. When the configured character is received, the
+ *  data buffered up to and including it is sent to the host at once instead of after the receive timeout, so that
+ *  the host sees the end of each line or frame without the idle time. The character is set by the host through a
+ *  vendor control request, and persisted in EEPROM from the main loop.
+ */
+
+#include "EventChar.h"
+
+#if defined(EVENT_CHAR_FLUSH)
+
+EventChar_State_t EventChar_State;
+EventChar_Stats_t EventChar_Stats;
+
+/** Event character settings persisted across resets, disabled while the EEPROM is erased. */
+static EventChar_Settings_t EEMEM EventChar_SavedSettings;
+
+/** Initializes the event character from the settings persisted in EEPROM. */
+void EventChar_Init(void)
+{
+	EventChar_State.SavePending  = false;
+	EventChar_State.FlushPending = false;
+
+	eeprom_read_block(&EventChar_State.Settings, &EventChar_SavedSettings, sizeof(EventChar_Settings_t));
+
+	EventChar_ResetStats();
+}
+
+/** Changes the event character, as requested by the host. The new settings take effect at once, and are written to
+ *  EEPROM by \ref EventChar_Task() so that the USB interrupt is not held up by the write.
+ *
+ *  \param[in] Value  Character in the low byte, enabled if \ref EVENT_CHAR_ENABLE_MASK is set.
+ */
+void EventChar_Set(const uint16_t Value)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	EventChar_State.Settings.Char    = (Value & 0xFF);
+	EventChar_State.Settings.Enabled = (Value & EVENT_CHAR_ENABLE_MASK) ? 1 : 0;
+	EventChar_State.SavePending      = true;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Writes changed event character settings to EEPROM, one byte per call, without waiting for the EEPROM. This should
+ *  be called regularly from the main loop.
+ */
+void EventChar_Task(void)
+{
+	if (!(EventChar_State.SavePending) || !(eeprom_is_ready()))
+	  return;
+
+	EventChar_Settings_t Settings = EventChar_State.Settings;
+
+	if (eeprom_read_byte(&EventChar_SavedSettings.Char) != Settings.Char)
+	{
+		eeprom_write_byte(&EventChar_SavedSettings.Char, Settings.Char);
+		return;
+	}
+
+	if (eeprom_read_byte(&EventChar_SavedSettings.Enabled) != Settings.Enabled)
+	{
+		eeprom_write_byte(&EventChar_SavedSettings.Enabled, Settings.Enabled);
+		return;
+	}
+
+	/* Keep saving if the host changed the settings again while they were written */
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	if ((EventChar_State.Settings.Char == Settings.Char) && (EventChar_State.Settings.Enabled == Settings.Enabled))
+	  EventChar_State.SavePending = false;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Sends the partially filled bank of the given IN endpoint to the host, after the data up to an event character
+ *  has been written into it.
+ *
+ *  \param[in] Address  Address of the IN endpoint to commit.
+ *
+ *  \return Boolean \c true if the bank was committed or was empty, \c false if the endpoint had no bank free.
+ */
+bool EventChar_CommitINBank(const uint8_t Address)
+{
+	Endpoint_SelectEndpoint(Address);
+
+	if (!(Endpoint_IsINReady()))
+	  return false;
+
+	if (Endpoint_BytesInEndpoint())
+	{
+		Endpoint_ClearIN();
+
+		/* Counted atomically, as the statistics may be cleared from the control request ISR */
+		uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+		GlobalInterruptDisable();
+
+		EventChar_Stats.Flushes++;
+
+		SetGlobalInterruptMask(CurrentGlobalInt);
+	}
+
+	return true;
+}
+
+/** Clears the event character statistics. */
+void EventChar_ResetStats(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	EventChar_Stats = (EventChar_Stats_t){ 0 };
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for EventChar.c.
+ */
+
+#ifndef _EVENT_CHAR_H_
+#define _EVENT_CHAR_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/eeprom.h>
+		#include <stdbool.h>
+
+		#include "../Config/AppConfig.h"
+
+		#include <LUFA/Drivers/USB/USB.h>
+
+	/* Macros: */
+		/** Mask of the \c wValue bit of \ref VENDOR_REQ_SetEventChar which enables the event character, the low byte
+		 *  of \c wValue holding the character itself.
+		 */
+		#define EVENT_CHAR_ENABLE_MASK         (1 << 8)
+
+	/* Type Defines: */
+		/** Type define for the event character settings, as kept in RAM and persisted in EEPROM. */
+		typedef struct
+		{
+			uint8_t Char; /**< Character which triggers an immediate flush when received from the USART. */
+			uint8_t Enabled; /**< Set to 1 when the event character is enabled; any other value, such as that of erased
+			                  *   EEPROM, disables it.
+			                  */
+		} EventChar_Settings_t;
+
+		/** Type define for the event character state. */
+		typedef struct
+		{
+			EventChar_Settings_t Settings; /**< Active settings, matched against each received byte. */
+			bool          SavePending; /**< Indicates if the settings have changed since they were last written to EEPROM. */
+			volatile bool FlushPending; /**< Set by the USART receive ISR when the event character is received, until the
+			                             *   buffered data up to it has been sent to the host.
+			                             */
+		} EventChar_State_t;
+
+		/** Type define for the event character statistics. */
+		typedef struct
+		{
+			uint32_t Matches; /**< Number of event characters received from the USART. */
+			uint32_t Flushes; /**< Number of flushes to the host triggered by event characters. */
+		} EventChar_Stats_t;
+
+	/* External Variables: */
+		extern EventChar_State_t EventChar_State;
+		extern EventChar_Stats_t EventChar_Stats;
+
+	/* Inline Functions: */
+		/** Checks a byte received from the USART against the event character, and requests an immediate flush of the
+		 *  buffered data if it matches. This must be called from the USART receive ISR, after the byte is buffered.
+		 *
+		 *  \param[in] ReceivedByte  Byte received from the USART.
+		 */
+		static inline void EventChar_ByteReceived(const uint8_t ReceivedByte) ATTR_ALWAYS_INLINE;
+		static inline void EventChar_ByteReceived(const uint8_t ReceivedByte)
+		{
+			if ((ReceivedByte != EventChar_State.Settings.Char) || (EventChar_State.Settings.Enabled != 1))
+			  return;
+
+			EventChar_State.FlushPending = true;
+			EventChar_Stats.Matches++;
+		}
+
+		/** Takes the pending flush request, if any. A request which cannot be completed at once should be put back
+		 *  with \ref EventChar_RequestFlush().
+		 *
+		 *  \return Boolean \c true if the buffered data should be sent to the host at once, \c false otherwise.
+		 */
+		static inline bool EventChar_TakeFlushRequest(void) ATTR_ALWAYS_INLINE;
+		static inline bool EventChar_TakeFlushRequest(void)
+		{
+			if (!(EventChar_State.FlushPending))
+			  return false;
+
+			EventChar_State.FlushPending = false;
+			return true;
+		}
+
+		/** Requests an immediate flush of the buffered data, for a request taken with \ref EventChar_TakeFlushRequest()
+		 *  which could not be completed.
+		 */
+		static inline void EventChar_RequestFlush(void) ATTR_ALWAYS_INLINE;
+		static inline void EventChar_RequestFlush(void)
+		{
+			EventChar_State.FlushPending = true;
+		}
+
+	/* Function Prototypes: */
+		void EventChar_Init(void);
+		void EventChar_Set(const uint16_t Value);
+		void EventChar_Task(void);
+		bool EventChar_CommitINBank(const uint8_t Address);
+		void EventChar_ResetStats(void);
+
+#endif
+
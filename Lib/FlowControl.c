@@ -0,0 +1,73 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Flow control between the serial bridge and the attached device. Depending on \ref FLOW_CONTROL, the
+ *  attached device is throttled through an RTS GPIO line or in-band XOFF/XON characters when the USART
+ *  receive buffer crosses its high and low watermarks, and transmission to it is paused while its CTS line
+ *  is deasserted or after it has sent XOFF. Drop and throttle counters are kept for both directions.
+ */
+
+#include "FlowControl.h"
+
+FlowControl_State_t FlowControl_State;
+FlowControl_Stats_t FlowControl_Stats;
+
+/** Initializes the flow control state and, in RTS/CTS mode, the handshake lines. RTS is asserted (driven low)
+ *  so that the attached device may transmit, and CTS is configured as an input with pull-up so that a
+ *  disconnected line pauses transmission.
+ */
+void FlowControl_Init(void)
+{
+	FlowControl_State = (FlowControl_State_t){ 0 };
+
+	#if (FLOW_CONTROL == FLOW_CONTROL_RtsCts)
+	FLOW_CONTROL_RTS_PORT &= ~FLOW_CONTROL_RTS_MASK;
+	FLOW_CONTROL_RTS_DDR  |=  FLOW_CONTROL_RTS_MASK;
+
+	FLOW_CONTROL_CTS_DDR  &= ~FLOW_CONTROL_CTS_MASK;
+	FLOW_CONTROL_CTS_PORT |=  FLOW_CONTROL_CTS_MASK;
+	#endif
+
+	FlowControl_ResetStats();
+}
+
+/** Clears the drop and throttle counters. */
+void FlowControl_ResetStats(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	FlowControl_Stats = (FlowControl_Stats_t){ 0 };
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
@@ -0,0 +1,167 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for FlowControl.c.
+ */
+
+#ifndef _FLOW_CONTROL_H_
+#define _FLOW_CONTROL_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include "../Config/AppConfig.h"
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Flow control mode value for \ref FLOW_CONTROL, disabling flow control with the attached device. */
+		#define FLOW_CONTROL_None              0
+
+		/** Flow control mode value for \ref FLOW_CONTROL, selecting hardware RTS/CTS handshaking on GPIO lines. */
+		#define FLOW_CONTROL_RtsCts            1
+
+		/** Flow control mode value for \ref FLOW_CONTROL, selecting in-band XON/XOFF software handshaking. */
+		#define FLOW_CONTROL_XonXoff           2
+
+		/** Character sent or received to resume transmission in XON/XOFF flow control mode (DC1). */
+		#define FLOW_CONTROL_XON_CHAR          0x11
+
+		/** Character sent or received to pause transmission in XON/XOFF flow control mode (DC3). */
+		#define FLOW_CONTROL_XOFF_CHAR         0x13
+
+	/* Preprocessor Checks: */
+		#if (FLOW_CONTROL != FLOW_CONTROL_None) && (FLOW_CONTROL != FLOW_CONTROL_RtsCts) && (FLOW_CONTROL != FLOW_CONTROL_XonXoff)
+			#error FLOW_CONTROL must be one of FLOW_CONTROL_None, FLOW_CONTROL_RtsCts or FLOW_CONTROL_XonXoff.
+		#endif
+
+		#if (FLOW_CONTROL_LOW_WATERMARK >= FLOW_CONTROL_HIGH_WATERMARK)
+			#error FLOW_CONTROL_LOW_WATERMARK must be lower than FLOW_CONTROL_HIGH_WATERMARK.
+		#endif
+
+	/* Type Defines: */
+		/** Type define for the per-direction drop and throttle counters of the serial bridge. */
+		typedef struct
+		{
+			uint32_t UsartToUsbDropped; /**< Bytes received from the USART and discarded because the buffer was full. */
+			uint16_t UsartToUsbThrottled; /**< Number of times the attached device was asked to pause transmission. */
+			uint16_t UsbToUsartThrottled; /**< Number of times the attached device paused transmission to it. */
+		} FlowControl_Stats_t;
+
+		/** Type define for the flow control state of the serial bridge. */
+		typedef struct
+		{
+			bool             ReceiveThrottled; /**< Indicates if the attached device has been asked to pause transmission. */
+			volatile bool    TransmitPaused; /**< Indicates if the attached device has paused transmission to it with XOFF. */
+			volatile uint8_t PendingChar; /**< XON or XOFF character waiting to be sent ahead of queued data, or zero. */
+		} FlowControl_State_t;
+
+	/* External Variables: */
+		extern FlowControl_State_t FlowControl_State;
+		extern FlowControl_Stats_t FlowControl_Stats;
+
+	/* Inline Functions: */
+		/** Determines if the attached device currently refuses data, either because its CTS line is deasserted or
+		 *  because it has sent XOFF.
+		 *
+		 *  \return Boolean \c true if transmission through the USART must pause, \c false otherwise.
+		 */
+		static inline bool FlowControl_IsTransmitPaused(void) ATTR_ALWAYS_INLINE;
+		static inline bool FlowControl_IsTransmitPaused(void)
+		{
+			#if (FLOW_CONTROL == FLOW_CONTROL_RtsCts)
+			return (FLOW_CONTROL_CTS_PIN & FLOW_CONTROL_CTS_MASK);
+			#elif (FLOW_CONTROL == FLOW_CONTROL_XonXoff)
+			return FlowControl_State.TransmitPaused;
+			#else
+			return false;
+			#endif
+		}
+
+		/** Asks the attached device to pause transmission once the receive buffer level reaches the high watermark,
+		 *  by deasserting RTS or by queueing XOFF. When XOFF is queued, the caller must enable the USART data register
+		 *  empty interrupt so that it is sent.
+		 *
+		 *  \param[in] BufferCount  Number of bytes currently held in the receive buffer.
+		 *
+		 *  \return Boolean \c true if a flow control character was queued for transmission, \c false otherwise.
+		 */
+		static inline bool FlowControl_CheckHighWatermark(const uint16_t BufferCount) ATTR_ALWAYS_INLINE;
+		static inline bool FlowControl_CheckHighWatermark(const uint16_t BufferCount)
+		{
+			if (FlowControl_State.ReceiveThrottled || (BufferCount < FLOW_CONTROL_HIGH_WATERMARK))
+			  return false;
+
+			FlowControl_State.ReceiveThrottled = true;
+			FlowControl_Stats.UsartToUsbThrottled++;
+
+			#if (FLOW_CONTROL == FLOW_CONTROL_RtsCts)
+			FLOW_CONTROL_RTS_PORT |= FLOW_CONTROL_RTS_MASK;
+			return false;
+			#else
+			FlowControl_State.PendingChar = FLOW_CONTROL_XOFF_CHAR;
+			return true;
+			#endif
+		}
+
+		/** Allows the attached device to resume transmission once the receive buffer level has dropped to the low
+		 *  watermark, by asserting RTS or by queueing XON. When XON is queued, the caller must enable the USART data
+		 *  register empty interrupt so that it is sent.
+		 *
+		 *  \param[in] BufferCount  Number of bytes currently held in the receive buffer.
+		 *
+		 *  \return Boolean \c true if a flow control character was queued for transmission, \c false otherwise.
+		 */
+		static inline bool FlowControl_CheckLowWatermark(const uint16_t BufferCount) ATTR_ALWAYS_INLINE;
+		static inline bool FlowControl_CheckLowWatermark(const uint16_t BufferCount)
+		{
+			if (!(FlowControl_State.ReceiveThrottled) || (BufferCount > FLOW_CONTROL_LOW_WATERMARK))
+			  return false;
+
+			FlowControl_State.ReceiveThrottled = false;
+
+			#if (FLOW_CONTROL == FLOW_CONTROL_RtsCts)
+			FLOW_CONTROL_RTS_PORT &= ~FLOW_CONTROL_RTS_MASK;
+			return false;
+			#else
+			FlowControl_State.PendingChar = FLOW_CONTROL_XON_CHAR;
+			return true;
+			#endif
+		}
+
+	/* Function Prototypes: */
+		void FlowControl_Init(void);
+		void FlowControl_ResetStats(void);
+
+#endif
+
@@ -0,0 +1,140 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Start of Frame synchronized IN flush scheduler. Rather than sending a partially filled IN bank as soon as
+ *  it is noticed, the bank is kept open to collect more data and is committed \ref SOF_FLUSH_LEAD_US
+ *  microseconds before the next 1ms USB frame boundary, timed from each Start of Frame event with the Timer 1
+ *  compare match B unit. Data then reaches the host in the earliest frame that could carry it, without
+ *  sending half-empty packets early in the frame.
+ */
+
+#include "FrameScheduler.h"
+
+#if defined(SOF_FLUSH_SCHEDULER)
+
+FrameScheduler_Stats_t FrameScheduler_Stats;
+
+/** Indicates if the commit point of the current frame has passed without the IN bank being committed. */
+static volatile bool CommitDue;
+
+/** Schedules the IN bank commit point for the frame that has just started. This must be called from the
+ *  \ref EVENT_USB_Device_StartOfFrame() event.
+ */
+void FrameScheduler_StartOfFrame(void)
+{
+	OCR1B   = (Timestamp_NowFromISR() + TIMESTAMP_US_TO_TICKS(1000 - SOF_FLUSH_LEAD_US));
+	TIFR1   = (1 << OCF1B);
+	TIMSK1 |= (1 << OCIE1B);
+
+	FrameScheduler_Stats.Frames++;
+}
+
+/** Determines if the commit point of the current frame has passed.
+ *
+ *  \return Boolean \c true if the partially filled IN bank should be committed, \c false otherwise.
+ */
+bool FrameScheduler_IsCommitDue(void)
+{
+	return CommitDue;
+}
+
+/** Commits the partially filled bank of the given IN endpoint to the host, recording the fill level into
+ *  the scheduler statistics. This should be called from the main program thread once
+ *  \ref FrameScheduler_IsCommitDue() indicates the commit point has passed.
+ *
+ *  \param[in] Address  Address of the IN endpoint to commit.
+ */
+void FrameScheduler_CommitINBank(const uint8_t Address)
+{
+	CommitDue = false;
+
+	Endpoint_SelectEndpoint(Address);
+
+	uint16_t BytesInBank = 0;
+	bool     BankFree    = Endpoint_IsINReady();
+
+	if (BankFree)
+	{
+		BytesInBank = Endpoint_BytesInEndpoint();
+
+		if (BytesInBank)
+		  Endpoint_ClearIN();
+	}
+
+	/* Counted atomically, as the statistics may be cleared from the control request ISR */
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	if (!(BankFree))
+	{
+		FrameScheduler_Stats.BusyFrames++;
+	}
+	else if (!(BytesInBank))
+	{
+		FrameScheduler_Stats.IdleFrames++;
+	}
+	else
+	{
+		uint8_t Bucket = (BytesInBank / 8);
+		if (Bucket >= FRAME_SCHEDULER_FILL_BUCKETS)
+		  Bucket = (FRAME_SCHEDULER_FILL_BUCKETS - 1);
+
+		FrameScheduler_Stats.Commits++;
+
+		if (FrameScheduler_Stats.FillHistogram[Bucket] != UINT16_MAX)
+		  FrameScheduler_Stats.FillHistogram[Bucket]++;
+	}
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Clears the scheduler statistics. */
+void FrameScheduler_ResetStats(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	FrameScheduler_Stats = (FrameScheduler_Stats_t){ 0 };
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** ISR to flag the commit point of the current frame, shortly before the next frame boundary. */
+ISR(TIMER1_COMPB_vect, ISR_BLOCK)
+{
+	TIMSK1 &= ~(1 << OCIE1B);
+
+	CommitDue = true;
+}
+
+#endif
+
@@ -0,0 +1,89 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for FrameScheduler.c.
+ */
+
+#ifndef _FRAME_SCHEDULER_H_
+#define _FRAME_SCHEDULER_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/interrupt.h>
+		#include <stdbool.h>
+
+		#include "../Config/AppConfig.h"
+		#include "Timestamp.h"
+
+		#include <LUFA/Drivers/USB/USB.h>
+
+	/* Preprocessor Checks: */
+		#if defined(SOF_FLUSH_SCHEDULER)
+			#if defined(NO_SOF_EVENTS)
+				#error SOF_FLUSH_SCHEDULER requires Start of Frame events, which are disabled by the NO_SOF_EVENTS token.
+			#endif
+
+			#if (SOF_FLUSH_LEAD_US >= 1000)
+				#error SOF_FLUSH_LEAD_US must be shorter than the 1ms USB frame period.
+			#endif
+		#endif
+
+	/* Macros: */
+		/** Number of buckets in the per-frame fill histogram. Bucket \c n counts the partially filled IN banks that
+		 *  were committed holding between 8n and 8n + 7 bytes.
+		 */
+		#define FRAME_SCHEDULER_FILL_BUCKETS   8
+
+	/* Type Defines: */
+		/** Type define for the statistics of the Start of Frame synchronized IN flush scheduler. */
+		typedef struct
+		{
+			uint32_t Frames; /**< Number of Start of Frame events seen. */
+			uint32_t Commits; /**< Number of frames in which a partially filled IN bank was committed. */
+			uint32_t IdleFrames; /**< Number of frames with no data staged at the commit point. */
+			uint32_t BusyFrames; /**< Number of frames in which the commit point passed while the IN endpoint had
+			                      *   no bank free, leaving any staged data for the next frame.
+			                      */
+			uint16_t FillHistogram[FRAME_SCHEDULER_FILL_BUCKETS]; /**< Histogram of the bytes in each committed partial bank. */
+		} FrameScheduler_Stats_t;
+
+	/* External Variables: */
+		extern FrameScheduler_Stats_t FrameScheduler_Stats;
+
+	/* Function Prototypes: */
+		void FrameScheduler_StartOfFrame(void);
+		bool FrameScheduler_IsCommitDue(void);
+		void FrameScheduler_CommitINBank(const uint8_t Address);
+		void FrameScheduler_ResetStats(void);
+
+#endif
+
@@ -0,0 +1,167 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Latency tracing of the USART to USB direction. The USART receive ISR stamps the arrival time of every
+ *  2^\ref LATENCY_TRACE_SAMPLE_SHIFT th byte into a slot indexed by its sequence number, extended past the
+ *  period of Timer 1 by a count of its overflows. The main loop records the buffer fill level each time bytes
+ *  are staged into the IN endpoint, and computes each sampled byte's latency once the bank holding it has been
+ *  committed to the host. The latency and buffer fill level histograms are kept in RAM, to be read by the host
+ *  through a vendor control request.
+ */
+
+#include "LatencyTrace.h"
+
+#if defined(LATENCY_TRACE)
+
+LatencyTrace_State_t LatencyTrace_State;
+LatencyTrace_Stats_t LatencyTrace_Stats;
+
+/** Increments a histogram bucket, saturating rather than wrapping around. The increment is made atomic, as the
+ *  histograms may be cleared from the control request ISR.
+ *
+ *  \param[in,out] Bucket  Histogram bucket to increment.
+ */
+static void LatencyTrace_CountBucket(uint16_t* const Bucket)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	if (*Bucket != UINT16_MAX)
+	  (*Bucket)++;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Initializes the latency tracing, enabling the Timer 1 overflow interrupt which extends the timestamps. This
+ *  must be called after \ref Timestamp_Init().
+ */
+void LatencyTrace_Init(void)
+{
+	TIFR1   = (1 << TOV1);
+	TIMSK1 |= (1 << TOIE1);
+}
+
+/** Records the buffer fill level each time bytes are staged from the USART receive buffer into the IN endpoint.
+ *  This must be called from the main program thread each time bytes are removed from the buffer, and their
+ *  latency is then recorded by \ref LatencyTrace_BytesCommitted() once the bank holding them has been committed.
+ *
+ *  \param[in] Count        Number of bytes removed from the buffer.
+ *  \param[in] BufferCount  Number of bytes held in the buffer before the removal.
+ */
+void LatencyTrace_BytesStaged(const uint16_t Count,
+                              const uint16_t BufferCount)
+{
+	LatencyTrace_State.StageSequence += Count;
+
+	uint8_t FillBucket = (((uint32_t)BufferCount * LATENCY_TRACE_FILL_BUCKETS) / (USART_TO_USB_BUFFER_SIZE + 1));
+	LatencyTrace_CountBucket(&LatencyTrace_Stats.FillHistogram[FillBucket]);
+}
+
+/** Records the latency of the sampled bytes committed to the host since the last call. This must be called from
+ *  the main program thread after each point at which the IN endpoint bank may have been committed; bytes staged
+ *  into a bank which was discarded by a bus reset are counted as committed by the next call.
+ *
+ *  \param[in] PendingCount  Number of staged bytes still held in an uncommitted IN endpoint bank.
+ */
+void LatencyTrace_BytesCommitted(const uint16_t PendingCount)
+{
+	uint16_t Sequence = LatencyTrace_State.CommitSequence;
+	uint16_t Count    = (LatencyTrace_State.StageSequence - PendingCount - Sequence);
+
+	if (!(Count))
+	  return;
+
+	LatencyTrace_State.CommitSequence = (Sequence + Count);
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint16_t Now       = Timestamp_NowFromISR();
+	uint8_t  Overflows = LatencyTrace_State.Overflows;
+	if ((TIFR1 & (1 << TOV1)) && !(Now & 0x8000))
+	  Overflows++;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	/* Find the number of sampled sequence numbers in the committed range, starting from the first one */
+	uint16_t SampleOffset = (-Sequence & LATENCY_TRACE_SAMPLE_MASK);
+
+	if (SampleOffset >= Count)
+	  return;
+
+	uint16_t TotalSamples = (((Count - SampleOffset - 1) >> LATENCY_TRACE_SAMPLE_SHIFT) + 1);
+
+	Sequence += SampleOffset;
+
+	while (TotalSamples--)
+	{
+		uint16_t Slot    = ((Sequence >> LATENCY_TRACE_SAMPLE_SHIFT) & (LATENCY_TRACE_SLOTS - 1));
+		uint16_t Arrival = LatencyTrace_State.ArrivalTime[Slot];
+		uint8_t  Periods = (Overflows - LatencyTrace_State.ArrivalOverflows[Slot]);
+		uint16_t Latency = (Now - Arrival);
+		uint8_t  Bucket  = 0;
+
+		/* Latencies of a full timer period or more saturate into the last bucket */
+		if ((Periods > 1) || ((Periods == 1) && (Now >= Arrival)))
+		{
+			Bucket = (LATENCY_TRACE_LATENCY_BUCKETS - 1);
+		}
+		else
+		{
+			while ((Latency >>= 1) && (Bucket < (LATENCY_TRACE_LATENCY_BUCKETS - 1)))
+			  Bucket++;
+		}
+
+		LatencyTrace_CountBucket(&LatencyTrace_Stats.LatencyHistogram[Bucket]);
+
+		Sequence += (1 << LATENCY_TRACE_SAMPLE_SHIFT);
+	}
+}
+
+/** Clears the latency and fill level histograms. */
+void LatencyTrace_ResetStats(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	LatencyTrace_Stats = (LatencyTrace_Stats_t){ 0 };
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** ISR to extend the timestamps of the sampled bytes, by counting the overflows of Timer 1. */
+ISR(TIMER1_OVF_vect, ISR_BLOCK)
+{
+	LatencyTrace_State.Overflows++;
+}
+
+#endif
@@ -0,0 +1,132 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for LatencyTrace.c.
+ */
+
+#ifndef _LATENCY_TRACE_H_
+#define _LATENCY_TRACE_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+		#include "../Config/AppConfig.h"
+		#include "Timestamp.h"
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of arrival timestamp slots, one for every sampled byte the USART receive buffer can hold, doubled to
+		 *  also cover the bytes staged into the IN endpoint bank which have not yet been committed to the host.
+		 */
+		#define LATENCY_TRACE_SLOTS            ((2 * USART_TO_USB_BUFFER_SIZE) >> LATENCY_TRACE_SAMPLE_SHIFT)
+
+		/** Mask of the byte sequence number bits which must be zero for a byte to be sampled. */
+		#define LATENCY_TRACE_SAMPLE_MASK      ((1 << LATENCY_TRACE_SAMPLE_SHIFT) - 1)
+
+		/** Number of buckets in the latency histogram. Bucket \c n counts the sampled bytes whose latency was between
+		 *  2^n and 2^(n+1) - 1 timestamp ticks, with bucket 0 also counting zero and the last bucket also counting all
+		 *  longer latencies, including those beyond the period of the timestamp counter.
+		 */
+		#define LATENCY_TRACE_LATENCY_BUCKETS  16
+
+		/** Number of buckets in the fill level histogram, each covering an equal share of the USART receive buffer. */
+		#define LATENCY_TRACE_FILL_BUCKETS     16
+
+	/* Preprocessor Checks: */
+		#if defined(LATENCY_TRACE) && (LATENCY_TRACE_SLOTS & (LATENCY_TRACE_SLOTS - 1))
+			#error USART_TO_USB_BUFFER_SIZE >> LATENCY_TRACE_SAMPLE_SHIFT must be a power of two.
+		#endif
+
+	/* Type Defines: */
+		/** Type define for the latency and fill level histograms of the USART to USB direction. */
+		typedef struct
+		{
+			uint16_t LatencyHistogram[LATENCY_TRACE_LATENCY_BUCKETS]; /**< Histogram of the time from sampled bytes arriving
+			                                                           *   from the USART to the IN endpoint bank holding
+			                                                           *   them being committed to the host.
+			                                                           */
+			uint16_t FillHistogram[LATENCY_TRACE_FILL_BUCKETS]; /**< Histogram of the USART receive buffer level each time
+			                                                     *   data is staged into the IN endpoint bank.
+			                                                     */
+		} LatencyTrace_Stats_t;
+
+		/** Type define for the arrival timestamps of the sampled bytes held in the USART receive buffer. */
+		typedef struct
+		{
+			uint16_t InsertSequence; /**< Sequence number of the next byte inserted into the buffer. */
+			uint16_t StageSequence; /**< Sequence number of the next byte removed from the buffer into the IN endpoint. */
+			uint16_t CommitSequence; /**< Sequence number of the next byte to be committed to the host. */
+			volatile uint8_t Overflows; /**< Number of timestamp counter overflows, extending the timestamps. */
+			uint16_t ArrivalTime[LATENCY_TRACE_SLOTS]; /**< Arrival timestamps of the sampled bytes. */
+			uint8_t  ArrivalOverflows[LATENCY_TRACE_SLOTS]; /**< Counter overflows at the arrival of the sampled bytes, modulo
+			                                                 *   256, some 8 s at the default Timer 1 prescaler.
+			                                                 */
+		} LatencyTrace_State_t;
+
+	/* External Variables: */
+		extern LatencyTrace_State_t LatencyTrace_State;
+		extern LatencyTrace_Stats_t LatencyTrace_Stats;
+
+	/* Inline Functions: */
+		/** Stamps the arrival of a byte inserted into the USART receive buffer, if it is one of the sampled bytes.
+		 *  This must be called from the USART receive ISR, once for each byte inserted.
+		 */
+		static inline void LatencyTrace_ByteReceived(void) ATTR_ALWAYS_INLINE;
+		static inline void LatencyTrace_ByteReceived(void)
+		{
+			uint16_t Sequence = LatencyTrace_State.InsertSequence++;
+
+			if (!(Sequence & LATENCY_TRACE_SAMPLE_MASK))
+			{
+				uint16_t Slot = ((Sequence >> LATENCY_TRACE_SAMPLE_SHIFT) & (LATENCY_TRACE_SLOTS - 1));
+				uint16_t Now  = Timestamp_NowFromISR();
+
+				/* An overflow whose ISR has not run yet belongs to the timestamp if the counter has since restarted */
+				uint8_t Overflows = LatencyTrace_State.Overflows;
+				if ((TIFR1 & (1 << TOV1)) && !(Now & 0x8000))
+				  Overflows++;
+
+				LatencyTrace_State.ArrivalTime[Slot]      = Now;
+				LatencyTrace_State.ArrivalOverflows[Slot] = Overflows;
+			}
+		}
+
+	/* Function Prototypes: */
+		void LatencyTrace_Init(void);
+		void LatencyTrace_BytesStaged(const uint16_t Count,
+		                              const uint16_t BufferCount);
+		void LatencyTrace_BytesCommitted(const uint16_t PendingCount);
+		void LatencyTrace_ResetStats(void);
+
+#endif
+
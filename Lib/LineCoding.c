@@ -0,0 +1,372 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Reconfiguration of the USART when the host changes the line encoding. The new register values are computed
+ *  up front, the data already queued for the attached device is sent at the old line encoding, and the registers
+ *  are then rewritten in a single block so that no partially configured state is ever seen on the line. The
+ *  duration of each change is measured against the shared timestamp counter.
+ */
+
+#include "LineCoding.h"
+
+LineCoding_State_t LineCoding_State;
+LineCoding_Stats_t LineCoding_Stats;
+
+/** Time allowed for one character to leave the transmitter at the current line encoding. */
+static uint32_t LineCoding_DrainTicks;
+
+/** Timestamp at which the duration of the current change was last updated. */
+static uint16_t LineCoding_SwitchLastTime;
+
+/** Duration of the current change so far, wider than the timestamp counter as the queued data may take longer to
+ *  send than the counter's period.
+ */
+static uint32_t LineCoding_SwitchTicks;
+
+/** Whether the data queued for the attached device could not all be sent within its bound during the current change. */
+static bool LineCoding_DrainTimedOut;
+
+/** Line encoding currently applied to the USART, restored when a new line encoding is rejected. */
+static CDC_LineEncoding_t LineCoding_Applied;
+
+/** Finds the baud rate register value giving the closest rate to the one requested, for one USART speed mode.
+ *
+ *  \param[in]  BaudRateBPS  Requested baud rate, within the USART's range.
+ *  \param[in]  Divisor      Clock divisor of the speed mode, 16 for normal speed and 8 for double speed.
+ *  \param[out] UBRR         Baud rate register value giving the closest rate.
+ *
+ *  \return Error of the generated rate relative to the one requested, in hundredths of a percent.
+ */
+static uint16_t LineCoding_SolveMode(const uint32_t BaudRateBPS,
+                                     const uint8_t Divisor,
+                                     uint16_t* const UBRR)
+{
+	uint32_t Scale        = ((uint32_t)Divisor * BaudRateBPS);
+	uint32_t ClockDivider = (F_CPU / Scale);
+	uint32_t LowestError  = UINT32_MAX;
+
+	/* The generated rate is inversely proportional to the clock divider, so the divider nearest to the exact one
+	 * does not always give the nearest rate; both dividers either side of it are tried
+	 */
+	for (uint32_t Candidate = ClockDivider; Candidate <= (ClockDivider + 1); Candidate++)
+	{
+		uint32_t Clamped = !(Candidate) ? 1 : (Candidate > 4096) ? 4096 : Candidate;
+
+		/* Compare the clock the requested rate needs against F_CPU, scaled so that the division cannot overflow */
+		uint32_t RequiredClock = (Scale * Clamped);
+		uint32_t Difference    = (RequiredClock > F_CPU) ? (RequiredClock - F_CPU) : (F_CPU - RequiredClock);
+		uint32_t Error         = (Difference / (RequiredClock / 10000));
+
+		if (Error < LowestError)
+		{
+			LowestError = Error;
+			*UBRR       = (Clamped - 1);
+		}
+	}
+
+	return (LowestError > UINT16_MAX) ? UINT16_MAX : LowestError;
+}
+
+/** Updates the duration of the current change from the timestamp counter. This must be called more often than the
+ *  counter wraps while a change is in progress.
+ *
+ *  \return Duration of the current change so far, in timestamp ticks.
+ */
+static uint32_t LineCoding_SwitchElapsed(void)
+{
+	uint16_t Now = Timestamp_Now();
+
+	LineCoding_SwitchTicks   += (uint16_t)(Now - LineCoding_SwitchLastTime);
+	LineCoding_SwitchLastTime = Now;
+
+	return LineCoding_SwitchTicks;
+}
+
+/** Reads the number of characters written to the USART data register, atomically with respect to its ISR.
+ *
+ *  \return Value of \ref LineCoding_State_t::CharsQueued.
+ */
+static uint16_t LineCoding_GetCharsQueued(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint16_t CharsQueued = LineCoding_State.CharsQueued;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+	return CharsQueued;
+}
+
+/** Increments a statistics counter, atomically as the statistics may be cleared from the control request ISR.
+ *
+ *  \param[in,out] Counter  Statistics counter to increment.
+ */
+static void LineCoding_CountEvent(uint16_t* const Counter)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	(*Counter)++;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Initializes the line encoding module, with the USART disabled until the host sets a line encoding. */
+void LineCoding_Init(void)
+{
+	LineCoding_DrainTicks = 0;
+	LineCoding_Applied    = (CDC_LineEncoding_t){ 0 };
+	LineCoding_State      = (LineCoding_State_t){ 0 };
+
+	LineCoding_ResetStats();
+}
+
+/** Computes the USART register values for the given line encoding, without touching the USART itself. Both the
+ *  normal and double speed modes are solved for the requested baud rate, and the mode with the lower error is
+ *  chosen, preferring normal speed mode on a tie for its better receiver noise tolerance. Baud rates outside the
+ *  USART's range are clamped to the nearest limit, and the line encoding's baud rate is updated to the rate the
+ *  USART will actually generate, so that the host reads it back through GET LINE ENCODING.
+ *
+ *  \param[in,out] LineEncoding  Line encoding set by the host, updated with the generated baud rate.
+ *  \param[out]    Registers     USART register values implementing the line encoding.
+ *
+ *  \return Boolean \c true if the line encoding can be applied, \c false if the baud rate error would exceed
+ *          \ref LINE_CODING_MAX_ERROR_PERMILLE and the line encoding must be rejected.
+ */
+bool LineCoding_Compute(CDC_LineEncoding_t* const LineEncoding,
+                        LineCoding_Registers_t* const Registers)
+{
+	uint32_t BaudRateBPS = LineEncoding->BaudRateBPS;
+
+	if ((BaudRateBPS < LINE_CODING_MIN_BAUD) || (BaudRateBPS > LINE_CODING_MAX_BAUD))
+	{
+		BaudRateBPS = (BaudRateBPS < LINE_CODING_MIN_BAUD) ? LINE_CODING_MIN_BAUD : LINE_CODING_MAX_BAUD;
+		LineCoding_CountEvent(&LineCoding_Stats.Clamped);
+	}
+
+	uint16_t NormalUBRR;
+	uint16_t DoubleUBRR;
+	uint16_t NormalError = LineCoding_SolveMode(BaudRateBPS, 16, &NormalUBRR);
+	uint16_t DoubleError = LineCoding_SolveMode(BaudRateBPS, 8, &DoubleUBRR);
+
+	uint8_t  Divisor;
+	uint16_t Error;
+
+	if (DoubleError < NormalError)
+	{
+		Divisor          = 8;
+		Error            = DoubleError;
+		Registers->UBRR  = DoubleUBRR;
+		Registers->UCSRA = (1 << U2X1);
+	}
+	else
+	{
+		Divisor          = 16;
+		Error            = NormalError;
+		Registers->UBRR  = NormalUBRR;
+		Registers->UCSRA = 0;
+	}
+
+	if (Error > (LINE_CODING_MAX_ERROR_PERMILLE * 10))
+	{
+		LineCoding_CountEvent(&LineCoding_Stats.Rejected);
+		return false;
+	}
+
+	uint32_t ClockDivider = ((uint32_t)Divisor * (Registers->UBRR + 1));
+	Registers->BaudRateBPS = ((F_CPU + (ClockDivider / 2)) / ClockDivider);
+	LineEncoding->BaudRateBPS = Registers->BaudRateBPS;
+
+	uint8_t ConfigMask = 0;
+
+	switch (LineEncoding->ParityType)
+	{
+		case CDC_PARITY_Odd:
+			ConfigMask = ((1 << UPM11) | (1 << UPM10));
+			break;
+		case CDC_PARITY_Even:
+			ConfigMask = (1 << UPM11);
+			break;
+	}
+
+	if (LineEncoding->CharFormat == CDC_LINEENCODING_TwoStopBits)
+	  ConfigMask |= (1 << USBS1);
+
+	switch (LineEncoding->DataBits)
+	{
+		case 6:
+			ConfigMask |= (1 << UCSZ10);
+			break;
+		case 7:
+			ConfigMask |= (1 << UCSZ11);
+			break;
+		case 8:
+			ConfigMask |= ((1 << UCSZ11) | (1 << UCSZ10));
+			break;
+	}
+
+	Registers->UCSRC = ConfigMask;
+
+	/* Allow for the longest frame the USART can send, 1 start, 9 data and 2 stop bits */
+	Registers->DrainTicks = (((12 * TIMESTAMP_TICKS_PER_SECOND) / Registers->BaudRateBPS) + 1);
+
+	LineCoding_Applied = *LineEncoding;
+	return true;
+}
+
+/** Restores the line encoding currently applied to the USART, after a new line encoding has been rejected by
+ *  \ref LineCoding_Compute(), so that the host reads back the settings still in effect.
+ *
+ *  \param[out] LineEncoding  Line encoding to restore.
+ */
+void LineCoding_Revert(CDC_LineEncoding_t* const LineEncoding)
+{
+	*LineEncoding = LineCoding_Applied;
+}
+
+/** Starts measuring the duration of a line encoding change, recorded by \ref LineCoding_RecordSwitch(). */
+void LineCoding_BeginSwitch(void)
+{
+	LineCoding_SwitchLastTime = Timestamp_Now();
+	LineCoding_SwitchTicks    = 0;
+	LineCoding_DrainTimedOut  = false;
+}
+
+/** Waits for the USART data register empty ISR to send the given number of characters, which were queued for the
+ *  attached device before the change, at the current line encoding. Characters queued after this is called are not
+ *  waited for, so that data the host sends after the change goes out at the new line encoding. The wait is bounded
+ *  by one character time per character, and ends at once while the attached device has paused transmission through
+ *  flow control; the remainder is then left to be sent at the new line encoding.
+ *
+ *  The USART data register empty interrupt must be enabled by the caller if any data is queued, and this must be
+ *  called with interrupts enabled during a change started by \ref LineCoding_BeginSwitch().
+ *
+ *  \param[in] Count  Number of characters queued for the attached device.
+ */
+void LineCoding_DrainQueued(const uint16_t Count)
+{
+	if (!(Count) || !(UCSR1B & (1 << TXEN1)))
+	  return;
+
+	uint16_t StartCount = LineCoding_GetCharsQueued();
+	uint32_t Deadline   = (LineCoding_SwitchElapsed() + ((uint32_t)Count * LineCoding_DrainTicks));
+
+	while ((uint16_t)(LineCoding_GetCharsQueued() - StartCount) < Count)
+	{
+		/* Characters held back by the attached device are only sent once it resumes, which may take far longer */
+		if (FlowControl_IsTransmitPaused() || (LineCoding_SwitchElapsed() >= Deadline))
+		{
+			LineCoding_DrainTimedOut = true;
+			return;
+		}
+	}
+}
+
+/** Waits for the character in the USART transmit buffer and the one in its shift register to be sent at the
+ *  current line encoding. Each wait is bounded by one character time. Nothing is waited for if no character has
+ *  been written since the line encoding was applied, as the transmit complete flag is then never raised.
+ *
+ *  The USART data register empty interrupt must be disabled by the caller, so that no new character is queued,
+ *  and this must be called during a change started by \ref LineCoding_BeginSwitch().
+ */
+void LineCoding_WaitTransmitIdle(void)
+{
+	if (!(UCSR1B & (1 << TXEN1)) || !(LineCoding_State.Transmitted))
+	  return;
+
+	uint32_t Deadline = (LineCoding_SwitchElapsed() + LineCoding_DrainTicks);
+
+	while (!(UCSR1A & (1 << UDRE1)) && (LineCoding_SwitchElapsed() < Deadline));
+
+	Deadline = (LineCoding_SwitchElapsed() + LineCoding_DrainTicks);
+
+	while (!(UCSR1A & (1 << TXC1)) && (LineCoding_SwitchElapsed() < Deadline));
+}
+
+/** Writes the given register values to the USART, resetting it in the process. The TX line is held high (idle)
+ *  while the USART is reconfigured. This must be called with interrupts disabled, so that the USART interrupts
+ *  never observe a partially configured USART.
+ *
+ *  \param[in] Registers  USART register values to apply, from \ref LineCoding_Compute().
+ */
+void LineCoding_Apply(const LineCoding_Registers_t* const Registers)
+{
+	PORTD |= (1 << 3);
+
+	/* Must turn off USART before reconfiguring it, otherwise incorrect operation may occur */
+	UCSR1B = 0;
+	UCSR1A = 0;
+	UCSR1C = 0;
+
+	UBRR1  = Registers->UBRR;
+	UCSR1C = Registers->UCSRC;
+	UCSR1A = Registers->UCSRA;
+	UCSR1B = ((1 << RXCIE1) | (1 << TXEN1) | (1 << RXEN1));
+
+	PORTD &= ~(1 << 3);
+
+	LineCoding_DrainTicks        = Registers->DrainTicks;
+	LineCoding_State.Transmitted = false;
+}
+
+/** Records the duration of a line encoding change started by \ref LineCoding_BeginSwitch() in the statistics, once
+ *  it has completed.
+ */
+void LineCoding_RecordSwitch(void)
+{
+	uint32_t SwitchTicks = LineCoding_SwitchElapsed();
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	LineCoding_Stats.Changes++;
+	LineCoding_Stats.LastSwitchTicks = SwitchTicks;
+
+	if (LineCoding_DrainTimedOut)
+	  LineCoding_Stats.DrainTimeouts++;
+
+	if (SwitchTicks > LineCoding_Stats.MaxSwitchTicks)
+	  LineCoding_Stats.MaxSwitchTicks = SwitchTicks;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Clears the line encoding change statistics. */
+void LineCoding_ResetStats(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	LineCoding_Stats = (LineCoding_Stats_t){ 0 };
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
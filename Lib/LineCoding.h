@@ -0,0 +1,134 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for LineCoding.c.
+ */
+
+#ifndef _LINE_CODING_H_
+#define _LINE_CODING_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include "../Config/AppConfig.h"
+		#include "FlowControl.h"
+		#include "Timestamp.h"
+
+		#include <LUFA/Drivers/USB/USB.h>
+
+	/* Macros: */
+		/** Lowest baud rate the USART can generate, with the largest baud rate register value in normal speed mode. */
+		#define LINE_CODING_MIN_BAUD           ((F_CPU / (16 * 4096UL)) + 1)
+
+		/** Highest baud rate the USART can generate, with a zero baud rate register value in double speed mode. */
+		#define LINE_CODING_MAX_BAUD           (F_CPU / 8)
+
+	/* Preprocessor Checks: */
+		#if ((LINE_CODING_MAX_ERROR_PERMILLE < 1) || (LINE_CODING_MAX_ERROR_PERMILLE > 100))
+			#error LINE_CODING_MAX_ERROR_PERMILLE must be between 1 and 100.
+		#endif
+
+	/* Type Defines: */
+		/** Type define for the USART register values implementing a line encoding set by the host. */
+		typedef struct
+		{
+			uint32_t BaudRateBPS; /**< Baud rate actually generated by the USART, rounded to the nearest integer. */
+			uint16_t UBRR; /**< Baud rate register value. */
+			uint8_t  UCSRA; /**< Control and status register A value, selecting the speed mode. */
+			uint8_t  UCSRC; /**< Control and status register C value, selecting the frame format. */
+			uint32_t DrainTicks; /**< Time allowed for one character to be shifted out at this line encoding. */
+		} LineCoding_Registers_t;
+
+		/** Type define for the state of the USART transmitter, as tracked by the line encoding module. */
+		typedef struct
+		{
+			volatile uint16_t CharsQueued; /**< Number of characters written to the USART data register, wrapping. */
+			volatile bool     Transmitted; /**< Whether any character has been written to the USART data register since
+			                                *   the line encoding was last applied, so that its transmit complete flag
+			                                *   is meaningful.
+			                                */
+		} LineCoding_State_t;
+
+		/** Type define for the line encoding change statistics of the serial bridge. */
+		typedef struct
+		{
+			uint16_t Changes; /**< Number of line encoding changes applied to the USART. */
+			uint32_t LastSwitchTicks; /**< Duration of the most recent change, from the request being processed until the
+			                           *   data received at the old line encoding was handed to the IN endpoint. This
+			                           *   includes sending the data queued for the attached device at the old line
+			                           *   encoding, bounded by two character times more than there were characters
+			                           *   queued.
+			                           */
+			uint32_t MaxSwitchTicks; /**< Longest change duration since the statistics were last reset. */
+			uint16_t Clamped; /**< Number of requested baud rates outside the USART's range, clamped to the nearest limit. */
+			uint16_t Rejected; /**< Number of line encodings rejected as the baud rate error exceeded
+			                    *   \ref LINE_CODING_MAX_ERROR_PERMILLE.
+			                    */
+			uint16_t DrainTimeouts; /**< Number of changes where the data queued for the attached device could not all be
+			                         *   sent at the old line encoding within its bound, or as flow control held it
+			                         *   back, so that the remainder was sent at the new line encoding.
+			                         */
+		} LineCoding_Stats_t;
+
+	/* External Variables: */
+		extern LineCoding_State_t LineCoding_State;
+		extern LineCoding_Stats_t LineCoding_Stats;
+
+	/* Inline Functions: */
+		/** Clears the USART transmit complete flag after a new character has been written to the data register, so
+		 *  that the flag indicates when the transmitter has gone idle, and counts the character. This must be called
+		 *  from the USART data register empty ISR, after each write to \c UDR1.
+		 */
+		static inline void LineCoding_CharacterQueued(void) ATTR_ALWAYS_INLINE;
+		static inline void LineCoding_CharacterQueued(void)
+		{
+			UCSR1A = ((UCSR1A & (1 << U2X1)) | (1 << TXC1));
+
+			LineCoding_State.CharsQueued++;
+			LineCoding_State.Transmitted = true;
+		}
+
+	/* Function Prototypes: */
+		void LineCoding_Init(void);
+		bool LineCoding_Compute(CDC_LineEncoding_t* const LineEncoding,
+		                        LineCoding_Registers_t* const Registers);
+		void LineCoding_BeginSwitch(void);
+		void LineCoding_DrainQueued(const uint16_t Count);
+		void LineCoding_WaitTransmitIdle(void);
+		void LineCoding_Apply(const LineCoding_Registers_t* const Registers);
+		void LineCoding_Revert(CDC_LineEncoding_t* const LineEncoding);
+		void LineCoding_RecordSwitch(void);
+		void LineCoding_ResetStats(void);
+
+#endif
+
@@ -0,0 +1,205 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Receive timeout policy engine, deciding when data received from the USART is sent to the host. The first
+ *  received byte arms a deadline on the Timer 1 compare match A unit, and each later one only records its arrival
+ *  time; the compare match interrupt moves the deadline past the last byte until the line has been idle up to it,
+ *  and then marks the buffered data for flushing. The length of the deadline
+ *  is chosen by one of the policies in \ref RxTimeout_Policies_t, each of which keeps its own statistics so
+ *  that they can be compared on the same traffic.
+ */
+
+#include "RxTimeout.h"
+
+RxTimeout_State_t RxTimeout_State;
+RxTimeout_Stats_t RxTimeout_Stats[RX_TIMEOUT_POLICY_COUNT];
+
+/** Clamps a duration in timestamp ticks to the longest deadline that can be armed on the 16-bit counter. */
+static uint16_t RxTimeout_ClampTicks(const uint32_t Ticks)
+{
+	return (Ticks > UINT16_MAX) ? UINT16_MAX : Ticks;
+}
+
+/** Recomputes the deadline armed by the fixed and character time policies, and used by the adaptive policy
+ *  until enough bytes have been received to estimate the gap between them.
+ */
+static void RxTimeout_UpdateTimeout(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	if (RxTimeout_State.Policy == RX_TIMEOUT_POLICY_FixedDeadline)
+	  RxTimeout_State.TimeoutTicks = RxTimeout_ClampTicks(TIMESTAMP_US_TO_TICKS(RX_TIMEOUT_FIXED_US));
+	else
+	  RxTimeout_State.TimeoutTicks = RxTimeout_ClampTicks((uint32_t)RxTimeout_State.CharTicks * RX_TIMEOUT_CHAR_TIMES);
+
+	RxTimeout_State.AverageGap = RxTimeout_ClampTicks((uint32_t)RxTimeout_State.CharTicks << RX_TIMEOUT_EWMA_SHIFT);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Initializes the receive timeout engine with the default policy, \ref RX_TIMEOUT_POLICY. The free-running
+ *  timestamp counter must be started separately.
+ */
+void RxTimeout_Init(void)
+{
+	RxTimeout_State = (RxTimeout_State_t)
+		{
+			.Policy    = RX_TIMEOUT_POLICY,
+			.CharTicks = 1,
+		};
+
+	RxTimeout_ResetStats();
+	RxTimeout_UpdateTimeout();
+}
+
+/** Selects the policy used to compute the flush deadline for subsequently received bytes.
+ *
+ *  \param[in] Policy  New policy to use, a value from \ref RxTimeout_Policies_t.
+ */
+void RxTimeout_SetPolicy(const uint8_t Policy)
+{
+	if (Policy >= RX_TIMEOUT_POLICY_COUNT)
+	  return;
+
+	RxTimeout_State.Policy = Policy;
+	RxTimeout_UpdateTimeout();
+}
+
+/** Updates the duration of a single character on the serial line, from the line encoding set by the host.
+ *
+ *  \param[in] LineEncoding  Pointer to the new line encoding of the virtual serial port.
+ */
+void RxTimeout_SetLineEncoding(const CDC_LineEncoding_t* const LineEncoding)
+{
+	if (!(LineEncoding->BaudRateBPS))
+	  return;
+
+	/* Count the frame length in half bits, so that 1.5 stop bits can be represented */
+	uint8_t FrameHalfBits = (2 * (1 + LineEncoding->DataBits));
+
+	if (LineEncoding->ParityType != CDC_PARITY_None)
+	  FrameHalfBits += 2;
+
+	switch (LineEncoding->CharFormat)
+	{
+		case CDC_LINEENCODING_OneStopBit:
+			FrameHalfBits += 2;
+			break;
+		case CDC_LINEENCODING_OneAndAHalfStopBits:
+			FrameHalfBits += 3;
+			break;
+		case CDC_LINEENCODING_TwoStopBits:
+			FrameHalfBits += 4;
+			break;
+	}
+
+	uint32_t CharTicks = (((uint32_t)FrameHalfBits * TIMESTAMP_TICKS_PER_SECOND) / (2 * LineEncoding->BaudRateBPS));
+
+	RxTimeout_State.CharTicks = CharTicks ? RxTimeout_ClampTicks(CharTicks) : 1;
+	RxTimeout_UpdateTimeout();
+}
+
+/** Records the flush of all data received since the previous flush into the active policy's statistics. This
+ *  should be called once the buffered data has been handed to the USB endpoint following an expired deadline.
+ */
+void RxTimeout_Flushed(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint16_t Latency = (TCNT1 - RxTimeout_State.BurstStartTime);
+	RxTimeout_Stats_t* Stats = &RxTimeout_Stats[RxTimeout_State.Policy];
+
+	RxTimeout_State.BurstOpen = false;
+	RxTimeout_State.Expired   = false;
+
+	uint8_t Bucket = 0;
+	while ((Latency >>= 1) && (Bucket < (RX_TIMEOUT_HISTOGRAM_BUCKETS - 1)))
+	  Bucket++;
+
+	/* Updated with interrupts still held off, as the statistics may be cleared from the control request ISR */
+	Stats->Flushes++;
+
+	if (Stats->LatencyHistogram[Bucket] != UINT16_MAX)
+	  Stats->LatencyHistogram[Bucket]++;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Clears the statistics of all policies. */
+void RxTimeout_ResetStats(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	for (uint8_t Policy = 0; Policy < RX_TIMEOUT_POLICY_COUNT; Policy++)
+	{
+		RxTimeout_Stats[Policy] = (RxTimeout_Stats_t)
+			{
+				.MinTimeoutTicks = UINT16_MAX,
+			};
+	}
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** ISR to mark the buffered USART data for flushing once the line has been idle until the armed deadline, moving the
+ *  deadline past the last byte received if there were any since it was armed.
+ */
+ISR(TIMER1_COMPA_vect, ISR_BLOCK)
+{
+	uint16_t TimeoutTicks = RxTimeout_GetTimeoutTicks();
+	uint16_t Deadline     = (RxTimeout_State.LastByteTime + TimeoutTicks);
+
+	RxTimeout_Stats_t* Stats = &RxTimeout_Stats[RxTimeout_State.Policy];
+
+	if (TimeoutTicks < Stats->MinTimeoutTicks)
+	  Stats->MinTimeoutTicks = TimeoutTicks;
+
+	if (TimeoutTicks > Stats->MaxTimeoutTicks)
+	  Stats->MaxTimeoutTicks = TimeoutTicks;
+
+	/* The new compare value is written before the counter is read, so that a deadline reached in between is treated
+	 * as expired instead of being missed until the counter wraps */
+	OCR1A = Deadline;
+
+	uint16_t Remaining = (Deadline - Timestamp_NowFromISR());
+	if (Remaining && (Remaining <= TimeoutTicks))
+	  return;
+
+	TIMSK1 &= ~(1 << OCIE1A);
+
+	RxTimeout_State.Armed   = false;
+	RxTimeout_State.Expired = true;
+}
+
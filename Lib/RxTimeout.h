@@ -0,0 +1,173 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for RxTimeout.c.
+ */
+
+#ifndef _RX_TIMEOUT_H_
+#define _RX_TIMEOUT_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/interrupt.h>
+		#include <stdbool.h>
+
+		#include "../Config/AppConfig.h"
+		#include "Timestamp.h"
+
+		#include <LUFA/Drivers/USB/USB.h>
+
+	/* Macros: */
+		/** Number of buckets in each policy's flush latency histogram. Bucket \c n counts the flushes whose
+		 *  latency was between 2^n and 2^(n+1) - 1 timestamp ticks, with bucket 0 also counting zero.
+		 */
+		#define RX_TIMEOUT_HISTOGRAM_BUCKETS   16
+
+	/* Enums: */
+		/** Enum for the receive timeout policies, which decide when data received from the USART is sent to the host. */
+		enum RxTimeout_Policies_t
+		{
+			RX_TIMEOUT_POLICY_FixedDeadline = 0, /**< Flush a fixed \ref RX_TIMEOUT_FIXED_US microseconds after the last byte. */
+			RX_TIMEOUT_POLICY_CharTimes     = 1, /**< Flush \ref RX_TIMEOUT_CHAR_TIMES character times after the last byte,
+			                                      *   computed from the line encoding set by the host.
+			                                      */
+			RX_TIMEOUT_POLICY_AdaptiveGap   = 2, /**< Flush \ref RX_TIMEOUT_EWMA_GAPS times the moving average of the gaps
+			                                      *   between received bytes after the last byte, but no sooner than one
+			                                      *   character time.
+			                                      */
+			RX_TIMEOUT_POLICY_COUNT         = 3, /**< Number of available policies. */
+		};
+
+	/* Type Defines: */
+		/** Type define for the flush statistics of a single receive timeout policy. */
+		typedef struct
+		{
+			uint32_t Flushes; /**< Number of flushes triggered while the policy was active. */
+			uint16_t MinTimeoutTicks; /**< Shortest deadline the policy armed, in timestamp ticks. */
+			uint16_t MaxTimeoutTicks; /**< Longest deadline the policy armed, in timestamp ticks. */
+			uint16_t LatencyHistogram[RX_TIMEOUT_HISTOGRAM_BUCKETS]; /**< Histogram of the time between the first byte of
+			                                                          *   a burst arriving and the burst being flushed.
+			                                                          */
+		} RxTimeout_Stats_t;
+
+		/** Type define for the receive timeout engine state. */
+		typedef struct
+		{
+			uint8_t  Policy; /**< Active policy, a value from \ref RxTimeout_Policies_t. */
+			uint16_t TimeoutTicks; /**< Deadline used by the fixed and character time policies. */
+			uint16_t CharTicks; /**< Duration of one character at the current line encoding. */
+			uint16_t AverageGap; /**< Moving average of the gaps between received bytes, scaled by 2^RX_TIMEOUT_EWMA_SHIFT. */
+			uint16_t LastByteTime; /**< Timestamp of the last received byte. */
+			uint16_t BurstStartTime; /**< Timestamp of the first byte received since the last flush. */
+			bool     BurstOpen; /**< Indicates if bytes have been received since the last flush. */
+			bool     Armed; /**< Indicates if the compare match interrupt is enabled to check the deadline. */
+			volatile bool Expired; /**< Set by the compare match interrupt once the armed deadline has passed. */
+		} RxTimeout_State_t;
+
+	/* External Variables: */
+		extern RxTimeout_State_t RxTimeout_State;
+		extern RxTimeout_Stats_t RxTimeout_Stats[RX_TIMEOUT_POLICY_COUNT];
+
+	/* Inline Functions: */
+		/** Computes the flush deadline of the active policy, as a time after the last received byte.
+		 *
+		 *  \return Deadline in timestamp ticks.
+		 */
+		static inline uint16_t RxTimeout_GetTimeoutTicks(void) ATTR_ALWAYS_INLINE;
+		static inline uint16_t RxTimeout_GetTimeoutTicks(void)
+		{
+			if (RxTimeout_State.Policy != RX_TIMEOUT_POLICY_AdaptiveGap)
+			  return RxTimeout_State.TimeoutTicks;
+
+			uint32_t AdaptiveTicks = (((uint32_t)RxTimeout_State.AverageGap * RX_TIMEOUT_EWMA_GAPS) >> RX_TIMEOUT_EWMA_SHIFT);
+			uint16_t TimeoutTicks  = (AdaptiveTicks > UINT16_MAX) ? UINT16_MAX : AdaptiveTicks;
+
+			return (TimeoutTicks < RxTimeout_State.CharTicks) ? RxTimeout_State.CharTicks : TimeoutTicks;
+		}
+
+		/** Records the reception of a byte from the USART. Only its arrival time is stored: the compare match A unit is
+		 *  armed for the first byte after the previous deadline expired, and the compare match interrupt then moves the
+		 *  deadline past the last byte received in the meantime, so that the Timer 1 registers are not rewritten for
+		 *  every byte of a burst. This must be called from the USART receive ISR.
+		 */
+		static inline void RxTimeout_ByteReceived(void) ATTR_ALWAYS_INLINE;
+		static inline void RxTimeout_ByteReceived(void)
+		{
+			uint16_t Now = Timestamp_NowFromISR();
+
+			if (!(RxTimeout_State.BurstOpen))
+			{
+				RxTimeout_State.BurstOpen      = true;
+				RxTimeout_State.BurstStartTime = Now;
+			}
+			else if (RxTimeout_State.Policy == RX_TIMEOUT_POLICY_AdaptiveGap)
+			{
+				uint16_t Gap = (Now - RxTimeout_State.LastByteTime);
+
+				if (Gap > (UINT16_MAX >> RX_TIMEOUT_EWMA_SHIFT))
+				  Gap = (UINT16_MAX >> RX_TIMEOUT_EWMA_SHIFT);
+
+				RxTimeout_State.AverageGap += (Gap - (RxTimeout_State.AverageGap >> RX_TIMEOUT_EWMA_SHIFT));
+			}
+
+			RxTimeout_State.LastByteTime = Now;
+
+			if (RxTimeout_State.Armed)
+			  return;
+
+			RxTimeout_State.Armed   = true;
+			RxTimeout_State.Expired = false;
+
+			OCR1A   = (Now + RxTimeout_GetTimeoutTicks());
+			TIFR1   = (1 << OCF1A);
+			TIMSK1 |= (1 << OCIE1A);
+		}
+
+		/** Determines if the flush deadline armed by the last received byte has passed.
+		 *
+		 *  \return Boolean \c true if the buffered data should be sent to the host, \c false otherwise.
+		 */
+		static inline bool RxTimeout_IsExpired(void) ATTR_ALWAYS_INLINE;
+		static inline bool RxTimeout_IsExpired(void)
+		{
+			return RxTimeout_State.Expired;
+		}
+
+	/* Function Prototypes: */
+		void RxTimeout_Init(void);
+		void RxTimeout_SetPolicy(const uint8_t Policy);
+		void RxTimeout_SetLineEncoding(const CDC_LineEncoding_t* const LineEncoding);
+		void RxTimeout_Flushed(void);
+		void RxTimeout_ResetStats(void);
+
+#endif
+
@@ -0,0 +1,109 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Free-running timestamp counter, shared by the modules that need to measure time on the serial bridge.
+ *  Timer 1 runs continuously in normal mode at \c F_CPU / \ref TIMER1_PRESCALER; its output compare units
+ *  are left free for the modules to schedule their own interrupts against the counter.
+ */
+
+#ifndef _TIMESTAMP_H_
+#define _TIMESTAMP_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+		#include "../Config/AppConfig.h"
+
+		#include <LUFA/Common/Common.h>
+
+	/* Preprocessor Checks: */
+		#if (TIMER1_PRESCALER == 1)
+			#define TIMER1_CLOCK_SELECT        (1 << CS10)
+		#elif (TIMER1_PRESCALER == 8)
+			#define TIMER1_CLOCK_SELECT        (1 << CS11)
+		#elif (TIMER1_PRESCALER == 64)
+			#define TIMER1_CLOCK_SELECT        ((1 << CS11) | (1 << CS10))
+		#elif (TIMER1_PRESCALER == 256)
+			#define TIMER1_CLOCK_SELECT        (1 << CS12)
+		#elif (TIMER1_PRESCALER == 1024)
+			#define TIMER1_CLOCK_SELECT        ((1 << CS12) | (1 << CS10))
+		#else
+			#error TIMER1_PRESCALER must be one of 1, 8, 64, 256 or 1024.
+		#endif
+
+	/* Macros: */
+		/** Number of timestamp ticks per second. */
+		#define TIMESTAMP_TICKS_PER_SECOND     (F_CPU / TIMER1_PRESCALER)
+
+		/** Converts a duration in microseconds into timestamp ticks, rounding down. */
+		#define TIMESTAMP_US_TO_TICKS(us)      ((uint32_t)(us) * (F_CPU / 1000000UL) / TIMER1_PRESCALER)
+
+		/** Converts a duration in timestamp ticks into microseconds, rounding down. */
+		#define TIMESTAMP_TICKS_TO_US(Ticks)   ((uint32_t)(Ticks) * TIMER1_PRESCALER / (F_CPU / 1000000UL))
+
+	/* Inline Functions: */
+		/** Starts the free-running timestamp counter. */
+		static inline void Timestamp_Init(void)
+		{
+			TCCR1A = 0;
+			TCCR1B = TIMER1_CLOCK_SELECT;
+		}
+
+		/** Reads the current timestamp from an ISR. As the 16-bit counter is read through the shared \c TEMP
+		 *  register, this may only be used where no other interrupt can preempt the read.
+		 *
+		 *  \return Current value of the timestamp counter.
+		 */
+		static inline uint16_t Timestamp_NowFromISR(void) ATTR_ALWAYS_INLINE;
+		static inline uint16_t Timestamp_NowFromISR(void)
+		{
+			return TCNT1;
+		}
+
+		/** Reads the current timestamp from the main program thread, atomically with respect to interrupts
+		 *  which may also access 16-bit Timer 1 registers.
+		 *
+		 *  \return Current value of the timestamp counter.
+		 */
+		static inline uint16_t Timestamp_Now(void)
+		{
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			uint16_t Now = TCNT1;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+			return Now;
+		}
+
+#endif
+
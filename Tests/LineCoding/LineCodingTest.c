@@ -0,0 +1,281 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host test of the baud rate solver of Lib/LineCoding.c. Every baud rate the USART can generate is solved and
+ *  checked against a floating point reference: the speed mode chosen must give the lowest error, the rate reported
+ *  back to the host must be the one generated, and the line encoding must be rejected exactly when that error
+ *  exceeds LINE_CODING_MAX_ERROR_PERMILLE. The common host baud rates are then listed with their error, and the
+ *  clamping, rejection and frame format handling is checked.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/mman.h>
+
+#include "../RingBuffer/TestHelpers.h"
+
+#include "../../Lib/LineCoding.h"
+
+/** Margin, in percent, within which the solver's fixed point error may round either way. */
+#define ERROR_MARGIN_PERCENT            0.02
+
+/** Number of failed checks, reported at exit. */
+uint32_t Failures;
+
+/** Common baud rates offered by host serial terminals. */
+static const uint32_t CommonRates[] =
+	{
+		300, 600, 1200, 2400, 4800, 9600, 14400, 19200, 28800, 38400, 57600, 76800, 115200, 128000, 153600,
+		230400, 250000, 256000, 460800, 500000, 576000, 921600, 1000000, 1500000, 2000000,
+	};
+
+/** Computes the baud rate the USART generates for a given speed mode and baud rate register value.
+ *
+ *  \param[in] Divisor  Clock divisor of the speed mode, 16 for normal speed and 8 for double speed.
+ *  \param[in] UBRR     Baud rate register value.
+ *
+ *  \return Generated baud rate.
+ */
+static double GeneratedRate(const uint8_t Divisor,
+                            const uint16_t UBRR)
+{
+	return ((double)F_CPU / (Divisor * (UBRR + 1.0)));
+}
+
+/** Finds the lowest error any baud rate register value gives for a requested rate, over both speed modes. As the
+ *  generated rate falls monotonically with the register value, only the values either side of the exact divider
+ *  need to be tried.
+ *
+ *  \param[in] BaudRateBPS  Requested baud rate, within the USART's range.
+ *
+ *  \return Lowest error of the generated rate relative to the one requested, in percent.
+ */
+static double ReferenceError(const uint32_t BaudRateBPS)
+{
+	double Lowest = INFINITY;
+
+	for (uint8_t Divisor = 8; Divisor <= 16; Divisor += 8)
+	{
+		double Exact = ((double)F_CPU / ((double)Divisor * BaudRateBPS));
+
+		for (double ClockDivider = floor(Exact); ClockDivider <= ceil(Exact); ClockDivider++)
+		{
+			if ((ClockDivider < 1) || (ClockDivider > 4096))
+			  continue;
+
+			double Error = (fabs(GeneratedRate(Divisor, ClockDivider - 1) - BaudRateBPS) * 100 / BaudRateBPS);
+
+			if (Error < Lowest)
+			  Lowest = Error;
+		}
+	}
+
+	return Lowest;
+}
+
+/** Solves a baud rate with 8N1 framing.
+ *
+ *  \param[in]  BaudRateBPS  Requested baud rate.
+ *  \param[out] Registers    USART register values computed.
+ *  \param[out] Reported     Baud rate reported back to the host.
+ *
+ *  \return Whether the line encoding was accepted.
+ */
+static bool Solve(const uint32_t BaudRateBPS,
+                  LineCoding_Registers_t* const Registers,
+                  uint32_t* const Reported)
+{
+	CDC_LineEncoding_t LineEncoding =
+		{
+			.BaudRateBPS = BaudRateBPS,
+			.CharFormat  = CDC_LINEENCODING_OneStopBit,
+			.ParityType  = CDC_PARITY_None,
+			.DataBits    = 8,
+		};
+
+	bool Accepted = LineCoding_Compute(&LineEncoding, Registers);
+
+	*Reported = LineEncoding.BaudRateBPS;
+	return Accepted;
+}
+
+/** Checks the solution of every baud rate within the USART's range against the reference. */
+static void Test_Sweep(void)
+{
+	uint32_t Accepted = 0;
+
+	for (uint32_t BaudRateBPS = LINE_CODING_MIN_BAUD; BaudRateBPS <= LINE_CODING_MAX_BAUD; BaudRateBPS++)
+	{
+		LineCoding_Registers_t Registers;
+		uint32_t               Reported;
+
+		bool    Result    = Solve(BaudRateBPS, &Registers, &Reported);
+		uint8_t Divisor   = (Registers.UCSRA & (1 << U2X1)) ? 8 : 16;
+		double  Generated = GeneratedRate(Divisor, Registers.UBRR);
+		double  Error     = (fabs(Generated - BaudRateBPS) * 100 / BaudRateBPS);
+		double  Limit     = (LINE_CODING_MAX_ERROR_PERMILLE / 10.0);
+		double  Lowest    = ReferenceError(BaudRateBPS);
+
+		/* The solver's fixed point error is truncated to a hundredth of a percent, so near ties may go either way */
+		CHECK(Error <= (Lowest + ERROR_MARGIN_PERCENT), "%u baud solved at %.3f%%, %.3f%% is possible", BaudRateBPS, Error, Lowest);
+
+		if (Error < (Limit - ERROR_MARGIN_PERCENT))
+		  CHECK(Result, "%u baud rejected at %.3f%%", BaudRateBPS, Error);
+		else if (Error > (Limit + ERROR_MARGIN_PERCENT))
+		  CHECK(!(Result), "%u baud accepted at %.3f%%", BaudRateBPS, Error);
+
+		if (!(Result))
+		  continue;
+
+		Accepted++;
+
+		CHECK(Reported == lround(Generated), "%u baud reported as %u, generated at %.1f", BaudRateBPS, Reported, Generated);
+		CHECK(Registers.BaudRateBPS == Reported, "%u baud applied as %u, reported as %u", BaudRateBPS,
+		      Registers.BaudRateBPS, Reported);
+		CHECK((Registers.DrainTicks * Registers.BaudRateBPS) >= (12UL * TIMESTAMP_TICKS_PER_SECOND),
+		      "%u baud allows %u ticks per character", BaudRateBPS, Registers.DrainTicks);
+	}
+
+	uint32_t Rates = (LINE_CODING_MAX_BAUD - LINE_CODING_MIN_BAUD + 1);
+
+	printf("  %lu to %lu baud: %u accepted, %u rejected\n", LINE_CODING_MIN_BAUD, LINE_CODING_MAX_BAUD, Accepted,
+	       (Rates - Accepted));
+}
+
+/** Lists the common host baud rates with the rate generated and its error, checking that 230400 baud is accepted. */
+static void Test_CommonRates(void)
+{
+	for (uint8_t i = 0; i < (sizeof(CommonRates) / sizeof(CommonRates[0])); i++)
+	{
+		LineCoding_Registers_t Registers;
+		uint32_t               Reported;
+
+		bool    Result  = Solve(CommonRates[i], &Registers, &Reported);
+		uint8_t Divisor = (Registers.UCSRA & (1 << U2X1)) ? 8 : 16;
+		double  Error   = ((GeneratedRate(Divisor, Registers.UBRR) - CommonRates[i]) * 100 / CommonRates[i]);
+
+		printf("  %7u baud: UBRR %4u x%u, %+6.2f%% %s\n", CommonRates[i], Registers.UBRR, (16 / Divisor), Error,
+		       Result ? "accepted" : "rejected");
+
+		if (CommonRates[i] <= 250000)
+		  CHECK(Result, "%u baud rejected at %.2f%%", CommonRates[i], Error);
+	}
+}
+
+/** Checks the clamping of out of range baud rates, the rejection counter and the restoring of the previous line
+ *  encoding after a rejection.
+ */
+static void Test_Limits(void)
+{
+	LineCoding_Registers_t Registers;
+	uint32_t               Reported;
+
+	LineCoding_Init();
+
+	CHECK(Solve(50, &Registers, &Reported) && (abs((int32_t)(Reported - LINE_CODING_MIN_BAUD)) <= 1),
+	      "50 baud not clamped to the slowest rate, reported as %u", Reported);
+	CHECK(Solve(4000000, &Registers, &Reported) && (Reported == LINE_CODING_MAX_BAUD),
+	      "4000000 baud not clamped to the fastest rate, reported as %u", Reported);
+	CHECK(LineCoding_Stats.Clamped == 2, "%u clamped rates counted", LineCoding_Stats.Clamped);
+
+	CHECK(Solve(115200, &Registers, &Reported), "115200 baud rejected");
+	CHECK(!(Solve(1500000, &Registers, &Reported)), "1500000 baud accepted");
+	CHECK(LineCoding_Stats.Rejected == 1, "%u rejected rates counted", LineCoding_Stats.Rejected);
+
+	CDC_LineEncoding_t LineEncoding;
+	LineCoding_Revert(&LineEncoding);
+	CHECK(LineEncoding.BaudRateBPS == 117647, "rejection reverted to %u baud", LineEncoding.BaudRateBPS);
+}
+
+/** Checks the frame format register value for every parity, stop bit and data length combination. */
+static void Test_FrameFormat(void)
+{
+	static const uint8_t ParityMasks[] = { 0, ((1 << UPM11) | (1 << UPM10)), (1 << UPM11) };
+
+	for (uint8_t ParityType = CDC_PARITY_None; ParityType <= CDC_PARITY_Even; ParityType++)
+	{
+		for (uint8_t DataBits = 6; DataBits <= 8; DataBits++)
+		{
+			for (uint8_t CharFormat = CDC_LINEENCODING_OneStopBit; CharFormat <= CDC_LINEENCODING_TwoStopBits;
+			     CharFormat += (CDC_LINEENCODING_TwoStopBits - CDC_LINEENCODING_OneStopBit))
+			{
+				CDC_LineEncoding_t LineEncoding =
+					{
+						.BaudRateBPS = 9600,
+						.CharFormat  = CharFormat,
+						.ParityType  = ParityType,
+						.DataBits    = DataBits,
+					};
+
+				LineCoding_Registers_t Registers;
+				LineCoding_Compute(&LineEncoding, &Registers);
+
+				uint8_t Expected = (ParityMasks[ParityType] | ((DataBits - 5) << UCSZ10));
+				if (CharFormat == CDC_LINEENCODING_TwoStopBits)
+				  Expected |= (1 << USBS1);
+
+				CHECK(Registers.UCSRC == Expected, "parity %u, %u data bits, stop bits %u: UCSRC %02X, %02X expected",
+				      ParityType, DataBits, CharFormat, Registers.UCSRC, Expected);
+			}
+		}
+	}
+}
+
+int main(void)
+{
+	/* The solver only touches SREG, through the critical sections around its counters, which are left untrapped */
+	if (mmap((void*)SIM_DATA_SPACE_ADDRESS, SIM_DATA_SPACE_SIZE, (PROT_READ | PROT_WRITE),
+	         (MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE), -1, 0) != (void*)SIM_DATA_SPACE_ADDRESS)
+	{
+		printf("Unable to map the data space at %#lx\n", SIM_DATA_SPACE_ADDRESS);
+		return EXIT_FAILURE;
+	}
+
+	printf("LineCoding.c, F_CPU %lu, %u.%u%% largest error\n", F_CPU, (LINE_CODING_MAX_ERROR_PERMILLE / 10),
+	       (LINE_CODING_MAX_ERROR_PERMILLE % 10));
+
+	printf(" Baud rate sweep\n");
+	Test_Sweep();
+
+	printf(" Common baud rates\n");
+	Test_CommonRates();
+
+	printf(" Limits\n");
+	Test_Limits();
+
+	printf(" Frame formats\n");
+	Test_FrameFormat();
+
+	printf(" %s\n", Failures ? "FAILED" : "PASSED");
+	return (Failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,596 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Native simulation of the USB to serial bridge. The application and the LUFA device core are built for the host
+ *  against a model of the ATmega32U4's Timer 1, USART 1 and USB controller, see Sim.c. A USB host enumerates the
+ *  bridge and exchanges 1 ms frames with it while a peer on the USART side sends and receives at the given baud
+ *  rate, each direction carrying a test stream. Once the traffic has run for the given time and the bridge has
+ *  drained, the throughput, the latency percentiles and the dropped bytes of each direction are reported, along with
+ *  the time spent in each ISR. The run fails if either direction drops more than the given share of its bytes, by
+ *  default any byte at all.
+ *
+ *  Given a CTS hold time, the peer holds CTS for that time from halfway through the traffic, and the host sets the
+ *  line coding again halfway through the hold; the duration of the switch is then read back from the device. CTS only
+ *  holds the bridge back when it is built with \c FLOW_CONTROL set to \c FLOW_CONTROL_RtsCts.
+ *
+ *  Given a receive timeout policy, a value from \ref RxTimeout_Policies_t, the host selects it through the vendor
+ *  control request before the traffic starts; otherwise the bridge keeps its default, \c RX_TIMEOUT_POLICY.
+ *
+ *  Usage: NativeSim [-b baud] [-t seconds] [-l USART to USB load %] [-o USB to USART load %]
+ *                   [-i IN tokens per frame] [-c cycles per register access] [-d dropped bytes allowed %]
+ *                   [-s line coding switch CTS hold ms] [-p receive timeout policy]
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "Sim.h"
+#include "Timer1Model.h"
+#include "USARTModel.h"
+#include "USBModel.h"
+#include "USBHost.h"
+#include "Stream.h"
+
+#include "../../USBtoSerial.h"
+
+/** Time left for the bridge to settle once configured, before the traffic starts, in microseconds. */
+#define NATIVE_SIM_SETTLE_US      10000
+
+/** Time left for the bridge to drain once the traffic stops, on top of the time to send the bytes still queued, in
+ *  microseconds.
+ */
+#define NATIVE_SIM_DRAIN_US       50000
+
+/** Enum for the phases of a simulation run. */
+enum NativeSim_Phases_t
+{
+	NATIVE_SIM_PHASE_Enumeration = 0,
+	NATIVE_SIM_PHASE_Settle      = 1,
+	NATIVE_SIM_PHASE_Traffic     = 2,
+	NATIVE_SIM_PHASE_Drain       = 3,
+	NATIVE_SIM_PHASE_Statistics  = 4,
+	NATIVE_SIM_PHASE_LineCoding  = 5,
+};
+
+/** Enum for the steps of a line coding switch made during the traffic. */
+enum NativeSim_SwitchSteps_t
+{
+	NATIVE_SIM_SWITCH_Pending  = 0,
+	NATIVE_SIM_SWITCH_CTSHeld  = 1,
+	NATIVE_SIM_SWITCH_Sent     = 2,
+	NATIVE_SIM_SWITCH_Done     = 3,
+};
+
+/** Entry point of the application, renamed when built for the simulation. */
+int Firmware_main(void);
+
+static struct
+{
+	uint32_t Baud;
+	double   Seconds;
+	uint8_t  USARTToUSBLoad;
+	uint8_t  USBToUSARTLoad;
+	uint8_t  INTokensPerFrame;
+	double   MaxDropPercent;
+	uint32_t SwitchHoldMS;
+	uint8_t  TimeoutPolicy;
+} NativeSim_Options =
+	{
+		.Baud             = 115200,
+		.Seconds          = 1.0,
+		.USARTToUSBLoad   = 100,
+		.USBToUSARTLoad   = 100,
+		.INTokensPerFrame = 0,
+		.MaxDropPercent   = 0,
+		.SwitchHoldMS     = 0,
+		.TimeoutPolicy    = RX_TIMEOUT_POLICY_COUNT,
+	};
+
+static struct
+{
+	uint8_t  Phase;
+	uint64_t PhaseEnd;
+	bool     PolicySet;
+	uint64_t TrafficStart;
+	uint64_t TrafficEnd;
+	uint64_t OUTFirst;
+	uint64_t OUTAllowance;
+	bool     StatsValid;
+	uint32_t DeviceDropped;
+	uint8_t  SwitchStep;
+	uint64_t SwitchStepTime;
+	bool     LineCodingValid;
+	LineCoding_Stats_t LineCodingStats;
+} NativeSim_State;
+
+static Stream_t NativeSim_USARTToUSB;
+static Stream_t NativeSim_USBToUSART;
+
+/** Names of the vectors of the modelled peripherals, in the order their time in ISRs is reported. */
+static const struct
+{
+	uint8_t     Vector;
+	const char* Name;
+} NativeSim_VectorNames[] =
+	{
+		{ SIM_VECTOR_USART1_RX,    "USART1_RX"    },
+		{ SIM_VECTOR_USART1_UDRE,  "USART1_UDRE"  },
+		{ SIM_VECTOR_USART1_TX,    "USART1_TX"    },
+		{ SIM_VECTOR_USB_GEN,      "USB_GEN"      },
+		{ SIM_VECTOR_USB_COM,      "USB_COM"      },
+		{ SIM_VECTOR_TIMER1_COMPA, "TIMER1_COMPA" },
+		{ SIM_VECTOR_TIMER1_COMPB, "TIMER1_COMPB" },
+		{ SIM_VECTOR_TIMER1_OVF,   "TIMER1_OVF"   },
+	};
+
+/** Supplies the next character sent by the peer, while the traffic runs. */
+static bool NativeSim_PeerSource(uint8_t* const Byte,
+                                 const uint64_t EndTime)
+{
+	if (NativeSim_State.Phase != NATIVE_SIM_PHASE_Traffic)
+	  return false;
+
+	uint64_t Position = Stream_Generate(&NativeSim_USARTToUSB, Byte, 1);
+	Stream_SetSentTime(&NativeSim_USARTToUSB, Position, 1, EndTime);
+
+	return true;
+}
+
+/** Checks a character received by the peer. */
+static void NativeSim_PeerSink(const uint8_t Byte,
+                               const uint64_t EndTime)
+{
+	Stream_Receive(&NativeSim_USBToUSART, &Byte, 1, EndTime);
+}
+
+/** Checks a packet received by the host. */
+static void NativeSim_HostReceived(const uint8_t* const Data,
+                                   const uint16_t Length,
+                                   const uint64_t Time)
+{
+	Stream_Receive(&NativeSim_USARTToUSB, Data, Length, Time);
+}
+
+/** Fills the next packet sent by the host, at the given share of the USART's line rate while the traffic runs. */
+static uint16_t NativeSim_HostFill(uint8_t* const Data,
+                                   const uint16_t MaxLength)
+{
+	if (NativeSim_State.Phase != NATIVE_SIM_PHASE_Traffic)
+	  return 0;
+
+	double   Elapsed = (double)(Sim_Cycles - NativeSim_State.TrafficStart);
+	uint64_t Allowed = (uint64_t)(Elapsed * NativeSim_Options.USBToUSARTLoad / 100 / USARTModel_GetPeerCharCycles()) + 1;
+
+	if (Allowed <= NativeSim_USBToUSART.Sent)
+	  return 0;
+
+	uint16_t Length = ((Allowed - NativeSim_USBToUSART.Sent) < MaxLength) ? (Allowed - NativeSim_USBToUSART.Sent) : MaxLength;
+
+	NativeSim_State.OUTFirst = Stream_Generate(&NativeSim_USBToUSART, Data, Length);
+	return Length;
+}
+
+/** Stamps the packet last filled with the time the device acknowledged it. */
+static void NativeSim_HostSent(const uint16_t Length,
+                               const uint64_t Time)
+{
+	Stream_SetSentTime(&NativeSim_USBToUSART, NativeSim_State.OUTFirst, Length, Time);
+}
+
+/** Reads the device's count of bytes received from the USART and dropped for lack of buffer space, once the
+ *  control transfer reading them has completed.
+ */
+static void NativeSim_ReadDeviceStats(void)
+{
+	uint16_t       Length;
+	const uint8_t* Data = USBHost_GetControlData(&Length);
+
+	if ((USBHost_GetControlStatus() != USB_HOST_CONTROL_Done) || (Length != sizeof(FlowControl_Stats_t)))
+	  return;
+
+	FlowControl_Stats_t Stats;
+	memcpy(&Stats, Data, sizeof(Stats));
+
+	NativeSim_State.StatsValid    = true;
+	NativeSim_State.DeviceDropped = Stats.UsartToUsbDropped;
+}
+
+/** Requests one of the device's statistics blocks through the vendor control request.
+ *
+ *  \param[in] Block   Statistics block to read, a value from \ref StatsBlocks_t.
+ *  \param[in] Length  Size of the block.
+ *
+ *  \return Boolean \c true if the request was submitted, \c false if another one is still in progress.
+ */
+static bool NativeSim_RequestStats(const uint8_t Block,
+                                   const uint16_t Length)
+{
+	USB_Request_Header_t Request =
+		{
+			.bmRequestType = (REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE),
+			.bRequest      = VENDOR_REQ_GetStats,
+			.wValue        = Block,
+			.wLength       = Length,
+		};
+
+	return USBHost_SubmitControl(&Request, NULL);
+}
+
+/** Reads the device's line coding change statistics, once the control transfer reading them has completed. */
+static void NativeSim_ReadLineCodingStats(void)
+{
+	uint16_t       Length;
+	const uint8_t* Data = USBHost_GetControlData(&Length);
+
+	if ((USBHost_GetControlStatus() != USB_HOST_CONTROL_Done) || (Length != sizeof(LineCoding_Stats_t)))
+	  return;
+
+	memcpy(&NativeSim_State.LineCodingStats, Data, sizeof(LineCoding_Stats_t));
+	NativeSim_State.LineCodingValid = true;
+}
+
+/** Runs the line coding switch made halfway through the traffic: the peer holds CTS for the given time, and the host
+ *  sets the line coding again halfway through the hold, with the data it sent to the USART still queued.
+ */
+static void NativeSim_RunSwitch(void)
+{
+	uint64_t HoldCycles = SIM_US_TO_CYCLES((uint64_t)NativeSim_Options.SwitchHoldMS * 1000);
+
+	switch (NativeSim_State.SwitchStep)
+	{
+		case NATIVE_SIM_SWITCH_Pending:
+			if (Sim_Cycles < (NativeSim_State.TrafficStart + ((NativeSim_State.TrafficEnd - NativeSim_State.TrafficStart) / 2)))
+			  break;
+
+			SIM_STORAGE(FLOW_CONTROL_CTS_PIN) |= FLOW_CONTROL_CTS_MASK;
+
+			NativeSim_State.SwitchStep     = NATIVE_SIM_SWITCH_CTSHeld;
+			NativeSim_State.SwitchStepTime = Sim_Cycles;
+			break;
+		case NATIVE_SIM_SWITCH_CTSHeld:
+			if (Sim_Cycles < (NativeSim_State.SwitchStepTime + (HoldCycles / 2)))
+			  break;
+
+			CDC_LineEncoding_t LineEncoding =
+				{
+					.BaudRateBPS = NativeSim_Options.Baud,
+					.CharFormat  = CDC_LINEENCODING_OneStopBit,
+					.ParityType  = CDC_PARITY_None,
+					.DataBits    = 8,
+				};
+
+			USB_Request_Header_t Request =
+				{
+					.bmRequestType = (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE),
+					.bRequest      = CDC_REQ_SetLineEncoding,
+					.wValue        = 0,
+					.wIndex        = INTERFACE_ID_CDC_CCI,
+					.wLength       = sizeof(LineEncoding),
+				};
+
+			if (USBHost_SubmitControl(&Request, &LineEncoding))
+			  NativeSim_State.SwitchStep = NATIVE_SIM_SWITCH_Sent;
+
+			break;
+		case NATIVE_SIM_SWITCH_Sent:
+			if (Sim_Cycles < (NativeSim_State.SwitchStepTime + HoldCycles))
+			  break;
+
+			SIM_STORAGE(FLOW_CONTROL_CTS_PIN) &= ~FLOW_CONTROL_CTS_MASK;
+
+			NativeSim_State.SwitchStep = NATIVE_SIM_SWITCH_Done;
+			break;
+	}
+}
+
+/** Moves the run through its phases, stopping the firmware once the statistics have been read. */
+static void NativeSim_Update(void)
+{
+	switch (NativeSim_State.Phase)
+	{
+		case NATIVE_SIM_PHASE_Enumeration:
+			if (USBHost_IsConfigured())
+			{
+				NativeSim_State.Phase    = NATIVE_SIM_PHASE_Settle;
+				NativeSim_State.PhaseEnd = (Sim_Cycles + SIM_US_TO_CYCLES(NATIVE_SIM_SETTLE_US));
+			}
+
+			break;
+		case NATIVE_SIM_PHASE_Settle:
+			if ((NativeSim_Options.TimeoutPolicy != RX_TIMEOUT_POLICY_COUNT) && !(NativeSim_State.PolicySet))
+			{
+				USB_Request_Header_t Request =
+					{
+						.bmRequestType = (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE),
+						.bRequest      = VENDOR_REQ_SetTimeoutPolicy,
+						.wValue        = NativeSim_Options.TimeoutPolicy,
+					};
+
+				NativeSim_State.PolicySet = USBHost_SubmitControl(&Request, NULL);
+			}
+
+			if ((Sim_Cycles < NativeSim_State.PhaseEnd) || (USBHost_GetControlStatus() == USB_HOST_CONTROL_Busy))
+			  break;
+
+			NativeSim_State.Phase        = NATIVE_SIM_PHASE_Traffic;
+			NativeSim_State.TrafficStart = Sim_Cycles;
+			NativeSim_State.TrafficEnd   = (Sim_Cycles + (uint64_t)(NativeSim_Options.Seconds * F_CPU));
+			NativeSim_State.PhaseEnd     = NativeSim_State.TrafficEnd;
+
+			NativeSim_USARTToUSB.WindowStart = NativeSim_State.TrafficStart;
+			NativeSim_USARTToUSB.WindowEnd   = NativeSim_State.TrafficEnd;
+			NativeSim_USBToUSART.WindowStart = NativeSim_State.TrafficStart;
+			NativeSim_USBToUSART.WindowEnd   = NativeSim_State.TrafficEnd;
+			break;
+		case NATIVE_SIM_PHASE_Traffic:
+			if (NativeSim_Options.SwitchHoldMS)
+			  NativeSim_RunSwitch();
+
+			if (Sim_Cycles < NativeSim_State.PhaseEnd)
+			  break;
+
+			/* The bytes still queued towards the USART take their line time to come out */
+			uint64_t Queued = (NativeSim_USBToUSART.Sent - NativeSim_USBToUSART.Received);
+
+			NativeSim_State.Phase    = NATIVE_SIM_PHASE_Drain;
+			NativeSim_State.PhaseEnd = (Sim_Cycles + SIM_US_TO_CYCLES(NATIVE_SIM_DRAIN_US) +
+			                            (uint64_t)(Queued * USARTModel_GetPeerCharCycles()));
+			break;
+		case NATIVE_SIM_PHASE_Drain:
+			if (Sim_Cycles < NativeSim_State.PhaseEnd)
+			  break;
+
+			if (NativeSim_RequestStats(STATS_BLOCK_FlowControl, sizeof(FlowControl_Stats_t)))
+			  NativeSim_State.Phase = NATIVE_SIM_PHASE_Statistics;
+
+			break;
+		case NATIVE_SIM_PHASE_Statistics:
+			if (USBHost_GetControlStatus() == USB_HOST_CONTROL_Busy)
+			  break;
+
+			NativeSim_ReadDeviceStats();
+
+			if (!(NativeSim_Options.SwitchHoldMS))
+			  Sim_Stop();
+			else if (NativeSim_RequestStats(STATS_BLOCK_LineCoding, sizeof(LineCoding_Stats_t)))
+			  NativeSim_State.Phase = NATIVE_SIM_PHASE_LineCoding;
+
+			break;
+		case NATIVE_SIM_PHASE_LineCoding:
+			if (USBHost_GetControlStatus() == USB_HOST_CONTROL_Busy)
+			  break;
+
+			NativeSim_ReadLineCodingStats();
+			Sim_Stop();
+			break;
+	}
+}
+
+/** Prints the results of one direction of the bridge.
+ *
+ *  \param[in] Stream       Stream carried in that direction.
+ *  \param[in] CharCycles   Duration of a character on the USART line, for the line rate.
+ *  \param[in] Overruns     Bytes known to have been lost by the USART model, or zero.
+ *
+ *  \return Boolean \c true if the direction passed, with no corrupt bytes and no more dropped than allowed.
+ */
+static bool NativeSim_PrintStream(const Stream_t* const Stream,
+                                      const double CharCycles,
+                                      const uint64_t Overruns)
+{
+	double Seconds    = ((double)(Stream->WindowEnd - Stream->WindowStart) / F_CPU);
+	double Throughput = (Stream->WindowBytes / Seconds);
+	double LineRate   = (F_CPU / CharCycles);
+
+	printf(" %s\n", Stream->Name);
+	printf("  %llu bytes sent, %llu received, %.0f B/s (%.1f%% of the line rate)\n", (unsigned long long)Stream->Sent,
+	       (unsigned long long)Stream->Received, Throughput, (Throughput * 100 / LineRate));
+	printf("  latency us: p50 %.1f  p90 %.1f  p99 %.1f  p99.9 %.1f  max %.1f\n",
+	       ((double)Stream_GetLatencyPercentile(Stream, 50) / SIM_CYCLES_PER_US),
+	       ((double)Stream_GetLatencyPercentile(Stream, 90) / SIM_CYCLES_PER_US),
+	       ((double)Stream_GetLatencyPercentile(Stream, 99) / SIM_CYCLES_PER_US),
+	       ((double)Stream_GetLatencyPercentile(Stream, 99.9) / SIM_CYCLES_PER_US),
+	       ((double)Stream_GetLatencyPercentile(Stream, 100) / SIM_CYCLES_PER_US));
+	printf("  %llu dropped (%.1f%%, %llu USART overruns, %llu in the firmware), %llu corrupt\n",
+	       (unsigned long long)Stream->Missing, (Stream->Sent ? (Stream->Missing * 100.0 / Stream->Sent) : 0),
+	       (unsigned long long)Overruns,
+	       (unsigned long long)(Stream->Missing - ((Overruns < Stream->Missing) ? Overruns : Stream->Missing)),
+	       (unsigned long long)Stream->Corrupt);
+
+	return (!(Stream->Corrupt) && ((Stream->Missing * 100.0) <= (Stream->Sent * NativeSim_Options.MaxDropPercent)));
+}
+
+/** Parses the command line options, exiting with a usage message on an invalid one. */
+static void NativeSim_ParseOptions(int argc,
+                                   char* argv[])
+{
+	int Option;
+
+	while ((Option = getopt(argc, argv, "b:t:l:o:i:c:d:s:p:")) != -1)
+	{
+		switch (Option)
+		{
+			case 'b':
+				NativeSim_Options.Baud = strtoul(optarg, NULL, 0);
+				break;
+			case 't':
+				NativeSim_Options.Seconds = strtod(optarg, NULL);
+				break;
+			case 'l':
+				NativeSim_Options.USARTToUSBLoad = strtoul(optarg, NULL, 0);
+				break;
+			case 'o':
+				NativeSim_Options.USBToUSARTLoad = strtoul(optarg, NULL, 0);
+				break;
+			case 'i':
+				NativeSim_Options.INTokensPerFrame = strtoul(optarg, NULL, 0);
+				break;
+			case 'c':
+				Sim_AccessCycles = strtoul(optarg, NULL, 0);
+				break;
+			case 'd':
+				NativeSim_Options.MaxDropPercent = strtod(optarg, NULL);
+				break;
+			case 's':
+				NativeSim_Options.SwitchHoldMS = strtoul(optarg, NULL, 0);
+				break;
+			case 'p':
+				NativeSim_Options.TimeoutPolicy = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-b baud] [-t seconds] [-l USART to USB load %%] [-o USB to USART load %%] "
+				                "[-i IN tokens per frame] [-c cycles per register access] [-d dropped bytes allowed %%] "
+				                "[-s line coding switch CTS hold ms] [-p receive timeout policy]\n",
+				        argv[0]);
+				exit(EXIT_FAILURE);
+		}
+	}
+
+	if (!(NativeSim_Options.Baud) || (NativeSim_Options.Seconds <= 0) ||
+	    (NativeSim_Options.USARTToUSBLoad > 100) || (NativeSim_Options.USBToUSARTLoad > 100) || !(Sim_AccessCycles) ||
+	    (NativeSim_Options.MaxDropPercent < 0) || (NativeSim_Options.TimeoutPolicy > RX_TIMEOUT_POLICY_COUNT))
+	{
+		fprintf(stderr, "Invalid option value\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	NativeSim_ParseOptions(argc, argv);
+
+	Stream_Init(&NativeSim_USARTToUSB, "USART to USB", 0x5A17);
+	Stream_Init(&NativeSim_USBToUSART, "USB to USART", 0xC0DE);
+
+	const USBHost_DataHandlers_t Handlers =
+		{
+			.Received = NativeSim_HostReceived,
+			.Fill     = NativeSim_HostFill,
+			.Sent     = NativeSim_HostSent,
+		};
+
+	Sim_Init();
+	Timer1Model_Init();
+	USARTModel_Init();
+	USBModel_Init();
+	USBHost_Init(NativeSim_Options.Baud, NativeSim_Options.INTokensPerFrame, &Handlers);
+	Sim_AddModel(NativeSim_Update);
+
+	if (NativeSim_Options.USARTToUSBLoad)
+	  USARTModel_SetPeer(NativeSim_Options.Baud, NativeSim_Options.USARTToUSBLoad, NativeSim_PeerSource, NativeSim_PeerSink);
+	else
+	  USARTModel_SetPeer(NativeSim_Options.Baud, 100, NULL, NativeSim_PeerSink);
+
+	struct timespec Start;
+	struct timespec End;
+
+	clock_gettime(CLOCK_MONOTONIC, &Start);
+	Sim_Run(Firmware_main);
+	clock_gettime(CLOCK_MONOTONIC, &End);
+
+	Stream_Finish(&NativeSim_USARTToUSB);
+	Stream_Finish(&NativeSim_USBToUSART);
+
+	double HostSeconds = ((End.tv_sec - Start.tv_sec) + (End.tv_nsec - Start.tv_nsec) / 1e9);
+
+	printf("USB to serial bridge, native simulation\n");
+	printf("  %lu baud, %.3f s of traffic at %u%% USART to USB and %u%% USB to USART load, %u cycles per access\n",
+	       (unsigned long)NativeSim_Options.Baud, NativeSim_Options.Seconds, NativeSim_Options.USARTToUSBLoad,
+	       NativeSim_Options.USBToUSARTLoad, (unsigned)Sim_AccessCycles);
+	printf("  %.3f s simulated in %.2f s, %llu register accesses, %llu interrupts\n", ((double)Sim_Cycles / F_CPU),
+	       HostSeconds, (unsigned long long)Sim_Accesses, (unsigned long long)Sim_Interrupts);
+
+	bool Passed = true;
+
+	Passed &= NativeSim_PrintStream(&NativeSim_USARTToUSB, USARTModel_GetPeerCharCycles(),
+	                                 (USARTModel_Stats.Overruns + USARTModel_Stats.DisabledDrops));
+
+	if (NativeSim_State.StatsValid)
+	  printf("  %lu dropped as reported by the device\n", (unsigned long)NativeSim_State.DeviceDropped);
+
+	Passed &= NativeSim_PrintStream(&NativeSim_USBToUSART, USARTModel_GetPeerCharCycles(), 0);
+
+	printf(" USB\n");
+	printf("  %llu frames, %llu IN tokens (%llu NAKed, %llu data packets, %llu zero length), %llu bytes\n",
+	       (unsigned long long)USBHost_Stats.Frames, (unsigned long long)USBHost_Stats.INTokens,
+	       (unsigned long long)USBHost_Stats.INNAKs, (unsigned long long)USBHost_Stats.INPackets,
+	       (unsigned long long)USBHost_Stats.INZeroLength, (unsigned long long)USBHost_Stats.INBytes);
+	printf("  %llu OUT packets (%llu NAKed), %llu bytes, %llu control transfers, %llu notifications\n",
+	       (unsigned long long)USBHost_Stats.OUTPackets, (unsigned long long)USBHost_Stats.OUTNAKs,
+	       (unsigned long long)USBHost_Stats.OUTBytes, (unsigned long long)USBHost_Stats.ControlTransfers,
+	       (unsigned long long)USBHost_Stats.Notifications);
+
+	if (NativeSim_Options.SwitchHoldMS)
+	{
+		printf(" Line coding\n");
+
+		if (NativeSim_State.LineCodingValid)
+		{
+			const LineCoding_Stats_t* Stats = &NativeSim_State.LineCodingStats;
+
+			printf("  %u changes, last switch %.1f us, longest %.1f us, %u drain timeouts\n", Stats->Changes,
+			       (Stats->LastSwitchTicks * 1e6 / TIMESTAMP_TICKS_PER_SECOND),
+			       (Stats->MaxSwitchTicks * 1e6 / TIMESTAMP_TICKS_PER_SECOND), Stats->DrainTimeouts);
+		}
+		else
+		{
+			printf("  statistics not read\n");
+		}
+	}
+
+	printf(" Interrupts\n");
+	for (uint8_t i = 0; i < (sizeof(NativeSim_VectorNames) / sizeof(NativeSim_VectorNames[0])); i++)
+	{
+		uint8_t Vector = NativeSim_VectorNames[i].Vector;
+
+		if (!(Sim_VectorRuns[Vector]))
+		  continue;
+
+		printf("  %-14s %10llu runs, %6.1f cycles each, %4.1f%% of the CPU\n", NativeSim_VectorNames[i].Name,
+		       (unsigned long long)Sim_VectorRuns[Vector], ((double)Sim_VectorCycles[Vector] / Sim_VectorRuns[Vector]),
+		       (Sim_VectorCycles[Vector] * 100.0 / Sim_Cycles));
+	}
+
+	bool Failed = (!(Passed) || !(NativeSim_State.StatsValid) ||
+	               (NativeSim_Options.SwitchHoldMS && !(NativeSim_State.LineCodingValid)) ||
+	               (NativeSim_Options.USARTToUSBLoad && !(NativeSim_USARTToUSB.Received)) ||
+	               (NativeSim_Options.USBToUSARTLoad && !(NativeSim_USBToUSART.Received)));
+
+	printf(" %s\n", Failed ? "FAILED" : "PASSED");
+
+	Stream_Free(&NativeSim_USARTToUSB);
+	Stream_Free(&NativeSim_USBToUSART);
+
+	return Failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
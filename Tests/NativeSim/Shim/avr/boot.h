@@ -0,0 +1,46 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc bootloader support header. Only the signature row is read by the device build,
+ *  for the internal serial number, which reads as a fixed pattern.
+ */
+
+#ifndef __SIM_AVR_BOOT_H__
+#define __SIM_AVR_BOOT_H__
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Macros: */
+		#define boot_signature_byte_get(Address) ((uint8_t)(0x5A ^ (Address)))
+
+#endif
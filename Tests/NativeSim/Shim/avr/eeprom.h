@@ -0,0 +1,65 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc EEPROM header. Variables placed in the EEPROM are ordinary variables on the host,
+ *  holding their initial values as if the EEPROM image had been programmed along with the flash.
+ */
+
+#ifndef __SIM_AVR_EEPROM_H__
+#define __SIM_AVR_EEPROM_H__
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <string.h>
+
+	/* Macros: */
+		#define EEMEM
+
+		#define eeprom_is_ready()                          1
+		#define eeprom_busy_wait()                         do { } while (0)
+
+		#define eeprom_read_byte(Address)                  (*(const uint8_t*)(Address))
+		#define eeprom_read_word(Address)                  (*(const uint16_t*)(Address))
+		#define eeprom_read_dword(Address)                 (*(const uint32_t*)(Address))
+		#define eeprom_read_block(Destination, Source, Size)  memcpy((Destination), (Source), (Size))
+
+		#define eeprom_write_byte(Address, Value)          (*(uint8_t*)(Address) = (Value))
+		#define eeprom_write_word(Address, Value)          (*(uint16_t*)(Address) = (Value))
+		#define eeprom_write_dword(Address, Value)         (*(uint32_t*)(Address) = (Value))
+		#define eeprom_write_block(Source, Destination, Size) memcpy((Destination), (Source), (Size))
+
+		#define eeprom_update_byte(Address, Value)         eeprom_write_byte(Address, Value)
+		#define eeprom_update_word(Address, Value)         eeprom_write_word(Address, Value)
+		#define eeprom_update_dword(Address, Value)        eeprom_write_dword(Address, Value)
+		#define eeprom_update_block(Source, Destination, Size) eeprom_write_block(Source, Destination, Size)
+
+#endif
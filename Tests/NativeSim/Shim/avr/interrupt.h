@@ -0,0 +1,58 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc interrupt header. The global interrupt flag is the I bit of the simulated \c SREG,
+ *  so that enabling interrupts traps into the simulator like any other register access, and lets it run the ISRs
+ *  left pending. Each ISR is a plain function named after its vector number, called by the simulator.
+ */
+
+#ifndef __SIM_AVR_INTERRUPT_H__
+#define __SIM_AVR_INTERRUPT_H__
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Macros: */
+		#define sei()                    do { SREG |= (1 << SREG_I); } while (0)
+		#define cli()                    do { SREG &= ~(1 << SREG_I); } while (0)
+		#define reti()                   return
+
+		#define ISR(Vector, ...)         void Vector(void); void Vector(void)
+		#define EMPTY_INTERRUPT(Vector)  void Vector(void); void Vector(void) { }
+		#define ISR_ALIAS(Vector, Target) void Vector(void) { Target(); }
+
+		#define ISR_BLOCK
+		#define ISR_NOBLOCK
+		#define ISR_NAKED
+		#define ISR_ALIASOF(Target)
+
+#endif
@@ -0,0 +1,362 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc register header of the ATmega32U4, covering the registers used by the
+ *  application and the LUFA device core. Each register is a location in a page of host memory standing in for the
+ *  AVR data space, which the simulator keeps inaccessible so that every register access traps into its register
+ *  model, see Sim.c. The rest of the page stands in for the SRAM, for the few absolute data space accesses
+ *  made through \ref _MMIO_WORD().
+ */
+
+#ifndef __SIM_AVR_IO_H__
+#define __SIM_AVR_IO_H__
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Macros: */
+		/** Host address of the simulated AVR data space, mapped by the simulator. */
+		#define SIM_DATA_SPACE_ADDRESS   0x20000000UL
+
+		/** Size of the simulated AVR data space, covering the registers and the SRAM. */
+		#define SIM_DATA_SPACE_SIZE      0x1000
+
+		#define _MMIO_BYTE(Address)      (*(volatile uint8_t*)(SIM_DATA_SPACE_ADDRESS + (Address)))
+		#define _MMIO_WORD(Address)      (*(volatile uint16_t*)(SIM_DATA_SPACE_ADDRESS + (Address)))
+
+		#define __SFR_OFFSET             0x20
+		#define _SFR_MEM8(Address)       _MMIO_BYTE(Address)
+		#define _SFR_MEM16(Address)      _MMIO_WORD(Address)
+		#define _SFR_IO8(Address)        _MMIO_BYTE((Address) + __SFR_OFFSET)
+		#define _SFR_IO16(Address)       _MMIO_WORD((Address) + __SFR_OFFSET)
+		#define _SFR_MEM_ADDR(Register)  ((uint16_t)((uintptr_t)&(Register) - SIM_DATA_SPACE_ADDRESS))
+		#define _SFR_IO_ADDR(Register)   (_SFR_MEM_ADDR(Register) - __SFR_OFFSET)
+		#define _SFR_BYTE(Register)      (Register)
+		#define _BV(Bit)                 (1 << (Bit))
+
+		#define bit_is_set(Register, Bit)   (_SFR_BYTE(Register) & _BV(Bit))
+		#define bit_is_clear(Register, Bit) (!(_SFR_BYTE(Register) & _BV(Bit)))
+
+		#define _VECTOR(N)               __vector_ ## N
+
+		#define RAMSTART                 0x0100
+		#define RAMEND                   0x0AFF
+		#define FLASHEND                 0x7FFF
+		#define E2END                    0x03FF
+		#define SPM_PAGESIZE             128
+
+		/* Ports */
+		#define PINB                     _SFR_IO8(0x03)
+		#define DDRB                     _SFR_IO8(0x04)
+		#define PORTB                    _SFR_IO8(0x05)
+		#define PINC                     _SFR_IO8(0x06)
+		#define DDRC                     _SFR_IO8(0x07)
+		#define PORTC                    _SFR_IO8(0x08)
+		#define PIND                     _SFR_IO8(0x09)
+		#define DDRD                     _SFR_IO8(0x0A)
+		#define PORTD                    _SFR_IO8(0x0B)
+		#define PINE                     _SFR_IO8(0x0C)
+		#define DDRE                     _SFR_IO8(0x0D)
+		#define PORTE                    _SFR_IO8(0x0E)
+		#define PINF                     _SFR_IO8(0x0F)
+		#define DDRF                     _SFR_IO8(0x10)
+		#define PORTF                    _SFR_IO8(0x11)
+
+		/* Timer 1 interrupt flags and mask */
+		#define TIFR1                    _SFR_IO8(0x16)
+		#define ICF1                     5
+		#define OCF1C                    3
+		#define OCF1B                    2
+		#define OCF1A                    1
+		#define TOV1                     0
+
+		#define TIMSK1                   _SFR_MEM8(0x6F)
+		#define ICIE1                    5
+		#define OCIE1C                   3
+		#define OCIE1B                   2
+		#define OCIE1A                   1
+		#define TOIE1                    0
+
+		/* General purpose I/O registers */
+		#define GPIOR0                   _SFR_IO8(0x1E)
+		#define GPIOR1                   _SFR_IO8(0x2A)
+		#define GPIOR2                   _SFR_IO8(0x2B)
+
+		/* PLL */
+		#define PLLCSR                   _SFR_IO8(0x29)
+		#define PINDIV                   4
+		#define PLLE                     1
+		#define PLOCK                    0
+
+		#define PLLFRQ                   _SFR_IO8(0x32)
+		#define PINMUX                   7
+		#define PLLUSB                   6
+		#define PLLTM1                   5
+		#define PLLTM0                   4
+		#define PDIV3                    3
+		#define PDIV2                    2
+		#define PDIV1                    1
+		#define PDIV0                    0
+
+		/* System control */
+		#define MCUSR                    _SFR_IO8(0x34)
+		#define JTRF                     4
+		#define WDRF                     3
+		#define BORF                     2
+		#define EXTRF                    1
+		#define PORF                     0
+
+		#define MCUCR                    _SFR_IO8(0x35)
+		#define JTD                      7
+		#define PUD                      4
+		#define IVSEL                    1
+		#define IVCE                     0
+
+		#define SREG                     _SFR_IO8(0x3F)
+		#define SREG_I                   7
+
+		#define WDTCSR                   _SFR_MEM8(0x60)
+		#define CLKPR                    _SFR_MEM8(0x61)
+		#define PRR0                     _SFR_MEM8(0x64)
+		#define PRR1                     _SFR_MEM8(0x65)
+
+		/* Timer 1 */
+		#define TCCR1A                   _SFR_MEM8(0x80)
+		#define COM1A1                   7
+		#define COM1A0                   6
+		#define COM1B1                   5
+		#define COM1B0                   4
+		#define COM1C1                   3
+		#define COM1C0                   2
+		#define WGM11                    1
+		#define WGM10                    0
+
+		#define TCCR1B                   _SFR_MEM8(0x81)
+		#define ICNC1                    7
+		#define ICES1                    6
+		#define WGM13                    4
+		#define WGM12                    3
+		#define CS12                     2
+		#define CS11                     1
+		#define CS10                     0
+
+		#define TCCR1C                   _SFR_MEM8(0x82)
+		#define TCNT1                    _SFR_MEM16(0x84)
+		#define TCNT1L                   _SFR_MEM8(0x84)
+		#define TCNT1H                   _SFR_MEM8(0x85)
+		#define ICR1                     _SFR_MEM16(0x86)
+		#define OCR1A                    _SFR_MEM16(0x88)
+		#define OCR1AL                   _SFR_MEM8(0x88)
+		#define OCR1AH                   _SFR_MEM8(0x89)
+		#define OCR1B                    _SFR_MEM16(0x8A)
+		#define OCR1BL                   _SFR_MEM8(0x8A)
+		#define OCR1BH                   _SFR_MEM8(0x8B)
+		#define OCR1C                    _SFR_MEM16(0x8C)
+
+		/* USART 1 */
+		#define UCSR1A                   _SFR_MEM8(0xC8)
+		#define RXC1                     7
+		#define TXC1                     6
+		#define UDRE1                    5
+		#define FE1                      4
+		#define DOR1                     3
+		#define UPE1                     2
+		#define U2X1                     1
+		#define MPCM1                    0
+
+		#define UCSR1B                   _SFR_MEM8(0xC9)
+		#define RXCIE1                   7
+		#define TXCIE1                   6
+		#define UDRIE1                   5
+		#define RXEN1                    4
+		#define TXEN1                    3
+		#define UCSZ12                   2
+		#define RXB81                    1
+		#define TXB81                    0
+
+		#define UCSR1C                   _SFR_MEM8(0xCA)
+		#define UMSEL11                  7
+		#define UMSEL10                  6
+		#define UPM11                    5
+		#define UPM10                    4
+		#define USBS1                    3
+		#define UCSZ11                   2
+		#define UCSZ10                   1
+		#define UCPOL1                   0
+
+		#define UCSR1D                   _SFR_MEM8(0xCB)
+		#define CTSEN                    1
+		#define RTSEN                    0
+
+		#define UBRR1                    _SFR_MEM16(0xCC)
+		#define UBRR1L                   _SFR_MEM8(0xCC)
+		#define UBRR1H                   _SFR_MEM8(0xCD)
+		#define UDR1                     _SFR_MEM8(0xCE)
+
+		/* USB general */
+		#define UHWCON                   _SFR_MEM8(0xD7)
+		#define UVREGE                   0
+
+		#define USBCON                   _SFR_MEM8(0xD8)
+		#define USBE                     7
+		#define FRZCLK                   5
+		#define OTGPADE                  4
+		#define VBUSTE                   0
+
+		#define USBSTA                   _SFR_MEM8(0xD9)
+		#define SPEED                    3
+		#define ID                       1
+		#define VBUS                     0
+
+		#define USBINT                   _SFR_MEM8(0xDA)
+		#define VBUSTI                   0
+
+		/* USB device */
+		#define UDCON                    _SFR_MEM8(0xE0)
+		#define RSTCPU                   3
+		#define LSM                      2
+		#define RMWKUP                   1
+		#define DETACH                   0
+
+		#define UDINT                    _SFR_MEM8(0xE1)
+		#define UPRSMI                   6
+		#define EORSMI                   5
+		#define WAKEUPI                  4
+		#define EORSTI                   3
+		#define SOFI                     2
+		#define SUSPI                    0
+
+		#define UDIEN                    _SFR_MEM8(0xE2)
+		#define UPRSME                   6
+		#define EORSME                   5
+		#define WAKEUPE                  4
+		#define EORSTE                   3
+		#define SOFE                     2
+		#define SUSPE                    0
+
+		#define UDADDR                   _SFR_MEM8(0xE3)
+		#define ADDEN                    7
+
+		#define UDFNUM                   _SFR_MEM16(0xE4)
+		#define UDFNUML                  _SFR_MEM8(0xE4)
+		#define UDFNUMH                  _SFR_MEM8(0xE5)
+
+		#define UDMFN                    _SFR_MEM8(0xE6)
+		#define FNCERR                   4
+
+		/* USB device endpoints, each register but UENUM, UERST and UEINT applying to the selected endpoint */
+		#define UEINTX                   _SFR_MEM8(0xE8)
+		#define FIFOCON                  7
+		#define NAKINI                   6
+		#define RWAL                     5
+		#define NAKOUTI                  4
+		#define RXSTPI                   3
+		#define RXOUTI                   2
+		#define KILLBK                   2
+		#define STALLEDI                 1
+		#define TXINI                    0
+
+		#define UENUM                    _SFR_MEM8(0xE9)
+
+		#define UERST                    _SFR_MEM8(0xEA)
+
+		#define UECONX                   _SFR_MEM8(0xEB)
+		#define STALLRQ                  5
+		#define STALLRQC                 4
+		#define RSTDT                    3
+		#define EPEN                     0
+
+		#define UECFG0X                  _SFR_MEM8(0xEC)
+		#define EPTYPE1                  7
+		#define EPTYPE0                  6
+		#define EPDIR                    0
+
+		#define UECFG1X                  _SFR_MEM8(0xED)
+		#define EPSIZE2                  6
+		#define EPSIZE1                  5
+		#define EPSIZE0                  4
+		#define EPBK1                    3
+		#define EPBK0                    2
+		#define ALLOC                    1
+
+		#define UESTA0X                  _SFR_MEM8(0xEE)
+		#define CFGOK                    7
+		#define OVERFI                   6
+		#define UNDERFI                  5
+		#define DTSEQ1                   3
+		#define DTSEQ0                   2
+		#define NBUSYBK1                 1
+		#define NBUSYBK0                 0
+
+		#define UESTA1X                  _SFR_MEM8(0xEF)
+		#define CTRLDIR                  2
+		#define CURRBK1                  1
+		#define CURRBK0                  0
+
+		#define UEIENX                   _SFR_MEM8(0xF0)
+		#define FLERRE                   7
+		#define NAKINE                   6
+		#define NAKOUTE                  4
+		#define RXSTPE                   3
+		#define RXOUTE                   2
+		#define STALLEDE                 1
+		#define TXINE                    0
+
+		#define UEDATX                   _SFR_MEM8(0xF1)
+		#define UEBCLX                   _SFR_MEM8(0xF2)
+		#define UEBCHX                   _SFR_MEM8(0xF3)
+		#define UEINT                    _SFR_MEM8(0xF4)
+
+		/* Interrupt vectors, numbered as on the ATmega32U4 */
+		#define INT0_vect                _VECTOR(1)
+		#define INT1_vect                _VECTOR(2)
+		#define INT2_vect                _VECTOR(3)
+		#define INT3_vect                _VECTOR(4)
+		#define INT6_vect                _VECTOR(7)
+		#define PCINT0_vect              _VECTOR(9)
+		#define USB_GEN_vect             _VECTOR(10)
+		#define USB_COM_vect             _VECTOR(11)
+		#define WDT_vect                 _VECTOR(12)
+		#define TIMER1_CAPT_vect         _VECTOR(16)
+		#define TIMER1_COMPA_vect        _VECTOR(17)
+		#define TIMER1_COMPB_vect        _VECTOR(18)
+		#define TIMER1_COMPC_vect        _VECTOR(19)
+		#define TIMER1_OVF_vect          _VECTOR(20)
+		#define TIMER0_COMPA_vect        _VECTOR(21)
+		#define TIMER0_COMPB_vect        _VECTOR(22)
+		#define TIMER0_OVF_vect          _VECTOR(23)
+		#define USART1_RX_vect           _VECTOR(25)
+		#define USART1_UDRE_vect         _VECTOR(26)
+		#define USART1_TX_vect           _VECTOR(27)
+		#define _VECTORS_SIZE            (43 * 4)
+
+#endif
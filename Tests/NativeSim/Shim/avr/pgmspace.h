@@ -0,0 +1,72 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc program space header. Data placed in flash is an ordinary constant on the host,
+ *  read through plain pointers. Absolute flash addresses given as integers, such as the bootloader signature
+ *  location, read as erased flash since only the application is loaded.
+ */
+
+#ifndef __SIM_AVR_PGMSPACE_H__
+#define __SIM_AVR_PGMSPACE_H__
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <string.h>
+
+		#include <avr/io.h>
+
+	/* Macros: */
+		#define PROGMEM
+		#define PGM_P                        const char*
+		#define PSTR(String)                 (String)
+
+		#define pgm_read_byte(Address)       (*(const uint8_t*)(Address))
+		#define pgm_read_word(Address)       Sim_ReadFlashWord((uintptr_t)(Address))
+		#define pgm_read_dword(Address)      (*(const uint32_t*)(Address))
+		#undef  pgm_read_ptr
+		#define pgm_read_ptr(Address)        (*(void* const*)(Address))
+
+		#define memcpy_P(...)                memcpy(__VA_ARGS__)
+		#define memcmp_P(...)                memcmp(__VA_ARGS__)
+		#define strlen_P(...)                strlen(__VA_ARGS__)
+		#define strcpy_P(...)                strcpy(__VA_ARGS__)
+
+	/* Inline Functions: */
+		static inline uint16_t Sim_ReadFlashWord(const uintptr_t Address)
+		{
+			if (Address <= FLASHEND)
+			  return 0xFFFF;
+
+			return *(const uint16_t*)Address;
+		}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc power management header. The simulated device always runs at \c F_CPU with all
+ *  of its modelled peripherals powered.
+ */
+
+#ifndef __SIM_AVR_POWER_H__
+#define __SIM_AVR_POWER_H__
+
+	/* Enums: */
+		typedef enum
+		{
+			clock_div_1   = 0,
+			clock_div_2   = 1,
+			clock_div_4   = 2,
+			clock_div_8   = 3,
+			clock_div_16  = 4,
+			clock_div_32  = 5,
+			clock_div_64  = 6,
+			clock_div_128 = 7,
+			clock_div_256 = 8,
+		} clock_div_t;
+
+	/* Macros: */
+		#define clock_prescale_set(Divider) do { (void)(Divider); } while (0)
+		#define clock_prescale_get()        clock_div_1
+
+#endif
@@ -0,0 +1,56 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc watchdog header. The simulated device has no watchdog, so a watchdog reset
+ *  requested by the application never happens.
+ */
+
+#ifndef __SIM_AVR_WDT_H__
+#define __SIM_AVR_WDT_H__
+
+	/* Macros: */
+		#define WDTO_15MS                0
+		#define WDTO_30MS                1
+		#define WDTO_60MS                2
+		#define WDTO_120MS               3
+		#define WDTO_250MS               4
+		#define WDTO_500MS               5
+		#define WDTO_1S                  6
+		#define WDTO_2S                  7
+		#define WDTO_4S                  8
+		#define WDTO_8S                  9
+
+		#define wdt_enable(Timeout)      do { (void)(Timeout); } while (0)
+		#define wdt_disable()            do { } while (0)
+		#define wdt_reset()              do { } while (0)
+
+#endif
@@ -0,0 +1,57 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for the avr-libc busy-wait delay header. A delay advances the simulated clock by the number of
+ *  cycles it would take on the device, running any interrupts which become due along the way.
+ */
+
+#ifndef __SIM_UTIL_DELAY_H__
+#define __SIM_UTIL_DELAY_H__
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Function Prototypes: */
+		void Sim_Delay(const uint32_t Cycles);
+
+	/* Inline Functions: */
+		static inline void _delay_us(const double Microseconds)
+		{
+			Sim_Delay((uint32_t)(Microseconds * (F_CPU / 1000000.0)));
+		}
+
+		static inline void _delay_ms(const double Milliseconds)
+		{
+			Sim_Delay((uint32_t)(Milliseconds * (F_CPU / 1000.0)));
+		}
+
+#endif
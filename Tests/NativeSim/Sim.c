@@ -0,0 +1,449 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Core of the native simulation of the ATmega32U4: the data space, the simulated clock and the interrupt
+ *  controller. The firmware runs natively, and every access it makes to a register is trapped: the page standing
+ *  in for the data space is kept inaccessible, so that the access faults, the register model supplies the value
+ *  to be read and the faulting instruction is then single stepped with the page opened up, after which the value
+ *  written is handed to the register model and the page is closed again. The x86 page fault error code tells
+ *  reads and writes apart, read-modify-write instructions being reported as writes.
+ *
+ *  Each access advances the simulated clock by a fixed number of cycles, standing in for the code run between two
+ *  accesses, and steps the peripheral models. Pending interrupts are then serviced at that instruction boundary by
+ *  calling the ISR from the trap handler, with the I flag of \c SREG cleared as the AVR would, so that the ISR in
+ *  turn runs with its own register accesses trapped. The firmware is stopped by jumping out of the trap handler
+ *  once the simulation is over.
+ */
+
+#define _GNU_SOURCE
+
+#include <setjmp.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+
+#include "Sim.h"
+
+#if !defined(__x86_64__) || !defined(__linux__)
+	#error The native simulation traps register accesses with x86-64 Linux page faults and single stepping.
+#endif
+
+/** Page fault error code bit set for write accesses, including read-modify-write instructions. */
+#define SIM_PAGE_FAULT_WRITE      (1 << 1)
+
+/** x86 trap flag, single stepping the thread while set. */
+#define SIM_EFLAGS_TF             (1 << 8)
+
+/** Number of bytes from the faulting address a single instruction may access, for 16-bit and 32-bit accesses. */
+#define SIM_ACCESS_SPAN           4
+
+/** Largest number of models and interrupt sources which can be registered. */
+#define SIM_MAX_MODELS            8
+#define SIM_MAX_INTERRUPTS        16
+
+/** Largest number of cycles a delay advances the clock at once, before checking for interrupts. */
+#define SIM_DELAY_STEP_CYCLES     16
+
+/** Type define for a register of the simulated data space, with the handlers of its model. */
+typedef struct
+{
+	Sim_ReadHandler_t  Read;
+	Sim_WriteHandler_t Write;
+} Sim_Register_t;
+
+/** Type define for an interrupt source, and the vector it requests. */
+typedef struct
+{
+	uint8_t            Vector;
+	Sim_PendingCheck_t IsPending;
+	Sim_Acknowledge_t  Acknowledge;
+} Sim_Interrupt_t;
+
+/* The ISRs are named after their vector numbers, and are left unresolved where the firmware defines none */
+#define SIM_DECLARE_VECTOR(N) extern void __vector_ ## N(void) __attribute__((weak));
+#define SIM_VECTOR_ENTRY(N)   [N] = __vector_ ## N,
+#define SIM_FOR_EACH_VECTOR(X) \
+	X(1)  X(2)  X(3)  X(4)  X(5)  X(6)  X(7)  X(8)  X(9)  X(10) X(11) X(12) X(13) X(14) \
+	X(15) X(16) X(17) X(18) X(19) X(20) X(21) X(22) X(23) X(24) X(25) X(26) X(27) X(28) \
+	X(29) X(30) X(31) X(32) X(33) X(34) X(35) X(36) X(37) X(38) X(39) X(40) X(41) X(42)
+
+SIM_FOR_EACH_VECTOR(SIM_DECLARE_VECTOR)
+
+static void (*const Sim_Vectors[SIM_VECTOR_COUNT])(void) = { SIM_FOR_EACH_VECTOR(SIM_VECTOR_ENTRY) };
+
+/** Current time of the simulated clock, in CPU cycles. */
+uint64_t Sim_Cycles;
+
+/** Number of register accesses trapped and ISRs run so far. */
+uint64_t Sim_Accesses;
+uint64_t Sim_Interrupts;
+
+/** Number of times each ISR has run, and the CPU cycles spent in it, leaving out those of the ISRs nested into it. */
+uint64_t Sim_VectorRuns[SIM_VECTOR_COUNT];
+uint64_t Sim_VectorCycles[SIM_VECTOR_COUNT];
+
+/** Number of CPU cycles charged for each register access. */
+uint32_t Sim_AccessCycles = SIM_DEFAULT_ACCESS_CYCLES;
+
+/** Values of the registers without a read handler, and of the SRAM. */
+uint8_t Sim_Storage[SIM_DATA_SPACE_SIZE];
+
+static volatile uint8_t* const Sim_DataSpace = (volatile uint8_t*)SIM_DATA_SPACE_ADDRESS;
+
+static Sim_Register_t      Sim_Registers[SIM_DATA_SPACE_SIZE];
+static Sim_Interrupt_t     Sim_InterruptSources[SIM_MAX_INTERRUPTS];
+static uint8_t             Sim_InterruptCount;
+static Sim_UpdateHandler_t Sim_Models[SIM_MAX_MODELS];
+static uint8_t             Sim_ModelCount;
+
+/** CPU cycles spent in the ISRs nested into the one currently running. */
+static uint64_t            Sim_NestedCycles;
+
+/** Access being single stepped, with the values given to the faulting instruction. */
+static struct
+{
+	uint16_t Address;
+	bool     IsWrite;
+	uint8_t  Before[SIM_ACCESS_SPAN];
+} Sim_Access;
+
+static sigjmp_buf Sim_StopPoint;
+static bool       Sim_Running;
+static bool       Sim_StopRequested;
+
+/** Opens up or closes the page standing in for the data space.
+ *
+ *  \param[in] Accessible  Whether the firmware may access the page without trapping.
+ */
+static void Sim_SetDataSpaceAccess(const bool Accessible)
+{
+	if (mprotect((void*)Sim_DataSpace, SIM_DATA_SPACE_SIZE, Accessible ? (PROT_READ | PROT_WRITE) : PROT_NONE))
+	  Sim_Fail("Unable to change the data space protection");
+}
+
+/** Reads a register through its model.
+ *
+ *  \param[in] Address  Offset of the register in the data space.
+ *  \param[in] Peek     When set, the value is only looked at, without the side effects of a read.
+ *
+ *  \return Value of the register.
+ */
+static uint8_t Sim_ReadRegister(const uint16_t Address,
+                                const bool Peek)
+{
+	if (Sim_Registers[Address].Read)
+	  return Sim_Registers[Address].Read(Peek);
+
+	return Sim_Storage[Address];
+}
+
+/** Writes a register through its model.
+ *
+ *  \param[in] Address  Offset of the register in the data space.
+ *  \param[in] Value    Value written to the register.
+ */
+static void Sim_WriteRegister(const uint16_t Address,
+                              const uint8_t Value)
+{
+	if (Sim_Registers[Address].Write)
+	  Sim_Registers[Address].Write(Value);
+	else
+	  Sim_Storage[Address] = Value;
+}
+
+/** Stops the firmware if the simulation is over, returning to \ref Sim_Run(). */
+static void Sim_CheckStop(void)
+{
+	if (!(Sim_StopRequested))
+	  return;
+
+	Sim_Running = false;
+	siglongjmp(Sim_StopPoint, 1);
+}
+
+/** Runs the ISRs of the pending interrupt sources while the I flag is set, the lowest vector first. An ISR which
+ *  sets the I flag again is itself interrupted from its next register access on, as on the AVR.
+ */
+static void Sim_ServiceInterrupts(void)
+{
+	while (Sim_Storage[SIM_ADDRESS(SREG)] & (1 << SREG_I))
+	{
+		const Sim_Interrupt_t* Source = NULL;
+
+		for (uint8_t i = 0; i < Sim_InterruptCount; i++)
+		{
+			if ((!(Source) || (Sim_InterruptSources[i].Vector < Source->Vector)) && Sim_InterruptSources[i].IsPending())
+			  Source = &Sim_InterruptSources[i];
+		}
+
+		if (!(Source))
+		  break;
+
+		if (!(Sim_Vectors[Source->Vector]))
+		  Sim_Fail("Interrupt vector %u enabled without an ISR", Source->Vector);
+
+		Sim_Storage[SIM_ADDRESS(SREG)] &= ~(1 << SREG_I);
+
+		if (Source->Acknowledge)
+		  Source->Acknowledge();
+
+		uint64_t Start       = Sim_Cycles;
+		uint64_t OuterNested = Sim_NestedCycles;
+
+		Sim_NestedCycles = 0;
+
+		Sim_Interrupts++;
+		Sim_Advance(SIM_INTERRUPT_CYCLES);
+
+		Sim_Vectors[Source->Vector]();
+
+		uint64_t Elapsed = (Sim_Cycles - Start);
+
+		Sim_VectorRuns[Source->Vector]++;
+		Sim_VectorCycles[Source->Vector] += (Elapsed - Sim_NestedCycles);
+		Sim_NestedCycles = (OuterNested + Elapsed);
+
+		Sim_Storage[SIM_ADDRESS(SREG)] |= (1 << SREG_I);
+	}
+}
+
+/** Handler for the page faults of the firmware's register accesses, giving the faulting instruction the values it
+ *  reads and arming the single step which completes the access.
+ */
+static void Sim_AccessFault(int Signal,
+                            siginfo_t* Info,
+                            void* Context)
+{
+	ucontext_t* UserContext = Context;
+	uintptr_t   Offset      = ((uintptr_t)Info->si_addr - SIM_DATA_SPACE_ADDRESS);
+
+	/* A fault outside of the data space is a genuine crash, raised again with the default action on return */
+	if (!(Sim_Running) || (Offset >= SIM_DATA_SPACE_SIZE))
+	{
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+
+	Sim_Accesses++;
+	Sim_Advance(Sim_AccessCycles);
+
+	Sim_Access.Address = Offset;
+	Sim_Access.IsWrite = ((UserContext->uc_mcontext.gregs[REG_ERR] & SIM_PAGE_FAULT_WRITE) != 0);
+
+	Sim_SetDataSpaceAccess(true);
+
+	for (uint8_t i = 0; (i < SIM_ACCESS_SPAN) && ((Offset + i) < SIM_DATA_SPACE_SIZE); i++)
+	{
+		bool Peek = (i || Sim_Access.IsWrite);
+
+		Sim_Access.Before[i]       = Sim_ReadRegister(Offset + i, Peek);
+		Sim_DataSpace[Offset + i]  = Sim_Access.Before[i];
+	}
+
+	UserContext->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+/** Handler for the single step trap raised once the faulting instruction has completed, passing on the values it
+ *  wrote and servicing the interrupts which have become pending.
+ */
+static void Sim_AccessStep(int Signal,
+                           siginfo_t* Info,
+                           void* Context)
+{
+	ucontext_t* UserContext = Context;
+	uint16_t    Offset      = Sim_Access.Address;
+
+	UserContext->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+
+	if (Sim_Access.IsWrite)
+	{
+		/* The upper bytes of a wider access are only known to be written when they changed; they are passed on
+		 * first, so that the low byte of a 16-bit register commits the whole value as through the AVR's TEMP
+		 * register */
+		for (uint8_t i = (SIM_ACCESS_SPAN - 1); i > 0; i--)
+		{
+			if (((Offset + i) < SIM_DATA_SPACE_SIZE) && (Sim_DataSpace[Offset + i] != Sim_Access.Before[i]))
+			  Sim_WriteRegister(Offset + i, Sim_DataSpace[Offset + i]);
+		}
+
+		Sim_WriteRegister(Offset, Sim_DataSpace[Offset]);
+	}
+
+	Sim_SetDataSpaceAccess(false);
+
+	Sim_ServiceInterrupts();
+	Sim_CheckStop();
+}
+
+/** Maps the data space and installs the trap handlers. */
+void Sim_Init(void)
+{
+	void* DataSpace = mmap((void*)Sim_DataSpace, SIM_DATA_SPACE_SIZE, PROT_READ | PROT_WRITE,
+	                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if (DataSpace != (void*)Sim_DataSpace)
+	  Sim_Fail("Unable to map the data space at %#lx", SIM_DATA_SPACE_ADDRESS);
+
+	/* ISRs are run from the trap handlers, whose own register accesses must trap in turn */
+	struct sigaction Action = { .sa_flags = (SA_SIGINFO | SA_NODEFER) };
+	sigemptyset(&Action.sa_mask);
+
+	Action.sa_sigaction = Sim_AccessFault;
+	sigaction(SIGSEGV, &Action, NULL);
+
+	Action.sa_sigaction = Sim_AccessStep;
+	sigaction(SIGTRAP, &Action, NULL);
+}
+
+/** Attaches a model to a register. A register without handlers is a plain storage location.
+ *
+ *  \param[in] Register      Register to attach the model to.
+ *  \param[in] ReadHandler   Handler supplying the value read, or \c NULL to read the stored value.
+ *  \param[in] WriteHandler  Handler taking the value written, or \c NULL to store it.
+ */
+void Sim_MapRegister(volatile uint8_t* const Register,
+                     const Sim_ReadHandler_t ReadHandler,
+                     const Sim_WriteHandler_t WriteHandler)
+{
+	uint16_t Address = ((uintptr_t)Register - SIM_DATA_SPACE_ADDRESS);
+
+	Sim_Registers[Address].Read  = ReadHandler;
+	Sim_Registers[Address].Write = WriteHandler;
+}
+
+/** Registers an interrupt source.
+ *
+ *  \param[in] Vector       Number of the vector requested by the source.
+ *  \param[in] IsPending    Check of whether the source is enabled and its flag set.
+ *  \param[in] Acknowledge  Action of the source when its vector is executed, such as clearing its flag, or \c NULL.
+ */
+void Sim_AddInterrupt(const uint8_t Vector,
+                      const Sim_PendingCheck_t IsPending,
+                      const Sim_Acknowledge_t Acknowledge)
+{
+	if (Sim_InterruptCount == SIM_MAX_INTERRUPTS)
+	  Sim_Fail("Too many interrupt sources");
+
+	Sim_InterruptSources[Sim_InterruptCount++] = (Sim_Interrupt_t)
+		{
+			.Vector      = Vector,
+			.IsPending   = IsPending,
+			.Acknowledge = Acknowledge,
+		};
+}
+
+/** Registers a model to be stepped each time the simulated clock advances.
+ *
+ *  \param[in] Update  Handler bringing the model up to the current time.
+ */
+void Sim_AddModel(const Sim_UpdateHandler_t Update)
+{
+	if (Sim_ModelCount == SIM_MAX_MODELS)
+	  Sim_Fail("Too many models");
+
+	Sim_Models[Sim_ModelCount++] = Update;
+}
+
+/** Advances the simulated clock, bringing each model up to the new time.
+ *
+ *  \param[in] Cycles  Number of CPU cycles to advance the clock by.
+ */
+void Sim_Advance(const uint32_t Cycles)
+{
+	Sim_Cycles += Cycles;
+
+	for (uint8_t i = 0; i < Sim_ModelCount; i++)
+	  Sim_Models[i]();
+}
+
+/** Busy waits for the given number of cycles on behalf of the firmware, servicing interrupts along the way.
+ *
+ *  \param[in] Cycles  Number of CPU cycles to wait for.
+ */
+void Sim_Delay(const uint32_t Cycles)
+{
+	for (uint32_t Remaining = Cycles; Remaining; )
+	{
+		uint32_t Step = (Remaining < SIM_DELAY_STEP_CYCLES) ? Remaining : SIM_DELAY_STEP_CYCLES;
+
+		Sim_Advance(Step);
+		Remaining -= Step;
+
+		Sim_ServiceInterrupts();
+		Sim_CheckStop();
+	}
+}
+
+/** Runs the firmware with its register accesses trapped, until \ref Sim_Stop() is called by a model.
+ *
+ *  \param[in] Firmware  Entry point of the firmware.
+ */
+void Sim_Run(int (*const Firmware)(void))
+{
+	/* Registers read as zero after reset unless stored otherwise by a model */
+	if (!(sigsetjmp(Sim_StopPoint, 1)))
+	{
+		Sim_Running = true;
+		Sim_SetDataSpaceAccess(false);
+
+		Firmware();
+		Sim_Fail("Firmware returned from its main loop");
+	}
+
+	Sim_SetDataSpaceAccess(true);
+}
+
+/** Requests the firmware to be stopped at its next register access. */
+void Sim_Stop(void)
+{
+	Sim_StopRequested = true;
+}
+
+/** Aborts the simulation with an error message.
+ *
+ *  \param[in] Format  printf() style format of the message, followed by its arguments.
+ */
+void Sim_Fail(const char* const Format, ...)
+{
+	va_list Arguments;
+	va_start(Arguments, Format);
+
+	fprintf(stderr, "Simulation failed at %.3f ms: ", (double)Sim_Cycles / (SIM_CYCLES_PER_US * 1000));
+	vfprintf(stderr, Format, Arguments);
+	fputc('\n', stderr);
+
+	va_end(Arguments);
+	exit(EXIT_FAILURE);
+}
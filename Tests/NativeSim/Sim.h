@@ -0,0 +1,123 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for Sim.c.
+ */
+
+#ifndef _SIM_H_
+#define _SIM_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+		#include <stddef.h>
+
+		#include <avr/io.h>
+
+	/* Macros: */
+		/** Number of simulated CPU cycles in one microsecond. */
+		#define SIM_CYCLES_PER_US         (F_CPU / 1000000UL)
+
+		/** Converts a duration in microseconds into simulated CPU cycles. */
+		#define SIM_US_TO_CYCLES(us)      ((uint64_t)(us) * SIM_CYCLES_PER_US)
+
+		/** Default number of CPU cycles charged for each register access, standing in for the instructions executed
+		 *  between two accesses.
+		 */
+		#define SIM_DEFAULT_ACCESS_CYCLES 10
+
+		/** Number of CPU cycles charged for entering and leaving an ISR, including the register save and restore. */
+		#define SIM_INTERRUPT_CYCLES      40
+
+		/** Number of interrupt vectors of the ATmega32U4, including the reset vector. */
+		#define SIM_VECTOR_COUNT          43
+
+		/** Numbers of the interrupt vectors of the modelled peripherals, as named by \ref _VECTOR(). */
+		#define SIM_VECTOR_USB_GEN        10
+		#define SIM_VECTOR_USB_COM        11
+		#define SIM_VECTOR_TIMER1_COMPA   17
+		#define SIM_VECTOR_TIMER1_COMPB   18
+		#define SIM_VECTOR_TIMER1_OVF     20
+		#define SIM_VECTOR_USART1_RX      25
+		#define SIM_VECTOR_USART1_UDRE    26
+		#define SIM_VECTOR_USART1_TX      27
+
+		/** Offset of the given register in the simulated data space. */
+		#define SIM_ADDRESS(Register)     _SFR_MEM_ADDR(Register)
+
+		/** Backing store of the given register, holding its value for registers without a read handler. */
+		#define SIM_STORAGE(Register)     Sim_Storage[SIM_ADDRESS(Register)]
+
+	/* Type Defines: */
+		/** Type define for a register read handler, returning the value read.
+		 *
+		 *  \param[in] Peek  When set, the value is only looked at, without the side effects of a read.
+		 */
+		typedef uint8_t (*Sim_ReadHandler_t)(const bool Peek);
+
+		/** Type define for a register write handler, storing the value written if needed. */
+		typedef void (*Sim_WriteHandler_t)(const uint8_t Value);
+
+		/** Type define for a check of whether an interrupt source is requesting its vector. */
+		typedef bool (*Sim_PendingCheck_t)(void);
+
+		/** Type define for the action taken by an interrupt source when its vector is executed. */
+		typedef void (*Sim_Acknowledge_t)(void);
+
+		/** Type define for a model stepped each time the simulated clock advances. */
+		typedef void (*Sim_UpdateHandler_t)(void);
+
+	/* External Variables: */
+		extern uint64_t Sim_Cycles;
+		extern uint64_t Sim_Accesses;
+		extern uint64_t Sim_Interrupts;
+		extern uint64_t Sim_VectorRuns[SIM_VECTOR_COUNT];
+		extern uint64_t Sim_VectorCycles[SIM_VECTOR_COUNT];
+		extern uint32_t Sim_AccessCycles;
+		extern uint8_t  Sim_Storage[SIM_DATA_SPACE_SIZE];
+
+	/* Function Prototypes: */
+		void Sim_Init(void);
+		void Sim_MapRegister(volatile uint8_t* const Register,
+		                     const Sim_ReadHandler_t ReadHandler,
+		                     const Sim_WriteHandler_t WriteHandler);
+		void Sim_AddInterrupt(const uint8_t Vector,
+		                      const Sim_PendingCheck_t IsPending,
+		                      const Sim_Acknowledge_t Acknowledge);
+		void Sim_AddModel(const Sim_UpdateHandler_t Update);
+		void Sim_Advance(const uint32_t Cycles);
+		void Sim_Delay(const uint32_t Cycles);
+		void Sim_Run(int (*const Firmware)(void));
+		void Sim_Stop(void);
+		void Sim_Fail(const char* const Format, ...) __attribute__((format(printf, 1, 2), noreturn));
+
+#endif
@@ -0,0 +1,352 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Test streams run through the bridge. The receiving side matches each byte against the position it expects next;
+ *  after a gap it looks ahead for the next run of \ref STREAM_MATCH_WINDOW bytes matching the stream, so that a
+ *  dropped byte is counted once and the bytes after it are still timed. A lone byte between two gaps is placed
+ *  ahead of the run found after it. Latencies are kept for every byte received and sorted once the run is over,
+ *  for the percentiles.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Stream.h"
+#include "Sim.h"
+
+/** Furthest a receiving side looks ahead for the next byte, past a gap of dropped bytes. */
+#define STREAM_MAX_GAP           65536
+
+/** Computes the byte at the given position of a stream, from Knuth's multiplicative hash of the position.
+ *
+ *  \param[in] Stream    Stream to compute the byte of.
+ *  \param[in] Position  Position of the byte in the stream.
+ *
+ *  \return Value of the byte.
+ */
+static uint8_t Stream_GetByte(const Stream_t* const Stream,
+                              const uint64_t Position)
+{
+	return (uint8_t)(((uint32_t)(Position + Stream->Seed) * 2654435761UL) >> 24);
+}
+
+/** Grows an array to hold at least the given number of elements, doubling its capacity.
+ *
+ *  \param[in,out] Array     Array to grow.
+ *  \param[in,out] Capacity  Number of elements the array can hold.
+ *  \param[in]     Needed    Number of elements needed.
+ *  \param[in]     Size      Size of each element.
+ */
+static void Stream_Reserve(void** const Array,
+                           size_t* const Capacity,
+                           const size_t Needed,
+                           const size_t Size)
+{
+	if (Needed <= *Capacity)
+	  return;
+
+	size_t NewCapacity = (*Capacity) ? *Capacity : 4096;
+
+	while (NewCapacity < Needed)
+	  NewCapacity *= 2;
+
+	void* NewArray = realloc(*Array, NewCapacity * Size);
+
+	if (!(NewArray))
+	  Sim_Fail("Out of memory for %zu stream entries", NewCapacity);
+
+	*Array    = NewArray;
+	*Capacity = NewCapacity;
+}
+
+/** Initializes a stream.
+ *
+ *  \param[out] Stream  Stream to initialize.
+ *  \param[in]  Name    Name of the stream, for the report.
+ *  \param[in]  Seed    Seed telling the stream apart from the one in the other direction.
+ */
+void Stream_Init(Stream_t* const Stream,
+                 const char* const Name,
+                 const uint32_t Seed)
+{
+	memset(Stream, 0, sizeof(Stream_t));
+
+	Stream->Name      = Name;
+	Stream->Seed      = Seed;
+	Stream->WindowEnd = UINT64_MAX;
+}
+
+/** Frees the arrays of a stream.
+ *
+ *  \param[in,out] Stream  Stream to free.
+ */
+void Stream_Free(Stream_t* const Stream)
+{
+	free(Stream->SentTimes);
+	free(Stream->Pending);
+	free(Stream->Latencies);
+}
+
+/** Generates the next bytes of a stream, to be sent. Their send time is set once they are actually sent.
+ *
+ *  \param[in,out] Stream  Stream to generate the bytes of.
+ *  \param[out]    Data    Buffer for the bytes.
+ *  \param[in]     Length  Number of bytes to generate.
+ *
+ *  \return Position of the first byte generated.
+ */
+uint64_t Stream_Generate(Stream_t* const Stream,
+                         uint8_t* const Data,
+                         const uint16_t Length)
+{
+	uint64_t First = Stream->Sent;
+
+	Stream_Reserve((void**)&Stream->SentTimes, &Stream->SentCapacity, (First + Length), sizeof(uint64_t));
+
+	for (uint16_t i = 0; i < Length; i++)
+	{
+		Data[i] = Stream_GetByte(Stream, First + i);
+		Stream->SentTimes[First + i] = UINT64_MAX;
+	}
+
+	Stream->Sent += Length;
+	return First;
+}
+
+/** Sets the time generated bytes were sent at.
+ *
+ *  \param[in,out] Stream  Stream the bytes belong to.
+ *  \param[in]     First   Position of the first byte sent.
+ *  \param[in]     Length  Number of bytes sent.
+ *  \param[in]     Time    Time the bytes were sent at, in cycles.
+ */
+void Stream_SetSentTime(Stream_t* const Stream,
+                        const uint64_t First,
+                        const uint16_t Length,
+                        const uint64_t Time)
+{
+	for (uint16_t i = 0; i < Length; i++)
+	  Stream->SentTimes[First + i] = Time;
+}
+
+/** Checks whether received bytes match the stream from the given position.
+ *
+ *  \param[in] Stream    Stream to check against.
+ *  \param[in] Arrivals  Received bytes to compare.
+ *  \param[in] Position  Position of the stream to compare the first received byte with.
+ *  \param[in] Count     Number of bytes to compare.
+ *
+ *  \return Boolean \c true if all bytes compared match, \c false otherwise.
+ */
+static bool Stream_Matches(const Stream_t* const Stream,
+                           const Stream_Arrival_t* const Arrivals,
+                           const uint64_t Position,
+                           const size_t Count)
+{
+	if ((Position + Count) > Stream->Sent)
+	  return false;
+
+	for (size_t i = 0; i < Count; i++)
+	{
+		if (Arrivals[i].Byte != Stream_GetByte(Stream, Position + i))
+		  return false;
+	}
+
+	return true;
+}
+
+/** Takes a received byte as the byte at the given position of the stream, timing it.
+ *
+ *  \param[in,out] Stream    Stream the byte belongs to.
+ *  \param[in]     Arrival   Received byte.
+ *  \param[in]     Position  Position of the byte in the stream.
+ */
+static void Stream_Accept(Stream_t* const Stream,
+                          const Stream_Arrival_t* const Arrival,
+                          const uint64_t Position)
+{
+	Stream->Missing += (Position - Stream->Expected);
+	Stream->Expected = (Position + 1);
+
+	Stream_Reserve((void**)&Stream->Latencies, &Stream->LatencyCapacity, (Stream->Received + 1), sizeof(uint32_t));
+
+	uint64_t SentTime = Stream->SentTimes[Position];
+	uint64_t Latency  = (Arrival->Time > SentTime) ? (Arrival->Time - SentTime) : 0;
+
+	Stream->Latencies[Stream->Received++] = (Latency > UINT32_MAX) ? UINT32_MAX : Latency;
+
+	if ((Arrival->Time >= Stream->WindowStart) && (Arrival->Time < Stream->WindowEnd))
+	  Stream->WindowBytes++;
+}
+
+/** Looks ahead in the stream for the first position from which the given received bytes all match, past any gap
+ *  of dropped bytes.
+ *
+ *  \param[in] Stream    Stream to search.
+ *  \param[in] Arrivals  Received bytes to find.
+ *  \param[in] Count     Number of bytes to find.
+ *  \param[in] First     First position to search from.
+ *
+ *  \return Position of the first matching run, or \c UINT64_MAX if none was found.
+ */
+static uint64_t Stream_Find(const Stream_t* const Stream,
+                            const Stream_Arrival_t* const Arrivals,
+                            const size_t Count,
+                            const uint64_t First)
+{
+	for (uint64_t Position = First; ((Position - First) < STREAM_MAX_GAP) && (Position < Stream->Sent); Position++)
+	{
+		if (Stream_Matches(Stream, Arrivals, Position, Count))
+		  return Position;
+	}
+
+	return UINT64_MAX;
+}
+
+/** Matches the pending bytes against the stream, leaving the last few for later unless the stream is finished.
+ *
+ *  \param[in,out] Stream     Stream to match the bytes of.
+ *  \param[in]     Finishing  Whether no more bytes will be received, so that the last bytes are matched on their own.
+ */
+static void Stream_Match(Stream_t* const Stream,
+                         const bool Finishing)
+{
+	size_t Done = 0;
+
+	while ((Stream->PendingCount - Done) >= (Finishing ? 1 : STREAM_MATCH_WINDOW))
+	{
+		const Stream_Arrival_t* Arrivals = &Stream->Pending[Done];
+		size_t                  Window   = (Stream->PendingCount - Done);
+
+		if (Window > STREAM_MATCH_WINDOW)
+		  Window = STREAM_MATCH_WINDOW;
+
+		uint64_t Position = UINT64_MAX;
+
+		/* A gap within the next few bytes leaves fewer of them following on, so the window shrinks down to a pair */
+		for (size_t Length = Window; (Position == UINT64_MAX) && (Length >= 2); Length--)
+		  Position = Stream_Find(Stream, Arrivals, Length, Stream->Expected);
+
+		if ((Position == UINT64_MAX) && Stream_Matches(Stream, Arrivals, Stream->Expected, 1))
+		  Position = Stream->Expected;
+
+		/* A lone byte between two gaps is placed ahead of where the bytes after it are found */
+		if ((Position == UINT64_MAX) && (Window > 1))
+		{
+			uint64_t Next = Stream_Find(Stream, &Arrivals[1], (Window - 1), Stream->Expected);
+			uint64_t Lone = Stream_Find(Stream, Arrivals, 1, Stream->Expected);
+
+			if ((Next != UINT64_MAX) && (Lone < Next))
+			  Position = Lone;
+		}
+
+		if (Position != UINT64_MAX)
+		  Stream_Accept(Stream, Arrivals, Position);
+		else
+		  Stream->Corrupt++;
+
+		Done++;
+	}
+
+	memmove(Stream->Pending, &Stream->Pending[Done], (Stream->PendingCount - Done) * sizeof(Stream_Arrival_t));
+	Stream->PendingCount -= Done;
+}
+
+/** Receives bytes of a stream on the other side of the bridge.
+ *
+ *  \param[in,out] Stream  Stream the bytes belong to.
+ *  \param[in]     Data    Bytes received.
+ *  \param[in]     Length  Number of bytes received.
+ *  \param[in]     Time    Time the bytes were received at, in cycles.
+ */
+void Stream_Receive(Stream_t* const Stream,
+                    const uint8_t* const Data,
+                    const uint16_t Length,
+                    const uint64_t Time)
+{
+	Stream_Reserve((void**)&Stream->Pending, &Stream->PendingCapacity, (Stream->PendingCount + Length),
+	               sizeof(Stream_Arrival_t));
+
+	for (uint16_t i = 0; i < Length; i++)
+	  Stream->Pending[Stream->PendingCount++] = (Stream_Arrival_t){ .Byte = Data[i], .Time = Time };
+
+	Stream_Match(Stream, false);
+}
+
+static int Stream_CompareLatencies(const void* const A,
+                                   const void* const B)
+{
+	uint32_t LatencyA = *(const uint32_t*)A;
+	uint32_t LatencyB = *(const uint32_t*)B;
+
+	return (LatencyA > LatencyB) - (LatencyA < LatencyB);
+}
+
+/** Ends a stream once the run is over, matching the last bytes received and sorting the latencies. The bytes never
+ *  received past the last one matched are counted as missing.
+ *
+ *  \param[in,out] Stream  Stream to end.
+ */
+void Stream_Finish(Stream_t* const Stream)
+{
+	Stream_Match(Stream, true);
+
+	Stream->Missing += (Stream->Sent - Stream->Expected);
+	Stream->Expected = Stream->Sent;
+
+	if (Stream->Received)
+	  qsort(Stream->Latencies, Stream->Received, sizeof(uint32_t), Stream_CompareLatencies);
+}
+
+/** Retrieves a percentile of the latencies of a finished stream.
+ *
+ *  \param[in] Stream      Stream to retrieve the latency of.
+ *  \param[in] Percentile  Percentile to retrieve, from 0 to 100.
+ *
+ *  \return Latency at the given percentile, in cycles, or zero if no byte was received.
+ */
+uint32_t Stream_GetLatencyPercentile(const Stream_t* const Stream,
+                                     const double Percentile)
+{
+	if (!(Stream->Received))
+	  return 0;
+
+	size_t Index = (size_t)((Percentile / 100.0) * Stream->Received + 0.999999);
+
+	if (Index)
+	  Index--;
+
+	if (Index >= Stream->Received)
+	  Index = (Stream->Received - 1);
+
+	return Stream->Latencies[Index];
+}
@@ -0,0 +1,106 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for Stream.c.
+ */
+
+#ifndef _STREAM_H_
+#define _STREAM_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+		#include <stddef.h>
+
+	/* Macros: */
+		/** Number of bytes compared at once to find the next expected byte of a stream, after a gap. */
+		#define STREAM_MATCH_WINDOW      4
+
+	/* Type Defines: */
+		/** Type define for a byte received and waiting to be matched against the stream. */
+		typedef struct
+		{
+			uint8_t  Byte;
+			uint64_t Time;
+		} Stream_Arrival_t;
+
+		/** Type define for a test stream of pseudo-random bytes, sent on one side of the bridge and checked on the
+		 *  other. Each byte is a function of its position in the stream, so that the receiving side can tell which
+		 *  bytes were dropped and time each one that arrived.
+		 */
+		typedef struct
+		{
+			const char*       Name;
+			uint32_t          Seed;
+
+			uint64_t          Sent; /**< Number of bytes generated. */
+			uint64_t*         SentTimes; /**< Time each byte was sent at, in cycles. */
+			size_t            SentCapacity;
+
+			Stream_Arrival_t* Pending; /**< Bytes received but not yet matched. */
+			size_t            PendingCount;
+			size_t            PendingCapacity;
+
+			uint64_t          Expected; /**< Position of the next byte expected by the receiving side. */
+			uint64_t          Received; /**< Number of bytes received in order. */
+			uint64_t          Missing; /**< Number of bytes skipped over by the receiving side. */
+			uint64_t          Corrupt; /**< Number of bytes received which matched no position of the stream. */
+
+			uint32_t*         Latencies; /**< Latency of each byte received, in cycles. */
+			size_t            LatencyCapacity;
+
+			uint64_t          WindowStart; /**< Start of the measurement window, in cycles. */
+			uint64_t          WindowEnd; /**< End of the measurement window, in cycles. */
+			uint64_t          WindowBytes; /**< Number of bytes received within the measurement window. */
+		} Stream_t;
+
+	/* Function Prototypes: */
+		void     Stream_Init(Stream_t* const Stream,
+		                     const char* const Name,
+		                     const uint32_t Seed);
+		void     Stream_Free(Stream_t* const Stream);
+		uint64_t Stream_Generate(Stream_t* const Stream,
+		                         uint8_t* const Data,
+		                         const uint16_t Length);
+		void     Stream_SetSentTime(Stream_t* const Stream,
+		                            const uint64_t First,
+		                            const uint16_t Length,
+		                            const uint64_t Time);
+		void     Stream_Receive(Stream_t* const Stream,
+		                        const uint8_t* const Data,
+		                        const uint16_t Length,
+		                        const uint64_t Time);
+		void     Stream_Finish(Stream_t* const Stream);
+		uint32_t Stream_GetLatencyPercentile(const Stream_t* const Stream,
+		                                     const double Percentile);
+
+#endif
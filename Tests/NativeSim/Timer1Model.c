@@ -0,0 +1,188 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Model of Timer 1 in normal mode: the counter, the flags of its overflow and of its compare match units A and B,
+ *  and their interrupts. The counter is brought up to date from the simulated clock as it advances, through the
+ *  prescaler selected by \c TCCR1B. \c TCNT1 is accessed through the shared \c TEMP register as on the AVR, so
+ *  that a 16-bit access is atomic; the compare registers are plain storage.
+ */
+
+#include "Timer1Model.h"
+
+/** Prescaler ratios of the clock select values of \c TCCR1B, zero standing for a stopped timer. The external clock
+ *  sources are not modelled.
+ */
+static const uint16_t Timer1Model_Prescalers[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+
+static struct
+{
+	uint16_t Count;
+	uint8_t  Temp;
+	uint64_t LastUpdate;
+	uint32_t PendingCycles;
+} Timer1Model_State;
+
+/** Reads a 16-bit register stored by the simulator, without side effects.
+ *
+ *  \param[in] Address  Offset of the low byte of the register in the data space.
+ *
+ *  \return Value of the register.
+ */
+static uint16_t Timer1Model_GetStoredWord(const uint16_t Address)
+{
+	return (Sim_Storage[Address] | (Sim_Storage[Address + 1] << 8));
+}
+
+/** Indicates whether the counter went through a value within the ticks it has just counted.
+ *
+ *  \param[in] Start  Value of the counter before the ticks.
+ *  \param[in] Ticks  Number of ticks counted.
+ *  \param[in] Value  Value to check for.
+ *
+ *  \return Boolean \c true if the counter was at \c Value after one of the ticks, \c false otherwise.
+ */
+static bool Timer1Model_Reached(const uint16_t Start,
+                                const uint64_t Ticks,
+                                const uint16_t Value)
+{
+	return ((Ticks > UINT16_MAX) || ((uint16_t)(Value - Start - 1) < Ticks));
+}
+
+/** Brings the counter up to the current simulated time, raising the flags of the values it went through. */
+static void Timer1Model_Update(void)
+{
+	uint16_t Prescaler = Timer1Model_Prescalers[SIM_STORAGE(TCCR1B) & 0x07];
+	uint64_t Elapsed   = (Sim_Cycles - Timer1Model_State.LastUpdate);
+
+	Timer1Model_State.LastUpdate = Sim_Cycles;
+
+	if (!(Prescaler))
+	  return;
+
+	Elapsed += Timer1Model_State.PendingCycles;
+
+	uint64_t Ticks = (Elapsed / Prescaler);
+	Timer1Model_State.PendingCycles = (Elapsed % Prescaler);
+
+	if (!(Ticks))
+	  return;
+
+	uint16_t Start = Timer1Model_State.Count;
+
+	if (Timer1Model_Reached(Start, Ticks, 0))
+	  SIM_STORAGE(TIFR1) |= (1 << TOV1);
+
+	if (Timer1Model_Reached(Start, Ticks, Timer1Model_GetStoredWord(SIM_ADDRESS(OCR1AL))))
+	  SIM_STORAGE(TIFR1) |= (1 << OCF1A);
+
+	if (Timer1Model_Reached(Start, Ticks, Timer1Model_GetStoredWord(SIM_ADDRESS(OCR1BL))))
+	  SIM_STORAGE(TIFR1) |= (1 << OCF1B);
+
+	Timer1Model_State.Count = (Start + Ticks);
+}
+
+/** Reads the low byte of the counter, latching its high byte into \c TEMP. */
+static uint8_t Timer1Model_ReadCountLow(const bool Peek)
+{
+	if (!(Peek))
+	  Timer1Model_State.Temp = (Timer1Model_State.Count >> 8);
+
+	return (Timer1Model_State.Count & 0xFF);
+}
+
+/** Reads the high byte of the counter latched by the last read of its low byte. */
+static uint8_t Timer1Model_ReadCountHigh(const bool Peek)
+{
+	return Timer1Model_State.Temp;
+}
+
+/** Writes the low byte of the counter, committing it together with the high byte held in \c TEMP. */
+static void Timer1Model_WriteCountLow(const uint8_t Value)
+{
+	Timer1Model_State.Count = ((Timer1Model_State.Temp << 8) | Value);
+}
+
+/** Writes the high byte of the counter into \c TEMP, until the low byte is written. */
+static void Timer1Model_WriteCountHigh(const uint8_t Value)
+{
+	Timer1Model_State.Temp = Value;
+}
+
+/** Clears the flags written as one. */
+static void Timer1Model_WriteFlags(const uint8_t Value)
+{
+	SIM_STORAGE(TIFR1) &= ~Value;
+}
+
+static bool Timer1Model_IsCompareAPending(void)
+{
+	return (SIM_STORAGE(TIMSK1) & SIM_STORAGE(TIFR1) & (1 << OCF1A));
+}
+
+static bool Timer1Model_IsCompareBPending(void)
+{
+	return (SIM_STORAGE(TIMSK1) & SIM_STORAGE(TIFR1) & (1 << OCF1B));
+}
+
+static bool Timer1Model_IsOverflowPending(void)
+{
+	return (SIM_STORAGE(TIMSK1) & SIM_STORAGE(TIFR1) & (1 << TOV1));
+}
+
+static void Timer1Model_AcknowledgeCompareA(void)
+{
+	SIM_STORAGE(TIFR1) &= ~(1 << OCF1A);
+}
+
+static void Timer1Model_AcknowledgeCompareB(void)
+{
+	SIM_STORAGE(TIFR1) &= ~(1 << OCF1B);
+}
+
+static void Timer1Model_AcknowledgeOverflow(void)
+{
+	SIM_STORAGE(TIFR1) &= ~(1 << TOV1);
+}
+
+/** Attaches the Timer 1 model to its registers and interrupt vectors. */
+void Timer1Model_Init(void)
+{
+	Sim_MapRegister(&TCNT1L, Timer1Model_ReadCountLow, Timer1Model_WriteCountLow);
+	Sim_MapRegister(&TCNT1H, Timer1Model_ReadCountHigh, Timer1Model_WriteCountHigh);
+	Sim_MapRegister(&TIFR1, NULL, Timer1Model_WriteFlags);
+
+	Sim_AddInterrupt(SIM_VECTOR_TIMER1_COMPA, Timer1Model_IsCompareAPending, Timer1Model_AcknowledgeCompareA);
+	Sim_AddInterrupt(SIM_VECTOR_TIMER1_COMPB, Timer1Model_IsCompareBPending, Timer1Model_AcknowledgeCompareB);
+	Sim_AddInterrupt(SIM_VECTOR_TIMER1_OVF,   Timer1Model_IsOverflowPending, Timer1Model_AcknowledgeOverflow);
+
+	Sim_AddModel(Timer1Model_Update);
+}
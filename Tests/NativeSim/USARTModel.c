@@ -0,0 +1,335 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Model of USART 1 and of the peer wired to it. The device side follows the AVR's buffering: two characters of
+ *  receive FIFO behind the receive shift register, in which a third character waits until the next one completes
+ *  and overruns it, and a single transmit buffer in front of the transmit shift register. The character time of the
+ *  device comes from \c UBRR1, \c U2X1 and the frame format of \c UCSR1C.
+ *
+ *  The peer sends its characters back to back at its own baud rate, or spaced out to a given share of the line,
+ *  and receives those of the device as their stop bit completes. Only whole characters are modelled, each one
+ *  arriving at the end of its stop bit; a baud rate mismatch shows up as a difference in throughput, not as
+ *  framing errors.
+ */
+
+#include "USARTModel.h"
+
+/** Depth of the receive FIFO, not counting the receive shift register. */
+#define USART_MODEL_RX_FIFO_DEPTH  2
+
+USARTModel_Stats_t USARTModel_Stats;
+
+static struct
+{
+	uint8_t  RxFIFO[USART_MODEL_RX_FIFO_DEPTH];
+	uint8_t  RxCount;
+	bool     RxShiftFull;
+	uint8_t  RxShift;
+	bool     Overrun;
+
+	bool     TxBufferFull;
+	uint8_t  TxBuffer;
+	bool     TxShiftFull;
+	uint8_t  TxShift;
+	uint64_t TxShiftEnd;
+	bool     TxComplete;
+} USARTModel_Device;
+
+static struct
+{
+	USARTModel_PeerSource_t Source;
+	USARTModel_PeerSink_t   Sink;
+	double                  CharCycles;
+	double                  Spacing;
+	double                  NextStart;
+	bool                    Sending;
+	uint8_t                 Byte;
+	uint64_t                End;
+} USARTModel_Peer;
+
+/** Retrieves the duration of a character sent or received by the device, from its baud rate and frame format.
+ *
+ *  \return Number of CPU cycles taken by one character.
+ */
+uint64_t USARTModel_GetCharCycles(void)
+{
+	uint8_t  FormatC = SIM_STORAGE(UCSR1C);
+	uint16_t UBRR    = ((SIM_STORAGE(UBRR1L) | (SIM_STORAGE(UBRR1H) << 8)) & 0x0FFF);
+
+	uint8_t DataBits = (SIM_STORAGE(UCSR1B) & (1 << UCSZ12)) ? 9 : (5 + ((FormatC >> UCSZ10) & 0x03));
+	uint8_t Bits     = (1 + DataBits + ((FormatC & (1 << UPM11)) ? 1 : 0) + ((FormatC & (1 << USBS1)) ? 2 : 1));
+
+	return ((uint64_t)((SIM_STORAGE(UCSR1A) & (1 << U2X1)) ? 8 : 16) * (UBRR + 1) * Bits);
+}
+
+/** Retrieves the duration of a character sent or received by the peer.
+ *
+ *  \return Number of CPU cycles taken by one character, not rounded.
+ */
+double USARTModel_GetPeerCharCycles(void)
+{
+	return USARTModel_Peer.CharCycles;
+}
+
+/** Indicates whether the device has nothing left to transmit.
+ *
+ *  \return Boolean \c true if both the transmit buffer and shift register are empty, \c false otherwise.
+ */
+bool USARTModel_IsIdle(void)
+{
+	return (!(USARTModel_Device.TxBufferFull) && !(USARTModel_Device.TxShiftFull));
+}
+
+/** Hands a character completed by the peer to the device's receiver.
+ *
+ *  \param[in] Byte  Character received.
+ */
+static void USARTModel_Receive(const uint8_t Byte)
+{
+	if (!(SIM_STORAGE(UCSR1B) & (1 << RXEN1)))
+	{
+		USARTModel_Stats.DisabledDrops++;
+		return;
+	}
+
+	/* A character left waiting in the shift register is overrun by the next one */
+	if (USARTModel_Device.RxShiftFull)
+	{
+		USARTModel_Stats.Overruns++;
+		USARTModel_Device.Overrun = true;
+	}
+
+	if (USARTModel_Device.RxCount < USART_MODEL_RX_FIFO_DEPTH)
+	{
+		USARTModel_Device.RxFIFO[USARTModel_Device.RxCount++] = Byte;
+	}
+	else
+	{
+		USARTModel_Device.RxShift     = Byte;
+		USARTModel_Device.RxShiftFull = true;
+	}
+}
+
+/** Moves the transmit buffer into the idle transmit shift register, starting its character.
+ *
+ *  \param[in] Start  Simulated time at which the character starts, in cycles.
+ */
+static void USARTModel_StartTransmit(const uint64_t Start)
+{
+	USARTModel_Device.TxShift      = USARTModel_Device.TxBuffer;
+	USARTModel_Device.TxShiftFull  = true;
+	USARTModel_Device.TxShiftEnd   = (Start + USARTModel_GetCharCycles());
+	USARTModel_Device.TxBufferFull = false;
+}
+
+/** Brings the line up to the current simulated time, in both directions. */
+static void USARTModel_Update(void)
+{
+	while (USARTModel_Device.TxShiftFull && (USARTModel_Device.TxShiftEnd <= Sim_Cycles))
+	{
+		USARTModel_Stats.TransmittedBytes++;
+		USARTModel_Device.TxShiftFull = false;
+
+		if (USARTModel_Peer.Sink)
+		  USARTModel_Peer.Sink(USARTModel_Device.TxShift, USARTModel_Device.TxShiftEnd);
+
+		if (USARTModel_Device.TxBufferFull)
+		  USARTModel_StartTransmit(USARTModel_Device.TxShiftEnd);
+		else
+		  USARTModel_Device.TxComplete = true;
+	}
+
+	while (USARTModel_Peer.Source)
+	{
+		if (USARTModel_Peer.Sending)
+		{
+			if (USARTModel_Peer.End > Sim_Cycles)
+			  break;
+
+			USARTModel_Peer.Sending = false;
+			USARTModel_Receive(USARTModel_Peer.Byte);
+		}
+
+		if (USARTModel_Peer.NextStart > Sim_Cycles)
+		  break;
+
+		uint64_t End = (uint64_t)(USARTModel_Peer.NextStart + USARTModel_Peer.CharCycles);
+
+		if (!(USARTModel_Peer.Source(&USARTModel_Peer.Byte, End)))
+		{
+			/* The peer stays idle until asked again one character later */
+			USARTModel_Peer.NextStart += USARTModel_Peer.CharCycles;
+			continue;
+		}
+
+		USARTModel_Peer.Sending    = true;
+		USARTModel_Peer.End        = End;
+		USARTModel_Peer.NextStart += USARTModel_Peer.Spacing;
+	}
+}
+
+static uint8_t USARTModel_ReadStatus(const bool Peek)
+{
+	uint8_t Status = (SIM_STORAGE(UCSR1A) & ((1 << U2X1) | (1 << MPCM1)));
+
+	if (USARTModel_Device.RxCount)
+	  Status |= (1 << RXC1);
+
+	if (USARTModel_Device.TxComplete)
+	  Status |= (1 << TXC1);
+
+	if (!(USARTModel_Device.TxBufferFull))
+	  Status |= (1 << UDRE1);
+
+	if (USARTModel_Device.Overrun)
+	  Status |= (1 << DOR1);
+
+	return Status;
+}
+
+/** Stores the writable bits of \c UCSR1A, clearing \c TXC1 when written as one. */
+static void USARTModel_WriteStatus(const uint8_t Value)
+{
+	SIM_STORAGE(UCSR1A) = (Value & ((1 << U2X1) | (1 << MPCM1)));
+
+	if (Value & (1 << TXC1))
+	  USARTModel_Device.TxComplete = false;
+}
+
+/** Stores \c UCSR1B, flushing the receive FIFO when the receiver is disabled. */
+static void USARTModel_WriteControl(const uint8_t Value)
+{
+	SIM_STORAGE(UCSR1B) = Value;
+
+	if (!(Value & (1 << RXEN1)))
+	{
+		USARTModel_Device.RxCount     = 0;
+		USARTModel_Device.RxShiftFull = false;
+		USARTModel_Device.Overrun     = false;
+	}
+}
+
+/** Reads the receive FIFO, moving the character waiting in the shift register into it. */
+static uint8_t USARTModel_ReadData(const bool Peek)
+{
+	uint8_t Byte = USARTModel_Device.RxFIFO[0];
+
+	if (Peek || !(USARTModel_Device.RxCount))
+	  return Byte;
+
+	USARTModel_Stats.ReceivedBytes++;
+
+	USARTModel_Device.RxFIFO[0] = USARTModel_Device.RxFIFO[1];
+	USARTModel_Device.RxCount--;
+	USARTModel_Device.Overrun   = false;
+
+	if (USARTModel_Device.RxShiftFull)
+	{
+		USARTModel_Device.RxFIFO[USARTModel_Device.RxCount++] = USARTModel_Device.RxShift;
+		USARTModel_Device.RxShiftFull = false;
+	}
+
+	return Byte;
+}
+
+/** Writes the transmit buffer, starting the character at once when the shift register is idle. */
+static void USARTModel_WriteData(const uint8_t Value)
+{
+	if (!(SIM_STORAGE(UCSR1B) & (1 << TXEN1)))
+	  return;
+
+	if (USARTModel_Device.TxBufferFull)
+	{
+		USARTModel_Stats.IgnoredWrites++;
+		return;
+	}
+
+	USARTModel_Device.TxBuffer     = Value;
+	USARTModel_Device.TxBufferFull = true;
+
+	if (!(USARTModel_Device.TxShiftFull))
+	  USARTModel_StartTransmit(Sim_Cycles);
+}
+
+static bool USARTModel_IsReceivePending(void)
+{
+	return ((SIM_STORAGE(UCSR1B) & (1 << RXCIE1)) && USARTModel_Device.RxCount);
+}
+
+static bool USARTModel_IsDataEmptyPending(void)
+{
+	return ((SIM_STORAGE(UCSR1B) & (1 << UDRIE1)) && !(USARTModel_Device.TxBufferFull));
+}
+
+static bool USARTModel_IsTransmitPending(void)
+{
+	return ((SIM_STORAGE(UCSR1B) & (1 << TXCIE1)) && USARTModel_Device.TxComplete);
+}
+
+static void USARTModel_AcknowledgeTransmit(void)
+{
+	USARTModel_Device.TxComplete = false;
+}
+
+/** Attaches the USART model to its registers and interrupt vectors. */
+void USARTModel_Init(void)
+{
+	Sim_MapRegister(&UCSR1A, USARTModel_ReadStatus, USARTModel_WriteStatus);
+	Sim_MapRegister(&UCSR1B, NULL, USARTModel_WriteControl);
+	Sim_MapRegister(&UDR1, USARTModel_ReadData, USARTModel_WriteData);
+
+	Sim_AddInterrupt(SIM_VECTOR_USART1_RX,   USARTModel_IsReceivePending, NULL);
+	Sim_AddInterrupt(SIM_VECTOR_USART1_UDRE, USARTModel_IsDataEmptyPending, NULL);
+	Sim_AddInterrupt(SIM_VECTOR_USART1_TX,   USARTModel_IsTransmitPending, USARTModel_AcknowledgeTransmit);
+
+	Sim_AddModel(USARTModel_Update);
+}
+
+/** Sets up the peer wired to the USART.
+ *
+ *  \param[in] Baud         Baud rate of the peer.
+ *  \param[in] LoadPercent  Share of the line used by the characters sent by the peer, from 1 to 100.
+ *  \param[in] Source       Source of the characters sent by the peer.
+ *  \param[in] Sink         Sink of the characters received by the peer.
+ */
+void USARTModel_SetPeer(const uint32_t Baud,
+                        const uint8_t LoadPercent,
+                        const USARTModel_PeerSource_t Source,
+                        const USARTModel_PeerSink_t Sink)
+{
+	USARTModel_Peer.Source     = Source;
+	USARTModel_Peer.Sink       = Sink;
+	USARTModel_Peer.CharCycles = ((double)USART_MODEL_PEER_FRAME_BITS * F_CPU / Baud);
+	USARTModel_Peer.Spacing    = (USARTModel_Peer.CharCycles * 100 / LoadPercent);
+	USARTModel_Peer.NextStart  = Sim_Cycles;
+	USARTModel_Peer.Sending    = false;
+}
@@ -0,0 +1,88 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for USARTModel.c.
+ */
+
+#ifndef _USART_MODEL_H_
+#define _USART_MODEL_H_
+
+	/* Includes: */
+		#include "Sim.h"
+
+	/* Macros: */
+		/** Number of bits of each character sent by the peer, in 8N1 framing. */
+		#define USART_MODEL_PEER_FRAME_BITS  10
+
+	/* Type Defines: */
+		/** Type define for the source of the characters sent by the peer.
+		 *
+		 *  \param[out] Byte     Character to send.
+		 *  \param[in]  EndTime  Simulated time at which its stop bit will have been received by the device, in cycles.
+		 *
+		 *  \return Boolean \c true if a character is to be sent, \c false if the peer stays idle.
+		 */
+		typedef bool (*USARTModel_PeerSource_t)(uint8_t* const Byte,
+		                                        const uint64_t EndTime);
+
+		/** Type define for the sink of the characters received by the peer.
+		 *
+		 *  \param[in] Byte     Character received.
+		 *  \param[in] EndTime  Simulated time at which its stop bit was received, in cycles.
+		 */
+		typedef void (*USARTModel_PeerSink_t)(const uint8_t Byte,
+		                                      const uint64_t EndTime);
+
+		/** Type define for the counts kept by the USART model. */
+		typedef struct
+		{
+			uint64_t ReceivedBytes; /**< Characters taken from the receive buffer by the firmware. */
+			uint64_t Overruns; /**< Characters lost to a full receive buffer, flagged with \c DOR1. */
+			uint64_t DisabledDrops; /**< Characters lost while the receiver was disabled. */
+			uint64_t TransmittedBytes; /**< Characters sent to the peer. */
+			uint64_t IgnoredWrites; /**< Writes to \c UDR1 while the transmit buffer was full, which are ignored. */
+		} USARTModel_Stats_t;
+
+	/* External Variables: */
+		extern USARTModel_Stats_t USARTModel_Stats;
+
+	/* Function Prototypes: */
+		void     USARTModel_Init(void);
+		void     USARTModel_SetPeer(const uint32_t Baud,
+		                            const uint8_t LoadPercent,
+		                            const USARTModel_PeerSource_t Source,
+		                            const USARTModel_PeerSink_t Sink);
+		uint64_t USARTModel_GetCharCycles(void);
+		double   USARTModel_GetPeerCharCycles(void);
+		bool     USARTModel_IsIdle(void);
+
+#endif
@@ -0,0 +1,600 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Model of the USB host the bridge is plugged into. Once the device attaches, the host waits for the connection to
+ *  settle, resets the bus and starts sending a start of frame packet every millisecond. Each frame is split into
+ *  \ref USB_HOST_SLOTS_PER_FRAME slots, each carrying the next stage of the current control transfer, an IN token to
+ *  the bulk IN endpoint and the next packet queued for the bulk OUT endpoint, retried on a NAK in the next slot as a
+ *  host controller would. The host enumerates the device as a CDC ACM function, sets its line coding to the given
+ *  baud rate in 8N1 framing and raises DTR and RTS, after which the data endpoints carry the test streams.
+ */
+
+#include "USBHost.h"
+
+/** Number of CPU cycles between two transaction slots. */
+#define USB_HOST_SLOT_CYCLES       (USB_HOST_FRAME_CYCLES / USB_HOST_SLOTS_PER_FRAME)
+
+/** Address given to the device by the host. */
+#define USB_HOST_DEVICE_ADDRESS    1
+
+/** Enum for the phases of the host's handling of the device. */
+enum USBHost_Phases_t
+{
+	USB_HOST_PHASE_Detached    = 0,
+	USB_HOST_PHASE_Debounce    = 1,
+	USB_HOST_PHASE_Reset       = 2,
+	USB_HOST_PHASE_Enumerating = 3,
+	USB_HOST_PHASE_Configured  = 4,
+};
+
+/** Enum for the stages of a control transfer. */
+enum USBHost_ControlStages_t
+{
+	USB_HOST_STAGE_Setup     = 0,
+	USB_HOST_STAGE_DataIN    = 1,
+	USB_HOST_STAGE_DataOUT   = 2,
+	USB_HOST_STAGE_StatusIN  = 3,
+	USB_HOST_STAGE_StatusOUT = 4,
+};
+
+/** Enum for the steps of the enumeration, each one a control transfer. */
+enum USBHost_EnumerationSteps_t
+{
+	USB_HOST_ENUM_GetDeviceDescriptor = 0,
+	USB_HOST_ENUM_SetAddress          = 1,
+	USB_HOST_ENUM_GetConfigHeader     = 2,
+	USB_HOST_ENUM_GetConfigDescriptor = 3,
+	USB_HOST_ENUM_SetConfiguration    = 4,
+	USB_HOST_ENUM_SetLineEncoding     = 5,
+	USB_HOST_ENUM_SetControlLineState = 6,
+	USB_HOST_ENUM_Done                = 7,
+};
+
+USBHost_Stats_t USBHost_Stats;
+
+static struct
+{
+	uint8_t                Phase;
+	uint64_t               PhaseEnd;
+	uint8_t                EnumerationStep;
+	uint8_t                Address;
+	uint8_t                ControlSize;
+	uint16_t               ConfigLength;
+
+	uint64_t               NextSlot;
+	uint8_t                Slot;
+	uint16_t               FrameNumber;
+	uint8_t                INTokensPerFrame;
+	uint8_t                INTokens;
+
+	uint8_t                DataINEndpoint;
+	uint8_t                DataOUTEndpoint;
+	uint16_t               DataOUTSize;
+	uint8_t                NotificationEndpoint;
+
+	uint8_t                OUTPacket[USB_MODEL_MAX_BANK_SIZE];
+	uint16_t               OUTLength;
+	bool                   OUTPending;
+
+	uint32_t               Baud;
+	USBHost_DataHandlers_t Handlers;
+} USBHost_State;
+
+static struct
+{
+	USB_Request_Header_t Request;
+	uint8_t              Status;
+	uint8_t              Stage;
+	uint8_t              Data[USB_HOST_MAX_CONTROL_DATA];
+	uint16_t             Length;
+	uint16_t             Position;
+	uint64_t             Deadline;
+} USBHost_Control;
+
+/** Submits a control transfer, run through the transaction slots from the next one on.
+ *
+ *  \param[in] Request  Request of the control transfer.
+ *  \param[in] Data     Data stage of a host-to-device request, or \c NULL.
+ *
+ *  \return Boolean \c true if the transfer was submitted, \c false if another one is still in progress.
+ */
+bool USBHost_SubmitControl(const USB_Request_Header_t* const Request,
+                           const void* const Data)
+{
+	if (USBHost_Control.Status == USB_HOST_CONTROL_Busy)
+	  return false;
+
+	if (Request->wLength > USB_HOST_MAX_CONTROL_DATA)
+	  Sim_Fail("Control transfer of %u bytes", Request->wLength);
+
+	USBHost_Control.Request  = *Request;
+	USBHost_Control.Status   = USB_HOST_CONTROL_Busy;
+	USBHost_Control.Stage    = USB_HOST_STAGE_Setup;
+	USBHost_Control.Length   = 0;
+	USBHost_Control.Position = 0;
+	USBHost_Control.Deadline = (Sim_Cycles + SIM_US_TO_CYCLES(USB_HOST_CONTROL_TIMEOUT_US));
+
+	if (Data && !(Request->bmRequestType & REQDIR_DEVICETOHOST))
+	{
+		memcpy(USBHost_Control.Data, Data, Request->wLength);
+		USBHost_Control.Length = Request->wLength;
+	}
+
+	return true;
+}
+
+/** Retrieves the state of the control transfer last submitted.
+ *
+ *  \return Value from \ref USBHost_ControlStatus_t.
+ */
+uint8_t USBHost_GetControlStatus(void)
+{
+	return USBHost_Control.Status;
+}
+
+/** Retrieves the data stage of the device-to-host control transfer last completed.
+ *
+ *  \param[out] Length  Number of bytes received in the data stage.
+ *
+ *  \return Pointer to the data received.
+ */
+const uint8_t* USBHost_GetControlData(uint16_t* const Length)
+{
+	*Length = USBHost_Control.Length;
+	return USBHost_Control.Data;
+}
+
+/** Runs the next transaction of the current control transfer, on the control endpoint. */
+static void USBHost_RunControlStage(void)
+{
+	if (USBHost_Control.Status != USB_HOST_CONTROL_Busy)
+	  return;
+
+	if (Sim_Cycles > USBHost_Control.Deadline)
+	{
+		USBHost_Control.Status = USB_HOST_CONTROL_Failed;
+		return;
+	}
+
+	uint8_t  Address   = USBHost_State.Address;
+	uint8_t  Stage     = USBHost_Control.Stage;
+	uint8_t  Packet[USB_MODEL_MAX_BANK_SIZE];
+	uint16_t Length    = 0;
+	uint8_t  Handshake = USB_MODEL_HANDSHAKE_None;
+	bool     IsIN      = (USBHost_Control.Request.bmRequestType & REQDIR_DEVICETOHOST);
+
+	switch (Stage)
+	{
+		case USB_HOST_STAGE_Setup:
+			Handshake = USBModel_Setup(Address, (const uint8_t*)&USBHost_Control.Request);
+
+			if (Handshake != USB_MODEL_HANDSHAKE_ACK)
+			  break;
+
+			if (!(USBHost_Control.Request.wLength))
+			  USBHost_Control.Stage = IsIN ? USB_HOST_STAGE_StatusOUT : USB_HOST_STAGE_StatusIN;
+			else
+			  USBHost_Control.Stage = IsIN ? USB_HOST_STAGE_DataIN : USB_HOST_STAGE_DataOUT;
+
+			break;
+		case USB_HOST_STAGE_DataIN:
+			Handshake = USBModel_In(Address, 0, Packet, &Length);
+
+			if (Handshake != USB_MODEL_HANDSHAKE_ACK)
+			  break;
+
+			if ((USBHost_Control.Length + Length) > USBHost_Control.Request.wLength)
+			  Sim_Fail("Control data stage longer than the %u bytes requested", USBHost_Control.Request.wLength);
+
+			memcpy(&USBHost_Control.Data[USBHost_Control.Length], Packet, Length);
+			USBHost_Control.Length += Length;
+
+			if ((Length < USBHost_State.ControlSize) || (USBHost_Control.Length == USBHost_Control.Request.wLength))
+			  USBHost_Control.Stage = USB_HOST_STAGE_StatusOUT;
+
+			break;
+		case USB_HOST_STAGE_DataOUT:
+			Length = (USBHost_Control.Length - USBHost_Control.Position);
+
+			if (Length > USBHost_State.ControlSize)
+			  Length = USBHost_State.ControlSize;
+
+			Handshake = USBModel_Out(Address, 0, &USBHost_Control.Data[USBHost_Control.Position], Length);
+
+			if (Handshake != USB_MODEL_HANDSHAKE_ACK)
+			  break;
+
+			USBHost_Control.Position += Length;
+
+			if (USBHost_Control.Position == USBHost_Control.Length)
+			  USBHost_Control.Stage = USB_HOST_STAGE_StatusIN;
+
+			break;
+		case USB_HOST_STAGE_StatusIN:
+			Handshake = USBModel_In(Address, 0, Packet, &Length);
+
+			if ((Handshake == USB_MODEL_HANDSHAKE_ACK) && Length)
+			  Sim_Fail("Status stage of a control transfer carried %u bytes", Length);
+
+			break;
+		case USB_HOST_STAGE_StatusOUT:
+			Handshake = USBModel_Out(Address, 0, NULL, 0);
+			break;
+	}
+
+	if ((Handshake == USB_MODEL_HANDSHAKE_STALL) || (Handshake == USB_MODEL_HANDSHAKE_None))
+	{
+		USBHost_Control.Status = USB_HOST_CONTROL_Failed;
+	}
+	else if ((Handshake == USB_MODEL_HANDSHAKE_ACK) &&
+	         ((Stage == USB_HOST_STAGE_StatusIN) || (Stage == USB_HOST_STAGE_StatusOUT)))
+	{
+		USBHost_Stats.ControlTransfers++;
+		USBHost_Control.Status = USB_HOST_CONTROL_Done;
+	}
+}
+
+/** Submits the control transfer of the given enumeration step.
+ *
+ *  \param[in] Step  Enumeration step to start, a value from \ref USBHost_EnumerationSteps_t.
+ */
+static void USBHost_StartEnumerationStep(const uint8_t Step)
+{
+	USB_Request_Header_t Request = { 0 };
+	CDC_LineEncoding_t   LineEncoding;
+
+	USBHost_State.EnumerationStep = Step;
+
+	switch (Step)
+	{
+		case USB_HOST_ENUM_GetDeviceDescriptor:
+			Request = (USB_Request_Header_t)
+				{
+					.bmRequestType = (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE),
+					.bRequest      = REQ_GetDescriptor,
+					.wValue        = (DTYPE_Device << 8),
+					.wLength       = 64,
+				};
+			break;
+		case USB_HOST_ENUM_SetAddress:
+			Request = (USB_Request_Header_t)
+				{
+					.bmRequestType = (REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_DEVICE),
+					.bRequest      = REQ_SetAddress,
+					.wValue        = USB_HOST_DEVICE_ADDRESS,
+				};
+			break;
+		case USB_HOST_ENUM_GetConfigHeader:
+		case USB_HOST_ENUM_GetConfigDescriptor:
+			Request = (USB_Request_Header_t)
+				{
+					.bmRequestType = (REQDIR_DEVICETOHOST | REQTYPE_STANDARD | REQREC_DEVICE),
+					.bRequest      = REQ_GetDescriptor,
+					.wValue        = (DTYPE_Configuration << 8),
+					.wLength       = (Step == USB_HOST_ENUM_GetConfigHeader) ? sizeof(USB_Descriptor_Configuration_Header_t)
+					                                                         : USBHost_State.ConfigLength,
+				};
+			break;
+		case USB_HOST_ENUM_SetConfiguration:
+			Request = (USB_Request_Header_t)
+				{
+					.bmRequestType = (REQDIR_HOSTTODEVICE | REQTYPE_STANDARD | REQREC_DEVICE),
+					.bRequest      = REQ_SetConfiguration,
+					.wValue        = 1,
+				};
+			break;
+		case USB_HOST_ENUM_SetLineEncoding:
+			LineEncoding = (CDC_LineEncoding_t)
+				{
+					.BaudRateBPS = USBHost_State.Baud,
+					.CharFormat  = CDC_LINEENCODING_OneStopBit,
+					.ParityType  = CDC_PARITY_None,
+					.DataBits    = 8,
+				};
+
+			Request = (USB_Request_Header_t)
+				{
+					.bmRequestType = (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE),
+					.bRequest      = CDC_REQ_SetLineEncoding,
+					.wLength       = sizeof(CDC_LineEncoding_t),
+				};
+
+			USBHost_SubmitControl(&Request, &LineEncoding);
+			return;
+		case USB_HOST_ENUM_SetControlLineState:
+			Request = (USB_Request_Header_t)
+				{
+					.bmRequestType = (REQDIR_HOSTTODEVICE | REQTYPE_CLASS | REQREC_INTERFACE),
+					.bRequest      = CDC_REQ_SetControlLineState,
+					.wValue        = (CDC_CONTROL_LINE_OUT_DTR | CDC_CONTROL_LINE_OUT_RTS),
+				};
+			break;
+		default:
+			USBHost_State.Phase = USB_HOST_PHASE_Configured;
+			return;
+	}
+
+	USBHost_SubmitControl(&Request, NULL);
+}
+
+/** Records the endpoints of the CDC function from the configuration descriptor received. */
+static void USBHost_ParseConfigDescriptor(void)
+{
+	uint16_t       Length;
+	const uint8_t* Descriptor = USBHost_GetControlData(&Length);
+
+	for (uint16_t Offset = 0; (Offset + 1) < Length; Offset += Descriptor[Offset])
+	{
+		const USB_Descriptor_Endpoint_t* Endpoint = (const USB_Descriptor_Endpoint_t*)&Descriptor[Offset];
+
+		if (!(Descriptor[Offset]))
+		  Sim_Fail("Zero length descriptor in the configuration descriptor");
+
+		if (Endpoint->Header.Type != DTYPE_Endpoint)
+		  continue;
+
+		uint8_t Number = (Endpoint->EndpointAddress & ENDPOINT_EPNUM_MASK);
+
+		if ((Endpoint->Attributes & EP_TYPE_MASK) == EP_TYPE_INTERRUPT)
+		{
+			USBHost_State.NotificationEndpoint = Number;
+		}
+		else if (Endpoint->EndpointAddress & ENDPOINT_DIR_IN)
+		{
+			USBHost_State.DataINEndpoint = Number;
+		}
+		else
+		{
+			USBHost_State.DataOUTEndpoint = Number;
+			USBHost_State.DataOUTSize     = Endpoint->EndpointSize;
+		}
+	}
+
+	if (!(USBHost_State.DataINEndpoint) || !(USBHost_State.DataOUTEndpoint))
+	  Sim_Fail("No CDC data endpoints in the configuration descriptor");
+}
+
+/** Moves the enumeration on to its next step once the control transfer of the current one has completed. */
+static void USBHost_Enumerate(void)
+{
+	uint8_t Status = USBHost_GetControlStatus();
+
+	if (Status == USB_HOST_CONTROL_Busy)
+	  return;
+	else if (Status == USB_HOST_CONTROL_Failed)
+	  Sim_Fail("Enumeration failed at step %u", USBHost_State.EnumerationStep);
+
+	uint16_t       Length;
+	const uint8_t* Data = USBHost_GetControlData(&Length);
+
+	switch (USBHost_State.EnumerationStep)
+	{
+		case USB_HOST_ENUM_GetDeviceDescriptor:
+			if ((Length < 8) || (Data[1] != DTYPE_Device))
+			  Sim_Fail("Invalid device descriptor");
+
+			USBHost_State.ControlSize = ((const USB_Descriptor_Device_t*)Data)->Endpoint0Size;
+			break;
+		case USB_HOST_ENUM_SetAddress:
+			USBHost_State.Address = USB_HOST_DEVICE_ADDRESS;
+			break;
+		case USB_HOST_ENUM_GetConfigHeader:
+			if ((Length < sizeof(USB_Descriptor_Configuration_Header_t)) || (Data[1] != DTYPE_Configuration))
+			  Sim_Fail("Invalid configuration descriptor");
+
+			USBHost_State.ConfigLength = ((const USB_Descriptor_Configuration_Header_t*)Data)->TotalConfigurationSize;
+			break;
+		case USB_HOST_ENUM_GetConfigDescriptor:
+			USBHost_ParseConfigDescriptor();
+			break;
+	}
+
+	USBHost_StartEnumerationStep(USBHost_State.EnumerationStep + 1);
+}
+
+/** Sends an IN token to the bulk IN endpoint, passing the data received on to its handler. */
+static void USBHost_RunBulkIN(void)
+{
+	if (USBHost_State.INTokensPerFrame && (USBHost_State.INTokens >= USBHost_State.INTokensPerFrame))
+	  return;
+
+	uint8_t  Packet[USB_MODEL_MAX_BANK_SIZE];
+	uint16_t Length;
+
+	USBHost_State.INTokens++;
+	USBHost_Stats.INTokens++;
+
+	switch (USBModel_In(USBHost_State.Address, USBHost_State.DataINEndpoint, Packet, &Length))
+	{
+		case USB_MODEL_HANDSHAKE_ACK:
+			USBHost_Stats.INPackets++;
+			USBHost_Stats.INBytes += Length;
+
+			if (!(Length))
+			  USBHost_Stats.INZeroLength++;
+
+			if (USBHost_State.Handlers.Received)
+			  USBHost_State.Handlers.Received(Packet, Length, Sim_Cycles);
+
+			break;
+		case USB_MODEL_HANDSHAKE_NAK:
+			USBHost_Stats.INNAKs++;
+			break;
+		default:
+			Sim_Fail("Bulk IN endpoint %u stalled or disabled", USBHost_State.DataINEndpoint);
+	}
+}
+
+/** Sends the next packet queued for the bulk OUT endpoint, or retries the one last NAKed. */
+static void USBHost_RunBulkOUT(void)
+{
+	if (!(USBHost_State.OUTPending) && USBHost_State.Handlers.Fill)
+	{
+		USBHost_State.OUTLength  = USBHost_State.Handlers.Fill(USBHost_State.OUTPacket, USBHost_State.DataOUTSize);
+		USBHost_State.OUTPending = (USBHost_State.OUTLength != 0);
+	}
+
+	if (!(USBHost_State.OUTPending))
+	  return;
+
+	switch (USBModel_Out(USBHost_State.Address, USBHost_State.DataOUTEndpoint, USBHost_State.OUTPacket,
+	                     USBHost_State.OUTLength))
+	{
+		case USB_MODEL_HANDSHAKE_ACK:
+			USBHost_Stats.OUTPackets++;
+			USBHost_Stats.OUTBytes  += USBHost_State.OUTLength;
+			USBHost_State.OUTPending = false;
+
+			if (USBHost_State.Handlers.Sent)
+			  USBHost_State.Handlers.Sent(USBHost_State.OUTLength, Sim_Cycles);
+
+			break;
+		case USB_MODEL_HANDSHAKE_NAK:
+			USBHost_Stats.OUTNAKs++;
+			break;
+		default:
+			Sim_Fail("Bulk OUT endpoint %u stalled or disabled", USBHost_State.DataOUTEndpoint);
+	}
+}
+
+/** Polls the CDC notification endpoint, once per frame. */
+static void USBHost_RunNotification(void)
+{
+	uint8_t  Packet[USB_MODEL_MAX_BANK_SIZE];
+	uint16_t Length;
+
+	if (USBHost_State.NotificationEndpoint &&
+	    (USBModel_In(USBHost_State.Address, USBHost_State.NotificationEndpoint, Packet, &Length) == USB_MODEL_HANDSHAKE_ACK))
+	{
+		USBHost_Stats.Notifications++;
+	}
+}
+
+/** Runs the transactions of the next slot of the current frame, starting a new frame on the first one. */
+static void USBHost_RunSlot(void)
+{
+	if (!(USBHost_State.Slot))
+	{
+		USBModel_StartOfFrame(USBHost_State.FrameNumber++);
+		USBHost_Stats.Frames++;
+		USBHost_State.INTokens = 0;
+
+		if (USBHost_State.Phase == USB_HOST_PHASE_Configured)
+		  USBHost_RunNotification();
+	}
+
+	USBHost_RunControlStage();
+
+	if (USBHost_State.Phase == USB_HOST_PHASE_Enumerating)
+	{
+		USBHost_Enumerate();
+	}
+	else
+	{
+		USBHost_RunBulkIN();
+		USBHost_RunBulkOUT();
+	}
+
+	USBHost_State.Slot      = ((USBHost_State.Slot + 1) % USB_HOST_SLOTS_PER_FRAME);
+	USBHost_State.NextSlot += USB_HOST_SLOT_CYCLES;
+}
+
+/** Brings the host up to the current simulated time. */
+static void USBHost_Update(void)
+{
+	switch (USBHost_State.Phase)
+	{
+		case USB_HOST_PHASE_Detached:
+			if (USBModel_IsAttached())
+			{
+				USBHost_State.Phase    = USB_HOST_PHASE_Debounce;
+				USBHost_State.PhaseEnd = (Sim_Cycles + SIM_US_TO_CYCLES(USB_HOST_DEBOUNCE_US));
+			}
+
+			return;
+		case USB_HOST_PHASE_Debounce:
+			if (Sim_Cycles >= USBHost_State.PhaseEnd)
+			{
+				USBHost_State.Phase    = USB_HOST_PHASE_Reset;
+				USBHost_State.PhaseEnd = (Sim_Cycles + SIM_US_TO_CYCLES(USB_HOST_RESET_US));
+			}
+
+			return;
+		case USB_HOST_PHASE_Reset:
+			if (Sim_Cycles < USBHost_State.PhaseEnd)
+			  return;
+
+			USBModel_BusReset();
+
+			USBHost_State.Phase    = USB_HOST_PHASE_Enumerating;
+			USBHost_State.Address  = 0;
+			USBHost_State.NextSlot = (Sim_Cycles + USB_HOST_FRAME_CYCLES);
+			USBHost_State.Slot     = 0;
+
+			USBHost_StartEnumerationStep(USB_HOST_ENUM_GetDeviceDescriptor);
+			return;
+	}
+
+	if (!(USBModel_IsAttached()))
+	  Sim_Fail("Device detached from the bus");
+
+	while (Sim_Cycles >= USBHost_State.NextSlot)
+	  USBHost_RunSlot();
+}
+
+/** Sets up the host, which waits for the device to attach.
+ *
+ *  \param[in] Baud              Baud rate set in the device's line coding.
+ *  \param[in] INTokensPerFrame  Largest number of IN tokens sent to the bulk IN endpoint in each frame, or zero for
+ *                               one in every slot.
+ *  \param[in] Handlers          Handlers of the data carried by the CDC data endpoints.
+ */
+void USBHost_Init(const uint32_t Baud,
+                  const uint8_t INTokensPerFrame,
+                  const USBHost_DataHandlers_t* const Handlers)
+{
+	USBHost_State.Baud             = Baud;
+	USBHost_State.INTokensPerFrame = INTokensPerFrame;
+	USBHost_State.Handlers         = *Handlers;
+	USBHost_State.ControlSize      = 8;
+
+	Sim_AddModel(USBHost_Update);
+}
+
+/** Indicates whether the host has finished enumerating the device and setting up its serial port.
+ *
+ *  \return Boolean \c true if the data endpoints can be used, \c false otherwise.
+ */
+bool USBHost_IsConfigured(void)
+{
+	return (USBHost_State.Phase == USB_HOST_PHASE_Configured);
+}
@@ -0,0 +1,120 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for USBHost.c.
+ */
+
+#ifndef _USB_HOST_H_
+#define _USB_HOST_H_
+
+	/* Includes: */
+		#include <LUFA/Drivers/USB/USB.h>
+
+		#include "Sim.h"
+		#include "USBModel.h"
+
+	/* Macros: */
+		/** Number of transaction slots in each 1 ms frame, each one carrying a control stage, a bulk IN token and a
+		 *  bulk OUT packet when they are due.
+		 */
+		#define USB_HOST_SLOTS_PER_FRAME    16
+
+		/** Number of CPU cycles in each 1 ms frame. */
+		#define USB_HOST_FRAME_CYCLES       SIM_US_TO_CYCLES(1000)
+
+		/** Time the host waits after the device attaches before resetting it, and duration of the reset, in
+		 *  microseconds.
+		 */
+		#define USB_HOST_DEBOUNCE_US        10000
+		#define USB_HOST_RESET_US           10000
+
+		/** Time a control transfer may take before the host gives up on it, in microseconds. */
+		#define USB_HOST_CONTROL_TIMEOUT_US 1000000
+
+		/** Largest data stage of a control transfer handled by the host, in bytes. */
+		#define USB_HOST_MAX_CONTROL_DATA   512
+
+	/* Enums: */
+		/** Enum for the state of the control transfer submitted through \ref USBHost_SubmitControl(). */
+		enum USBHost_ControlStatus_t
+		{
+			USB_HOST_CONTROL_Idle   = 0, /**< No control transfer submitted. */
+			USB_HOST_CONTROL_Busy   = 1, /**< Control transfer in progress. */
+			USB_HOST_CONTROL_Done   = 2, /**< Control transfer completed. */
+			USB_HOST_CONTROL_Failed = 3, /**< Control transfer stalled or timed out. */
+		};
+
+	/* Type Defines: */
+		/** Type define for the handlers of the data carried by the CDC data endpoints. */
+		typedef struct
+		{
+			void     (*Received)(const uint8_t* const Data,
+			                     const uint16_t Length,
+			                     const uint64_t Time); /**< Data packet received from the bulk IN endpoint. */
+			uint16_t (*Fill)(uint8_t* const Data,
+			                 const uint16_t MaxLength); /**< Fills the next packet for the bulk OUT endpoint, returning
+			                                             *   its length or zero if there is nothing to send.
+			                                             */
+			void     (*Sent)(const uint16_t Length,
+			                 const uint64_t Time); /**< The packet last filled was acknowledged by the device. */
+		} USBHost_DataHandlers_t;
+
+		/** Type define for the counts of the transactions run by the host. */
+		typedef struct
+		{
+			uint64_t Frames; /**< Start of frame packets sent. */
+			uint64_t INTokens; /**< IN tokens sent to the bulk IN endpoint. */
+			uint64_t INNAKs; /**< Of those, tokens answered with a NAK. */
+			uint64_t INPackets; /**< Of those, data packets received. */
+			uint64_t INZeroLength; /**< Of those, zero length packets received. */
+			uint64_t INBytes; /**< Bytes received from the bulk IN endpoint. */
+			uint64_t OUTPackets; /**< Data packets sent to the bulk OUT endpoint and acknowledged. */
+			uint64_t OUTNAKs; /**< Data packets sent to the bulk OUT endpoint and answered with a NAK. */
+			uint64_t OUTBytes; /**< Bytes acknowledged by the bulk OUT endpoint. */
+			uint64_t Notifications; /**< Packets received from the CDC notification endpoint. */
+			uint64_t ControlTransfers; /**< Control transfers completed. */
+		} USBHost_Stats_t;
+
+	/* External Variables: */
+		extern USBHost_Stats_t USBHost_Stats;
+
+	/* Function Prototypes: */
+		void     USBHost_Init(const uint32_t Baud,
+		                      const uint8_t INTokensPerFrame,
+		                      const USBHost_DataHandlers_t* const Handlers);
+		bool     USBHost_IsConfigured(void);
+		bool     USBHost_SubmitControl(const USB_Request_Header_t* const Request,
+		                               const void* const Data);
+		uint8_t  USBHost_GetControlStatus(void);
+		const uint8_t* USBHost_GetControlData(uint16_t* const Length);
+
+#endif
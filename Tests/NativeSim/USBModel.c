@@ -0,0 +1,771 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Model of the ATmega32U4 USB device controller: its general and device registers, the PLL, and the endpoint
+ *  banks behind \c UEINTX, \c UEDATX and \c UEBCLX. Endpoints are modelled at the level of their banks and flags,
+ *  including the double banking of the data endpoints, with the host side driving transactions through
+ *  \ref USBModel_Setup(), \ref USBModel_In() and \ref USBModel_Out() rather than through a bit level bus model.
+ *
+ *  The flags of \c UEINTX are cleared by writing them as zero, so that a read-modify-write of the register only
+ *  affects the bits it changes; a flag which reads as zero is left alone by a write of zero, as is \c FIFOCON.
+ *  Data toggles, CRCs and isochronous endpoints are not modelled.
+ */
+
+#include "USBModel.h"
+
+/** Flags of \c UEINTX latched by the model, the others being derived from the state of the banks. */
+#define USB_MODEL_LATCHED_FLAGS   ((1 << NAKINI) | (1 << NAKOUTI) | (1 << RXSTPI) | (1 << STALLEDI))
+
+/** Flags of \c UEINTX which may raise the endpoint interrupt, through the matching bit of \c UEIENX. */
+#define USB_MODEL_INTERRUPT_FLAGS ((1 << NAKINI) | (1 << NAKOUTI) | (1 << RXSTPI) | (1 << RXOUTI) | \
+                                   (1 << STALLEDI) | (1 << TXINI))
+
+/** Type define for an endpoint bank. */
+typedef struct
+{
+	uint8_t  Data[USB_MODEL_MAX_BANK_SIZE];
+	uint16_t Count;
+	bool     Busy;
+} USBModel_Bank_t;
+
+/** Type define for an endpoint. The control endpoint uses its first bank for the IN direction and its second for
+ *  the OUT direction, with the SETUP packet held apart.
+ */
+typedef struct
+{
+	uint8_t         Control;
+	uint8_t         Config0;
+	uint8_t         Config1;
+	uint8_t         InterruptEnables;
+	uint8_t         Flags;
+	bool            Configured;
+	uint16_t        Size;
+	uint8_t         Banks;
+	USBModel_Bank_t Bank[2];
+	uint8_t         CPUBank;
+	uint8_t         USBBank;
+	uint16_t        Position;
+	uint8_t         Setup[8];
+	uint8_t         SetupPosition;
+} USBModel_Endpoint_t;
+
+static USBModel_Endpoint_t USBModel_Endpoints[USB_MODEL_ENDPOINTS];
+static uint64_t            USBModel_PLLLockTime;
+
+/** Retrieves the endpoint selected by \c UENUM.
+ *
+ *  \return Pointer to the selected endpoint.
+ */
+static USBModel_Endpoint_t* USBModel_GetSelected(void)
+{
+	uint8_t Number = (SIM_STORAGE(UENUM) & 0x07);
+
+	if (Number >= USB_MODEL_ENDPOINTS)
+	  Sim_Fail("Endpoint %u selected, past the last endpoint", Number);
+
+	return &USBModel_Endpoints[Number];
+}
+
+static bool USBModel_IsControl(const USBModel_Endpoint_t* const Endpoint)
+{
+	return !(Endpoint->Config0 & ((1 << EPTYPE1) | (1 << EPTYPE0)));
+}
+
+static bool USBModel_IsIN(const USBModel_Endpoint_t* const Endpoint)
+{
+	return (Endpoint->Config0 & (1 << EPDIR));
+}
+
+/** Resets the banks of an endpoint, as a FIFO reset through \c UERST does.
+ *
+ *  \param[in,out] Endpoint  Endpoint to reset.
+ */
+static void USBModel_ResetFIFO(USBModel_Endpoint_t* const Endpoint)
+{
+	for (uint8_t i = 0; i < 2; i++)
+	{
+		Endpoint->Bank[i].Count = 0;
+		Endpoint->Bank[i].Busy  = false;
+	}
+
+	Endpoint->CPUBank       = 0;
+	Endpoint->USBBank       = 0;
+	Endpoint->Position      = 0;
+	Endpoint->SetupPosition = sizeof(Endpoint->Setup);
+	Endpoint->Flags         = 0;
+
+	if (Endpoint->Configured && !(USBModel_IsControl(Endpoint)) && USBModel_IsIN(Endpoint))
+	  Endpoint->Flags |= (1 << TXINI);
+}
+
+/** Computes the value read from \c UEINTX for an endpoint.
+ *
+ *  \param[in] Endpoint  Endpoint to read the flags of.
+ *
+ *  \return Value of the endpoint's \c UEINTX.
+ */
+static uint8_t USBModel_GetEndpointFlags(const USBModel_Endpoint_t* const Endpoint)
+{
+	uint8_t Flags = Endpoint->Flags;
+
+	if (USBModel_IsControl(Endpoint))
+	{
+		if (!(Endpoint->Bank[0].Busy))
+		  Flags |= (1 << TXINI);
+
+		if (Endpoint->Bank[1].Busy)
+		  Flags |= (1 << RXOUTI);
+	}
+	else
+	{
+		const USBModel_Bank_t* Bank = &Endpoint->Bank[Endpoint->CPUBank];
+
+		if (USBModel_IsIN(Endpoint))
+		{
+			if (!(Bank->Busy))
+			  Flags |= ((1 << FIFOCON) | ((Bank->Count < Endpoint->Size) ? (1 << RWAL) : 0));
+		}
+		else
+		{
+			if (Bank->Busy)
+			  Flags |= ((1 << FIFOCON) | ((Endpoint->Position < Bank->Count) ? (1 << RWAL) : 0));
+		}
+	}
+
+	return Flags;
+}
+
+/** Clears the flags written as zero to the \c UEINTX of a control endpoint, committing or releasing its banks. */
+static void USBModel_WriteControlFlags(USBModel_Endpoint_t* const Endpoint,
+                                       const uint8_t Cleared)
+{
+	Endpoint->Flags &= ~(Cleared & USB_MODEL_LATCHED_FLAGS);
+
+	if (Cleared & (1 << RXSTPI))
+	  Endpoint->SetupPosition = sizeof(Endpoint->Setup);
+
+	if (Cleared & (1 << TXINI))
+	  Endpoint->Bank[0].Busy = true;
+
+	if (Cleared & (1 << RXOUTI))
+	{
+		Endpoint->Bank[1].Busy  = false;
+		Endpoint->Bank[1].Count = 0;
+		Endpoint->Position      = 0;
+	}
+}
+
+/** Clears the flags written as zero to the \c UEINTX of an IN endpoint, handing its current bank to the USB side
+ *  when \c FIFOCON is cleared. A one written to \c KILLBK aborts the last bank handed over.
+ */
+static void USBModel_WriteINFlags(USBModel_Endpoint_t* const Endpoint,
+                                  const uint8_t Value,
+                                  const uint8_t Cleared)
+{
+	Endpoint->Flags &= ~(Cleared & ((1 << NAKINI) | (1 << STALLEDI) | (1 << TXINI)));
+
+	if (Value & (1 << KILLBK))
+	{
+		uint8_t Newest = (Endpoint->USBBank ^ (Endpoint->Banks - 1));
+
+		if (!(Endpoint->Bank[Newest].Busy))
+		  Newest = Endpoint->USBBank;
+
+		if (Endpoint->Bank[Newest].Busy)
+		{
+			Endpoint->Bank[Newest].Busy  = false;
+			Endpoint->Bank[Newest].Count = 0;
+			Endpoint->CPUBank            = Newest;
+			Endpoint->Flags             |= (1 << TXINI);
+		}
+	}
+
+	if (Cleared & (1 << FIFOCON))
+	{
+		Endpoint->Bank[Endpoint->CPUBank].Busy = true;
+		Endpoint->CPUBank ^= (Endpoint->Banks - 1);
+
+		if (!(Endpoint->Bank[Endpoint->CPUBank].Busy))
+		  Endpoint->Flags |= (1 << TXINI);
+	}
+}
+
+/** Clears the flags written as zero to the \c UEINTX of an OUT endpoint, releasing its current bank to the USB side
+ *  when \c FIFOCON is cleared.
+ */
+static void USBModel_WriteOUTFlags(USBModel_Endpoint_t* const Endpoint,
+                                   const uint8_t Cleared)
+{
+	Endpoint->Flags &= ~(Cleared & ((1 << NAKOUTI) | (1 << STALLEDI) | (1 << RXOUTI)));
+
+	if (Cleared & (1 << FIFOCON))
+	{
+		Endpoint->Bank[Endpoint->CPUBank].Busy  = false;
+		Endpoint->Bank[Endpoint->CPUBank].Count = 0;
+		Endpoint->Position = 0;
+		Endpoint->CPUBank ^= (Endpoint->Banks - 1);
+
+		if (Endpoint->Bank[Endpoint->CPUBank].Busy)
+		  Endpoint->Flags |= (1 << RXOUTI);
+	}
+}
+
+static uint8_t USBModel_ReadUEINTX(const bool Peek)
+{
+	return USBModel_GetEndpointFlags(USBModel_GetSelected());
+}
+
+static void USBModel_WriteUEINTX(const uint8_t Value)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetSelected();
+	uint8_t              Cleared  = (USBModel_GetEndpointFlags(Endpoint) & ~Value);
+
+	if (!(Endpoint->Configured))
+	  return;
+
+	if (USBModel_IsControl(Endpoint))
+	  USBModel_WriteControlFlags(Endpoint, Cleared);
+	else if (USBModel_IsIN(Endpoint))
+	  USBModel_WriteINFlags(Endpoint, Value, Cleared);
+	else
+	  USBModel_WriteOUTFlags(Endpoint, Cleared);
+}
+
+/** Reads the next byte of the selected endpoint: the SETUP packet while \c RXSTPI is set, then the OUT bank. */
+static uint8_t USBModel_ReadUEDATX(const bool Peek)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetSelected();
+	USBModel_Bank_t*     Bank;
+
+	if (USBModel_IsControl(Endpoint))
+	{
+		if (Endpoint->Flags & (1 << RXSTPI))
+		{
+			if (Endpoint->SetupPosition >= sizeof(Endpoint->Setup))
+			  return 0;
+
+			return Peek ? Endpoint->Setup[Endpoint->SetupPosition] : Endpoint->Setup[Endpoint->SetupPosition++];
+		}
+
+		Bank = &Endpoint->Bank[1];
+	}
+	else if (!(USBModel_IsIN(Endpoint)))
+	{
+		Bank = &Endpoint->Bank[Endpoint->CPUBank];
+	}
+	else
+	{
+		return 0;
+	}
+
+	if (!(Bank->Busy) || (Endpoint->Position >= Bank->Count))
+	  return 0;
+
+	return Peek ? Bank->Data[Endpoint->Position] : Bank->Data[Endpoint->Position++];
+}
+
+/** Writes the next byte of the IN bank of the selected endpoint, dropped when the bank is full or not writable. */
+static void USBModel_WriteUEDATX(const uint8_t Value)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetSelected();
+	USBModel_Bank_t*     Bank;
+
+	if (USBModel_IsControl(Endpoint))
+	  Bank = &Endpoint->Bank[0];
+	else if (USBModel_IsIN(Endpoint))
+	  Bank = &Endpoint->Bank[Endpoint->CPUBank];
+	else
+	  return;
+
+	if (!(Bank->Busy) && (Bank->Count < Endpoint->Size))
+	  Bank->Data[Bank->Count++] = Value;
+}
+
+/** Reads the byte count of the selected endpoint: the bytes left to read in its OUT bank or SETUP packet, or the
+ *  bytes written to its IN bank.
+ */
+static uint8_t USBModel_ReadUEBCLX(const bool Peek)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetSelected();
+
+	if (USBModel_IsControl(Endpoint))
+	{
+		if (Endpoint->Flags & (1 << RXSTPI))
+		  return (sizeof(Endpoint->Setup) - Endpoint->SetupPosition);
+		else if (Endpoint->Bank[1].Busy)
+		  return (Endpoint->Bank[1].Count - Endpoint->Position);
+		else
+		  return Endpoint->Bank[0].Count;
+	}
+
+	USBModel_Bank_t* Bank = &Endpoint->Bank[Endpoint->CPUBank];
+
+	if (USBModel_IsIN(Endpoint))
+	  return Bank->Count;
+
+	return Bank->Busy ? (Bank->Count - Endpoint->Position) : 0;
+}
+
+static uint8_t USBModel_ReadUECONX(const bool Peek)
+{
+	return USBModel_GetSelected()->Control;
+}
+
+/** Enables or disables the selected endpoint, and sets or clears its stall request through \c STALLRQ and
+ *  \c STALLRQC.
+ */
+static void USBModel_WriteUECONX(const uint8_t Value)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetSelected();
+
+	Endpoint->Control = ((Endpoint->Control & (1 << STALLRQ)) | (Value & (1 << EPEN)));
+
+	if (Value & (1 << STALLRQ))
+	  Endpoint->Control |= (1 << STALLRQ);
+
+	if (Value & (1 << STALLRQC))
+	  Endpoint->Control &= ~(1 << STALLRQ);
+
+	if (!(Value & (1 << EPEN)))
+	{
+		Endpoint->Configured = false;
+		USBModel_ResetFIFO(Endpoint);
+	}
+}
+
+static uint8_t USBModel_ReadUECFG0X(const bool Peek)
+{
+	return USBModel_GetSelected()->Config0;
+}
+
+static void USBModel_WriteUECFG0X(const uint8_t Value)
+{
+	USBModel_GetSelected()->Config0 = Value;
+}
+
+static uint8_t USBModel_ReadUECFG1X(const bool Peek)
+{
+	return USBModel_GetSelected()->Config1;
+}
+
+/** Allocates or frees the banks of the selected endpoint, checking its configuration against the controller's
+ *  limits for \c CFGOK.
+ */
+static void USBModel_WriteUECFG1X(const uint8_t Value)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetSelected();
+	uint8_t              Number   = (Endpoint - USBModel_Endpoints);
+
+	Endpoint->Config1    = Value;
+	Endpoint->Configured = false;
+
+	if (Value & (1 << ALLOC))
+	{
+		Endpoint->Size  = (8 << ((Value >> EPSIZE0) & 0x07));
+		Endpoint->Banks = ((Value & (1 << EPBK0)) ? 2 : 1);
+
+		uint16_t MaxSize = (Number == 1) ? 256 : 64;
+		uint16_t DPRAM   = 0;
+
+		for (uint8_t i = 0; i < USB_MODEL_ENDPOINTS; i++)
+		{
+			if ((USBModel_Endpoints[i].Config1 & (1 << ALLOC)) && (USBModel_Endpoints[i].Control & (1 << EPEN)))
+			  DPRAM += (USBModel_Endpoints[i].Size * USBModel_Endpoints[i].Banks);
+		}
+
+		Endpoint->Configured = ((Endpoint->Control & (1 << EPEN)) && (Endpoint->Size <= MaxSize) &&
+		                        !(Value & (1 << EPBK1)) && !(Number == 0 && Endpoint->Banks > 1) &&
+		                        (DPRAM <= USB_MODEL_DPRAM_SIZE));
+	}
+
+	USBModel_ResetFIFO(Endpoint);
+}
+
+static uint8_t USBModel_ReadUESTA0X(const bool Peek)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetSelected();
+	uint8_t              Busy     = (Endpoint->Bank[0].Busy + Endpoint->Bank[1].Busy);
+
+	if (USBModel_IsControl(Endpoint))
+	  Busy = Endpoint->Bank[0].Busy;
+
+	return ((Endpoint->Configured ? (1 << CFGOK) : 0) | (Busy << NBUSYBK0));
+}
+
+static uint8_t USBModel_ReadUESTA1X(const bool Peek)
+{
+	return (USBModel_GetSelected()->CPUBank << CURRBK0);
+}
+
+static uint8_t USBModel_ReadUEIENX(const bool Peek)
+{
+	return USBModel_GetSelected()->InterruptEnables;
+}
+
+static void USBModel_WriteUEIENX(const uint8_t Value)
+{
+	USBModel_GetSelected()->InterruptEnables = Value;
+}
+
+/** Resets the FIFOs of the endpoints whose bits are written as one. */
+static void USBModel_WriteUERST(const uint8_t Value)
+{
+	for (uint8_t i = 0; i < USB_MODEL_ENDPOINTS; i++)
+	{
+		if (Value & (1 << i))
+		  USBModel_ResetFIFO(&USBModel_Endpoints[i]);
+	}
+}
+
+/** Reads the endpoints with an enabled endpoint interrupt raised, one bit each. */
+static uint8_t USBModel_ReadUEINT(const bool Peek)
+{
+	uint8_t Interrupts = 0;
+
+	for (uint8_t i = 0; i < USB_MODEL_ENDPOINTS; i++)
+	{
+		const USBModel_Endpoint_t* Endpoint = &USBModel_Endpoints[i];
+
+		if (USBModel_GetEndpointFlags(Endpoint) & Endpoint->InterruptEnables & USB_MODEL_INTERRUPT_FLAGS)
+		  Interrupts |= (1 << i);
+	}
+
+	return Interrupts;
+}
+
+static void USBModel_WriteUEINT(const uint8_t Value)
+{
+}
+
+/** Resets the device controller, when it is disabled through \c USBE. */
+static void USBModel_ResetController(void)
+{
+	for (uint8_t i = 0; i < USB_MODEL_ENDPOINTS; i++)
+	{
+		USBModel_Endpoints[i] = (USBModel_Endpoint_t){ .Configured = false };
+		USBModel_ResetFIFO(&USBModel_Endpoints[i]);
+	}
+
+	SIM_STORAGE(UDCON)  = (1 << DETACH);
+	SIM_STORAGE(UDINT)  = 0;
+	SIM_STORAGE(UDIEN)  = 0;
+	SIM_STORAGE(UDADDR) = 0;
+	SIM_STORAGE(UENUM)  = 0;
+}
+
+/** Stores \c USBCON, resetting the controller when it is disabled and raising \c VBUSTI when the OTG pad is enabled
+ *  with VBUS present.
+ */
+static void USBModel_WriteUSBCON(const uint8_t Value)
+{
+	uint8_t Previous = SIM_STORAGE(USBCON);
+
+	SIM_STORAGE(USBCON) = Value;
+
+	if ((Previous & (1 << USBE)) && !(Value & (1 << USBE)))
+	  USBModel_ResetController();
+
+	if (!(Previous & (1 << OTGPADE)) && (Value & (1 << OTGPADE)))
+	  SIM_STORAGE(USBINT) |= (1 << VBUSTI);
+}
+
+/** Reads the VBUS level, always present once the OTG pad is enabled, and the ID pin of a device. */
+static uint8_t USBModel_ReadUSBSTA(const bool Peek)
+{
+	return ((1 << ID) | ((SIM_STORAGE(USBCON) & (1 << OTGPADE)) ? (1 << VBUS) : 0));
+}
+
+/** Clears the interrupt flags written as zero, for \c UDINT and \c USBINT. */
+static void USBModel_WriteUDINT(const uint8_t Value)
+{
+	SIM_STORAGE(UDINT) &= Value;
+}
+
+static void USBModel_WriteUSBINT(const uint8_t Value)
+{
+	SIM_STORAGE(USBINT) &= Value;
+}
+
+static bool USBModel_IsPLLLocked(void)
+{
+	return ((SIM_STORAGE(PLLCSR) & (1 << PLLE)) && (Sim_Cycles >= USBModel_PLLLockTime));
+}
+
+static uint8_t USBModel_ReadPLLCSR(const bool Peek)
+{
+	return (SIM_STORAGE(PLLCSR) | (USBModel_IsPLLLocked() ? (1 << PLOCK) : 0));
+}
+
+/** Stores \c PLLCSR, starting the lock time of the PLL when it is enabled. */
+static void USBModel_WritePLLCSR(const uint8_t Value)
+{
+	if (!(SIM_STORAGE(PLLCSR) & (1 << PLLE)) && (Value & (1 << PLLE)))
+	  USBModel_PLLLockTime = (Sim_Cycles + SIM_US_TO_CYCLES(USB_MODEL_PLL_LOCK_US));
+
+	SIM_STORAGE(PLLCSR) = (Value & ~(1 << PLOCK));
+}
+
+static bool USBModel_IsGeneralPending(void)
+{
+	return ((SIM_STORAGE(UDINT) & SIM_STORAGE(UDIEN) & 0x7D) ||
+	        ((SIM_STORAGE(USBINT) & (1 << VBUSTI)) && (SIM_STORAGE(USBCON) & (1 << VBUSTE))));
+}
+
+static bool USBModel_IsEndpointPending(void)
+{
+	return (USBModel_ReadUEINT(true) != 0);
+}
+
+/** Attaches the USB controller model to its registers and interrupt vectors. */
+void USBModel_Init(void)
+{
+	SIM_STORAGE(USBCON) = (1 << FRZCLK);
+	USBModel_ResetController();
+
+	Sim_MapRegister(&USBCON,  NULL, USBModel_WriteUSBCON);
+	Sim_MapRegister(&USBSTA,  USBModel_ReadUSBSTA, NULL);
+	Sim_MapRegister(&USBINT,  NULL, USBModel_WriteUSBINT);
+	Sim_MapRegister(&PLLCSR,  USBModel_ReadPLLCSR, USBModel_WritePLLCSR);
+	Sim_MapRegister(&UDINT,   NULL, USBModel_WriteUDINT);
+	Sim_MapRegister(&UEINTX,  USBModel_ReadUEINTX, USBModel_WriteUEINTX);
+	Sim_MapRegister(&UEDATX,  USBModel_ReadUEDATX, USBModel_WriteUEDATX);
+	Sim_MapRegister(&UEBCLX,  USBModel_ReadUEBCLX, NULL);
+	Sim_MapRegister(&UECONX,  USBModel_ReadUECONX, USBModel_WriteUECONX);
+	Sim_MapRegister(&UECFG0X, USBModel_ReadUECFG0X, USBModel_WriteUECFG0X);
+	Sim_MapRegister(&UECFG1X, USBModel_ReadUECFG1X, USBModel_WriteUECFG1X);
+	Sim_MapRegister(&UESTA0X, USBModel_ReadUESTA0X, NULL);
+	Sim_MapRegister(&UESTA1X, USBModel_ReadUESTA1X, NULL);
+	Sim_MapRegister(&UEIENX,  USBModel_ReadUEIENX, USBModel_WriteUEIENX);
+	Sim_MapRegister(&UERST,   NULL, USBModel_WriteUERST);
+	Sim_MapRegister(&UEINT,   USBModel_ReadUEINT, USBModel_WriteUEINT);
+
+	Sim_AddInterrupt(SIM_VECTOR_USB_GEN, USBModel_IsGeneralPending, NULL);
+	Sim_AddInterrupt(SIM_VECTOR_USB_COM, USBModel_IsEndpointPending, NULL);
+}
+
+/** Indicates whether the device is attached to the bus, with its controller enabled and clocked.
+ *
+ *  \return Boolean \c true if the device presents its pull-up to the host, \c false otherwise.
+ */
+bool USBModel_IsAttached(void)
+{
+	return ((SIM_STORAGE(USBCON) & (1 << USBE)) && !(SIM_STORAGE(USBCON) & (1 << FRZCLK)) &&
+	        !(SIM_STORAGE(UDCON) & (1 << DETACH)) && USBModel_IsPLLLocked());
+}
+
+/** Ends a bus reset driven by the host, disabling all but the control endpoint and clearing the device address. */
+void USBModel_BusReset(void)
+{
+	for (uint8_t i = 1; i < USB_MODEL_ENDPOINTS; i++)
+	{
+		USBModel_Endpoints[i].Control   &= ~(1 << EPEN);
+		USBModel_Endpoints[i].Configured = false;
+		USBModel_ResetFIFO(&USBModel_Endpoints[i]);
+	}
+
+	USBModel_ResetFIFO(&USBModel_Endpoints[0]);
+
+	SIM_STORAGE(UDADDR) = 0;
+	SIM_STORAGE(UDINT) |= (1 << EORSTI);
+}
+
+/** Receives a start of frame packet from the host.
+ *
+ *  \param[in] FrameNumber  Number of the frame started.
+ */
+void USBModel_StartOfFrame(const uint16_t FrameNumber)
+{
+	SIM_STORAGE(UDFNUML) = (FrameNumber & 0xFF);
+	SIM_STORAGE(UDFNUMH) = ((FrameNumber >> 8) & 0x07);
+	SIM_STORAGE(UDINT)  |= (1 << SOFI);
+}
+
+/** Retrieves the endpoint addressed by a host transaction, if the device responds to it.
+ *
+ *  \param[in] Address         Device address of the transaction.
+ *  \param[in] EndpointNumber  Endpoint number of the transaction.
+ *  \param[in] IsIN            Whether the transaction is an IN transaction.
+ *
+ *  \return Pointer to the addressed endpoint, or \c NULL if the transaction is ignored.
+ */
+static USBModel_Endpoint_t* USBModel_GetAddressed(const uint8_t Address,
+                                                  const uint8_t EndpointNumber,
+                                                  const bool IsIN)
+{
+	uint8_t DeviceAddress = (SIM_STORAGE(UDADDR) & (1 << ADDEN)) ? (SIM_STORAGE(UDADDR) & 0x7F) : 0;
+
+	if (!(USBModel_IsAttached()) || (Address != DeviceAddress) || (EndpointNumber >= USB_MODEL_ENDPOINTS))
+	  return NULL;
+
+	USBModel_Endpoint_t* Endpoint = &USBModel_Endpoints[EndpointNumber];
+
+	if (!(Endpoint->Configured) || !(Endpoint->Control & (1 << EPEN)))
+	  return NULL;
+
+	if (!(USBModel_IsControl(Endpoint)) && (USBModel_IsIN(Endpoint) != IsIN))
+	  return NULL;
+
+	return Endpoint;
+}
+
+/** Receives a SETUP transaction from the host on the control endpoint, which is always acknowledged.
+ *
+ *  \param[in] Address  Device address of the transaction.
+ *  \param[in] Request  Eight byte request packet.
+ *
+ *  \return Handshake of the device, a value from \ref USBModel_Handshakes_t.
+ */
+uint8_t USBModel_Setup(const uint8_t Address,
+                       const uint8_t* const Request)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetAddressed(Address, 0, false);
+
+	if (!(Endpoint) || !(USBModel_IsControl(Endpoint)))
+	  return USB_MODEL_HANDSHAKE_None;
+
+	USBModel_ResetFIFO(Endpoint);
+
+	for (uint8_t i = 0; i < sizeof(Endpoint->Setup); i++)
+	  Endpoint->Setup[i] = Request[i];
+
+	Endpoint->SetupPosition = 0;
+	Endpoint->Flags        |= (1 << RXSTPI);
+	Endpoint->Control      &= ~(1 << STALLRQ);
+
+	return USB_MODEL_HANDSHAKE_ACK;
+}
+
+/** Receives an IN transaction from the host, returning the oldest bank handed over by the firmware.
+ *
+ *  \param[in]  Address         Device address of the transaction.
+ *  \param[in]  EndpointNumber  Endpoint number of the transaction.
+ *  \param[out] Data            Buffer for the data packet, of at least the endpoint size.
+ *  \param[out] Length          Length of the data packet, when acknowledged.
+ *
+ *  \return Handshake of the device, a value from \ref USBModel_Handshakes_t.
+ */
+uint8_t USBModel_In(const uint8_t Address,
+                    const uint8_t EndpointNumber,
+                    uint8_t* const Data,
+                    uint16_t* const Length)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetAddressed(Address, EndpointNumber, true);
+
+	if (!(Endpoint))
+	  return USB_MODEL_HANDSHAKE_None;
+
+	if (Endpoint->Control & (1 << STALLRQ))
+	{
+		Endpoint->Flags |= (1 << STALLEDI);
+		return USB_MODEL_HANDSHAKE_STALL;
+	}
+
+	uint8_t          BankIndex = USBModel_IsControl(Endpoint) ? 0 : Endpoint->USBBank;
+	USBModel_Bank_t* Bank      = &Endpoint->Bank[BankIndex];
+
+	if (!(Bank->Busy))
+	{
+		Endpoint->Flags |= (1 << NAKINI);
+		return USB_MODEL_HANDSHAKE_NAK;
+	}
+
+	for (uint16_t i = 0; i < Bank->Count; i++)
+	  Data[i] = Bank->Data[i];
+
+	*Length     = Bank->Count;
+	Bank->Count = 0;
+	Bank->Busy  = false;
+
+	if (!(USBModel_IsControl(Endpoint)))
+	{
+		Endpoint->USBBank ^= (Endpoint->Banks - 1);
+
+		if (BankIndex == Endpoint->CPUBank)
+		  Endpoint->Flags |= (1 << TXINI);
+	}
+
+	return USB_MODEL_HANDSHAKE_ACK;
+}
+
+/** Receives an OUT transaction from the host into the next free bank of the endpoint.
+ *
+ *  \param[in] Address         Device address of the transaction.
+ *  \param[in] EndpointNumber  Endpoint number of the transaction.
+ *  \param[in] Data            Data packet, no longer than the endpoint size.
+ *  \param[in] Length          Length of the data packet.
+ *
+ *  \return Handshake of the device, a value from \ref USBModel_Handshakes_t.
+ */
+uint8_t USBModel_Out(const uint8_t Address,
+                     const uint8_t EndpointNumber,
+                     const uint8_t* const Data,
+                     const uint16_t Length)
+{
+	USBModel_Endpoint_t* Endpoint = USBModel_GetAddressed(Address, EndpointNumber, false);
+
+	if (!(Endpoint))
+	  return USB_MODEL_HANDSHAKE_None;
+
+	if (Length > Endpoint->Size)
+	  Sim_Fail("OUT packet of %u bytes to endpoint %u of %u bytes", Length, EndpointNumber, Endpoint->Size);
+
+	if (Endpoint->Control & (1 << STALLRQ))
+	{
+		Endpoint->Flags |= (1 << STALLEDI);
+		return USB_MODEL_HANDSHAKE_STALL;
+	}
+
+	uint8_t          BankIndex = USBModel_IsControl(Endpoint) ? 1 : Endpoint->USBBank;
+	USBModel_Bank_t* Bank      = &Endpoint->Bank[BankIndex];
+
+	if (Bank->Busy)
+	{
+		Endpoint->Flags |= (1 << NAKOUTI);
+		return USB_MODEL_HANDSHAKE_NAK;
+	}
+
+	for (uint16_t i = 0; i < Length; i++)
+	  Bank->Data[i] = Data[i];
+
+	Bank->Count = Length;
+	Bank->Busy  = true;
+
+	if (!(USBModel_IsControl(Endpoint)))
+	{
+		Endpoint->USBBank ^= (Endpoint->Banks - 1);
+
+		if (BankIndex == Endpoint->CPUBank)
+		  Endpoint->Flags |= (1 << RXOUTI);
+	}
+
+	return USB_MODEL_HANDSHAKE_ACK;
+}
@@ -0,0 +1,81 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for USBModel.c.
+ */
+
+#ifndef _USB_MODEL_H_
+#define _USB_MODEL_H_
+
+	/* Includes: */
+		#include "Sim.h"
+
+	/* Macros: */
+		/** Number of endpoints of the modelled USB controller, including the control endpoint. */
+		#define USB_MODEL_ENDPOINTS          7
+
+		/** Largest endpoint bank of the modelled USB controller, in bytes. */
+		#define USB_MODEL_MAX_BANK_SIZE      256
+
+		/** Size of the USB controller's endpoint DPRAM, in bytes. */
+		#define USB_MODEL_DPRAM_SIZE         832
+
+		/** Time taken by the PLL to lock once enabled, in microseconds. */
+		#define USB_MODEL_PLL_LOCK_US        100
+
+	/* Enums: */
+		/** Enum for the handshakes of the device to a host transaction. */
+		enum USBModel_Handshakes_t
+		{
+			USB_MODEL_HANDSHAKE_ACK   = 0, /**< Transaction completed. */
+			USB_MODEL_HANDSHAKE_NAK   = 1, /**< Endpoint not ready, to be retried later. */
+			USB_MODEL_HANDSHAKE_STALL = 2, /**< Endpoint halted. */
+			USB_MODEL_HANDSHAKE_None  = 3, /**< No response, the address or endpoint is not valid. */
+		};
+
+	/* Function Prototypes: */
+		void    USBModel_Init(void);
+		bool    USBModel_IsAttached(void);
+		void    USBModel_BusReset(void);
+		void    USBModel_StartOfFrame(const uint16_t FrameNumber);
+		uint8_t USBModel_Setup(const uint8_t Address,
+		                       const uint8_t* const Request);
+		uint8_t USBModel_In(const uint8_t Address,
+		                    const uint8_t EndpointNumber,
+		                    uint8_t* const Data,
+		                    uint16_t* const Length);
+		uint8_t USBModel_Out(const uint8_t Address,
+		                     const uint8_t EndpointNumber,
+		                     const uint8_t* const Data,
+		                     const uint16_t Length);
+
+#endif
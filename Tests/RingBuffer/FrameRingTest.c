@@ -0,0 +1,424 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stress test and benchmark for the variable length frame ring buffer. The exhaustive test stores and
+ *  retrieves every frame length from every writer position, covering both ways a frame is wrapped to the start
+ *  of the storage array. The stress test moves numbered frames between the main thread and a simulated ISR
+ *  preempting it at random points, from a timer and between single stepped instructions, in both directions, checking every frame's length, content and order and
+ *  that the drop counter matches the frames rejected. The cost of each operation is then measured without
+ *  preemption.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Preempt.h"
+#include "TestHelpers.h"
+
+#include "../../LUFA/Drivers/Misc/FrameRing.h"
+
+/** Size of the buffer used by the stress and policy tests, small so that it wraps around often. */
+#define STRESS_BUFFER_SIZE              256
+
+/** Length of the sequence number at the start of each test frame. */
+#define FRAME_HEADER_SIZE               4
+
+/** Largest test frame, half the stress buffer less its prefix so that every frame eventually fits. */
+#define STRESS_MAX_FRAME                ((STRESS_BUFFER_SIZE / 2) - FRAME_RING_PREFIX_SIZE)
+
+/** Size of the buffer used by the benchmarks. */
+#define BENCH_BUFFER_SIZE               4096
+
+/** Length of the frames moved by the benchmarks. */
+#define BENCH_FRAME_SIZE                16
+
+/** Number of failed checks, reported at exit. */
+uint32_t Failures;
+
+/** Buffer and storage shared between the main thread and the simulated ISR during the stress tests. */
+static FrameRing_t Stress_Buffer;
+static uint8_t     Stress_Buffer_Data[STRESS_BUFFER_SIZE];
+
+/** Sequence numbers of the next frame inserted into and removed from the stress buffer. */
+static volatile uint32_t Stress_InsertSequence;
+static volatile uint32_t Stress_RemoveSequence;
+
+/** Number of frames rejected by the stress buffer, as seen by the inserting thread. */
+static volatile uint32_t Stress_Rejected;
+
+/** Pseudo-random state of the simulated ISR, kept apart from the main thread's. */
+static uint32_t Stress_ISRRandom = 0x1234567;
+
+/** Fills a test frame with its sequence number and the matching payload.
+ *
+ *  \param[out] Frame     Frame payload to fill.
+ *  \param[in]  Sequence  Sequence number of the frame.
+ *  \param[in]  Length    Length of the frame, at least \ref FRAME_HEADER_SIZE.
+ */
+static void FillFrame(uint8_t* const Frame,
+                      const uint32_t Sequence,
+                      const uint16_t Length)
+{
+	memcpy(Frame, &Sequence, FRAME_HEADER_SIZE);
+
+	for (uint16_t i = FRAME_HEADER_SIZE; i < Length; i++)
+	  Frame[i] = StreamByte((Sequence * 67) + i);
+}
+
+/** Checks a test frame's length and payload against the sequence number it holds.
+ *
+ *  \param[in] Frame     Frame payload to check.
+ *  \param[in] Length    Length of the frame.
+ *  \param[in] Sequence  Expected sequence number of the frame, reported if its length is invalid.
+ *
+ *  \return Sequence number held in the frame.
+ */
+static uint32_t CheckFrame(const uint8_t* const Frame,
+                           const uint16_t Length,
+                           const uint32_t Sequence)
+{
+	uint32_t Stored = 0;
+
+	CHECK((Length >= FRAME_HEADER_SIZE) && (Length <= STRESS_MAX_FRAME), "frame %lu has length %u", (unsigned long)Sequence, Length);
+
+	if (Length < FRAME_HEADER_SIZE)
+	  return Sequence;
+
+	memcpy(&Stored, Frame, FRAME_HEADER_SIZE);
+
+	for (uint16_t i = FRAME_HEADER_SIZE; i < Length; i++)
+	{
+		if (Frame[i] != StreamByte((Stored * 67) + i))
+		{
+			CHECK(false, "frame %lu corrupt at byte %u", (unsigned long)Stored, i);
+			break;
+		}
+	}
+
+	return Stored;
+}
+
+/** Checks every frame length stored from every reachable writer position, including frames which no longer fit
+ *  before the end of the storage array and must be wrapped to its start, with or without room for a skip marker.
+ */
+static void Test_FrameWrap(const uint16_t Size)
+{
+	uint8_t     Data[Size];
+	uint8_t     Frame[Size];
+	FrameRing_t Buffer;
+
+	for (uint16_t Offset = 0; Offset < Size; Offset++)
+	{
+		for (uint16_t Length = 0; Length <= ((Size / 2) - FRAME_RING_PREFIX_SIZE); Length++)
+		{
+			FrameRing_InitBuffer(&Buffer, Data, Size, FRAME_RING_POLICY_DropNewest);
+
+			/* Move the writer and reader to the offset with empty and single byte frames */
+			for (uint16_t Position = 0; Position < Offset; )
+			{
+				uint16_t Filler = ((Offset - Position) == 3) ? 1 : 0;
+
+				if ((Offset - Position) == 1)
+				  break;
+
+				FrameRing_Insert(&Buffer, Frame, Filler);
+
+				uint16_t FillerLength;
+				if (FrameRing_Peek(&Buffer, &FillerLength))
+				  FrameRing_Release(&Buffer);
+
+				Position += (FRAME_RING_PREFIX_SIZE + Filler);
+			}
+
+			for (uint16_t i = 0; i < Length; i++)
+			  Frame[i] = StreamByte(Offset + i);
+
+			CHECK(FrameRing_Insert(&Buffer, Frame, Length), "frame of %u at %u rejected", Length, Buffer.In);
+
+			uint16_t PeekLength = 0;
+			uint8_t* Peeked     = FrameRing_Peek(&Buffer, &PeekLength);
+
+			CHECK(Peeked && (PeekLength == Length), "frame of %u at %u peeked with length %u", Length, Offset, PeekLength);
+			CHECK(Peeked && !(memcmp(Peeked, Frame, Length)), "frame of %u at %u corrupt", Length, Offset);
+			CHECK(Peeked && ((Peeked + Length) <= &Data[Size]), "frame of %u at %u overruns the array", Length, Offset);
+
+			if (Peeked)
+			  FrameRing_Release(&Buffer);
+
+			CHECK(FrameRing_IsEmpty(&Buffer) && !(FrameRing_GetUsed(&Buffer)), "frame of %u at %u not fully released", Length, Offset);
+		}
+	}
+}
+
+/** Checks the drop oldest policy from a single thread, which must keep every frame stored or counted as dropped
+ *  and deliver the surviving frames in order.
+ */
+static void Test_DropOldest(const uint32_t Frames)
+{
+	uint8_t     Frame[STRESS_MAX_FRAME];
+	FrameRing_t Buffer;
+	uint32_t    Random    = 0xBEEF;
+	uint32_t    Delivered = 0;
+	uint32_t    Expected  = 0;
+
+	FrameRing_InitBuffer(&Buffer, Stress_Buffer_Data, sizeof(Stress_Buffer_Data), FRAME_RING_POLICY_DropOldest);
+
+	for (uint32_t Sequence = 0; Sequence < Frames; Sequence++)
+	{
+		uint16_t Length = (FRAME_HEADER_SIZE + (NextRandom(&Random) % (STRESS_MAX_FRAME - FRAME_HEADER_SIZE + 1)));
+
+		FillFrame(Frame, Sequence, Length);
+		CHECK(FrameRing_Insert(&Buffer, Frame, Length), "drop oldest rejected frame %lu", (unsigned long)Sequence);
+		CHECK(FrameRing_GetUsed(&Buffer) <= STRESS_BUFFER_SIZE, "drop oldest used %u bytes", FrameRing_GetUsed(&Buffer));
+
+		/* Remove a frame now and then, so that the buffer alternates between filling up and dropping */
+		if (NextRandom(&Random) & 1)
+		{
+			uint16_t PeekLength;
+			uint8_t* Peeked = FrameRing_Peek(&Buffer, &PeekLength);
+
+			if (Peeked)
+			{
+				uint32_t Stored = CheckFrame(Peeked, PeekLength, Expected);
+				CHECK(Stored >= Expected, "drop oldest delivered frame %lu after %lu", (unsigned long)Stored, (unsigned long)Expected);
+
+				Expected = (Stored + 1);
+				Delivered++;
+				FrameRing_Release(&Buffer);
+			}
+		}
+	}
+
+	uint32_t Remaining = FrameRing_GetFrameCount(&Buffer);
+	uint32_t Dropped   = FrameRing_GetDroppedCount(&Buffer);
+
+	CHECK((Delivered + Dropped + Remaining) == Frames, "drop oldest: %lu delivered, %lu dropped, %lu stored of %lu",
+	      (unsigned long)Delivered, (unsigned long)Dropped, (unsigned long)Remaining, (unsigned long)Frames);
+}
+
+/** Inserts the next numbered frame of a random length, counting it as rejected if it does not fit. */
+static void Stress_InsertFrame(uint32_t* const Random)
+{
+	uint8_t  Frame[STRESS_MAX_FRAME];
+	uint32_t Sequence = Stress_InsertSequence;
+	uint16_t Length   = (FRAME_HEADER_SIZE + (NextRandom(Random) % (STRESS_MAX_FRAME - FRAME_HEADER_SIZE + 1)));
+
+	FillFrame(Frame, Sequence, Length);
+
+	if (FrameRing_Insert(&Stress_Buffer, Frame, Length))
+	  Stress_InsertSequence = (Sequence + 1);
+	else
+	  Stress_Rejected++;
+}
+
+/** Removes the next frame if there is one, checking it is the next in sequence. */
+static void Stress_RemoveFrame(void)
+{
+	uint16_t Length;
+	uint8_t* Frame = FrameRing_Peek(&Stress_Buffer, &Length);
+
+	if (!(Frame))
+	  return;
+
+	uint32_t Stored = CheckFrame(Frame, Length, Stress_RemoveSequence);
+	CHECK(Stored == Stress_RemoveSequence, "frame %lu found, expected %lu", (unsigned long)Stored, (unsigned long)Stress_RemoveSequence);
+
+	Stress_RemoveSequence++;
+
+	FrameRing_Release(&Stress_Buffer);
+}
+
+/** Simulated receive ISR for the stress test, inserting one frame. */
+static void Stress_InsertISR(void)
+{
+	Stress_InsertFrame(&Stress_ISRRandom);
+}
+
+/** Simulated transmit ISR for the stress test, removing one frame. */
+static void Stress_RemoveISR(void)
+{
+	Stress_RemoveFrame();
+}
+
+/** Runs one stress test direction until the requested number of simulated interrupts has been taken. */
+static void Stress_Run(const char* const Name,
+                       const bool ISRInserts,
+                       const uint8_t Mode,
+                       const uint32_t Period,
+                       const uint64_t Interrupts)
+{
+	uint32_t Random = 0xC0FFEE;
+
+	FrameRing_InitBuffer(&Stress_Buffer, Stress_Buffer_Data, sizeof(Stress_Buffer_Data), FRAME_RING_POLICY_DropNewest);
+	Stress_InsertSequence = 0;
+	Stress_RemoveSequence = 0;
+	Stress_Rejected       = 0;
+
+	double Start = Preempt_Seconds();
+	Preempt_Start(ISRInserts ? Stress_InsertISR : Stress_RemoveISR, Mode, Period);
+
+	while ((Preempt_GetTotal() < Interrupts) && (Failures < 10))
+	{
+		if (ISRInserts)
+		  Stress_RemoveFrame();
+		else
+		  Stress_InsertFrame(&Random);
+
+		CHECK(FrameRing_GetUsed(&Stress_Buffer) <= STRESS_BUFFER_SIZE, "%s: %u bytes used", Name, FrameRing_GetUsed(&Stress_Buffer));
+	}
+
+	Preempt_Stop();
+
+	while (!(FrameRing_IsEmpty(&Stress_Buffer)))
+	  Stress_RemoveFrame();
+
+	uint32_t Rejected = ((Stress_Rejected > 0xFFFF) ? 0xFFFF : Stress_Rejected);
+
+	CHECK(Stress_InsertSequence == Stress_RemoveSequence, "%s: %lu frames inserted, %lu removed", Name,
+	      (unsigned long)Stress_InsertSequence, (unsigned long)Stress_RemoveSequence);
+	CHECK(FrameRing_GetDroppedCount(&Stress_Buffer) == Rejected, "%s: %u frames counted as dropped, %lu rejected", Name,
+	      FrameRing_GetDroppedCount(&Stress_Buffer), (unsigned long)Stress_Rejected);
+	CHECK(!(FrameRing_GetUsed(&Stress_Buffer)), "%s: %u bytes used when empty", Name, FrameRing_GetUsed(&Stress_Buffer));
+
+	Preempt_Stats_t Stats   = Preempt_GetStats();
+	double          Elapsed = (Preempt_Seconds() - Start);
+
+	printf("  %-22s %10llu preemptions %8llu deferred %11lu frames checked, %lu rejected in %.1f s\n", Name,
+	       (unsigned long long)Stats.Preemptions, (unsigned long long)Stats.Deferred,
+	       (unsigned long)Stress_RemoveSequence, (unsigned long)Stress_Rejected, Elapsed);
+}
+
+/** Benchmark buffer and storage, and a sink which keeps the removed data live. */
+static FrameRing_t      Bench_Buffer;
+static uint8_t          Bench_Buffer_Data[BENCH_BUFFER_SIZE];
+static volatile uint8_t Bench_Sink;
+
+/** Reports the rate of a benchmarked operation. */
+static void Bench_Report(const char* const Name,
+                         const uint64_t Operations,
+                         const uint64_t Bytes,
+                         const double Seconds)
+{
+	printf("  %-22s %8.1f Mops/s %9.1f MB/s\n", Name, (Operations / Seconds / 1e6), (Bytes / Seconds / 1e6));
+}
+
+/** Measures the rate of each buffer operation, filling and emptying the buffer in alternate phases so that the
+ *  insertion and removal operations are timed separately. Each phase fills at most half the buffer, so that every
+ *  frame fits wherever the writer has wrapped to.
+ */
+static void Bench_Run(const uint32_t Rounds)
+{
+	uint8_t  Frame[BENCH_FRAME_SIZE];
+	uint16_t FramesPerRound = ((BENCH_BUFFER_SIZE / 2) / (FRAME_RING_PREFIX_SIZE + BENCH_FRAME_SIZE));
+	double   InsertTime     = 0;
+	double   ReserveTime    = 0;
+	double   RemoveTime     = 0;
+
+	memset(Frame, 0x55, sizeof(Frame));
+	FrameRing_InitBuffer(&Bench_Buffer, Bench_Buffer_Data, sizeof(Bench_Buffer_Data), FRAME_RING_POLICY_DropNewest);
+
+	for (uint32_t Round = 0; Round < Rounds; Round++)
+	{
+		double Start = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < FramesPerRound; i++)
+		  FrameRing_Insert(&Bench_Buffer, Frame, BENCH_FRAME_SIZE);
+
+		double Middle = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < FramesPerRound; i++)
+		{
+			uint16_t Length;
+			uint8_t* Peeked = FrameRing_Peek(&Bench_Buffer, &Length);
+
+			Bench_Sink = Peeked[0];
+			FrameRing_Release(&Bench_Buffer);
+		}
+
+		double End = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < FramesPerRound; i++)
+		{
+			uint8_t* Reserved = FrameRing_Reserve(&Bench_Buffer, BENCH_FRAME_SIZE);
+
+			Reserved[0] = i;
+			FrameRing_Commit(&Bench_Buffer, 1);
+		}
+
+		ReserveTime += (Preempt_Seconds() - End);
+		RemoveTime  += (End - Middle);
+		InsertTime  += (Middle - Start);
+
+		while (!(FrameRing_IsEmpty(&Bench_Buffer)))
+		{
+			uint16_t Length;
+			if (FrameRing_Peek(&Bench_Buffer, &Length))
+			  FrameRing_Release(&Bench_Buffer);
+		}
+	}
+
+	uint64_t FrameOps = ((uint64_t)Rounds * FramesPerRound);
+	Bench_Report("Insert (16 B)", FrameOps, (FrameOps * BENCH_FRAME_SIZE), InsertTime);
+	Bench_Report("Peek+Release (16 B)", FrameOps, (FrameOps * BENCH_FRAME_SIZE), RemoveTime);
+	Bench_Report("Reserve+Commit", FrameOps, FrameOps, ReserveTime);
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t Interrupts = (argc > 1) ? strtoull(argv[1], NULL, 0) : 1000000;
+	uint32_t IntervalUS = (argc > 2) ? strtoul(argv[2], NULL, 0) : 10;
+	uint64_t Steps      = (argc > 3) ? strtoull(argv[3], NULL, 0) : 200000;
+	uint32_t MaxStride  = (argc > 4) ? strtoul(argv[4], NULL, 0) : 8;
+
+	printf("FrameRing.h\n");
+
+	printf(" Exhaustive wrap tests\n");
+	Test_FrameWrap(64);
+	Test_FrameWrap(67);
+
+	printf(" Drop oldest policy test\n");
+	Test_DropOldest(100000);
+
+	printf(" Preemption stress tests\n");
+	Stress_Run("timer: ISR Insert", true, PREEMPT_MODE_Timer, IntervalUS, Interrupts);
+	Stress_Run("timer: ISR Peek", false, PREEMPT_MODE_Timer, IntervalUS, Interrupts);
+#if defined(PREEMPT_HAS_STEP_MODE)
+	Stress_Run("step: ISR Insert", true, PREEMPT_MODE_Step, MaxStride, Steps);
+	Stress_Run("step: ISR Peek", false, PREEMPT_MODE_Step, MaxStride, Steps);
+#endif
+
+	printf(" Benchmarks\n");
+	Bench_Run(20000);
+
+	printf(" %s\n", Failures ? "FAILED" : "PASSED");
+	return (Failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,242 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Single core interrupt model for the host builds. Either a periodic \c SIGALRM or, on x86, the single step
+ *  trap stands in for the interrupt source: its handler runs the simulated ISR to completion at once when the
+ *  global interrupt mask is set, preempting the main thread wherever it happens to be, or marks it pending to be
+ *  run by \ref SetGlobalInterruptMask() otherwise. The main thread is never resumed in the middle of the ISR,
+ *  matching an AVR with nested interrupts disabled.
+ *
+ *  The timer only rarely lands inside a short window such as the two byte stores of a 16-bit index, which the
+ *  single step mode reaches at every instruction boundary instead.
+ */
+
+#include <signal.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "Preempt.h"
+#include "Stub/Common.h"
+
+volatile sig_atomic_t Sim_InterruptsEnabled = true;
+volatile sig_atomic_t Sim_InterruptPending;
+
+static volatile Preempt_ISR_t Preempt_ISR;
+static volatile uint64_t      Preempt_Preemptions;
+static volatile uint64_t      Preempt_Deferred;
+static volatile uint8_t       Preempt_Mode;
+
+/** Instructions left to step before the next simulated interrupt, and the largest such count. */
+static uint32_t Preempt_StepsLeft;
+static uint32_t Preempt_MaxStride;
+static uint32_t Preempt_StrideRandom = 0xACE1;
+
+#if defined(PREEMPT_HAS_STEP_MODE)
+/** Sets or clears the x86 trap flag of the calling thread, single stepping it while set.
+ *
+ *  \param[in] Enable  Whether single stepping should be enabled.
+ *
+ *  \return Boolean \c true if single stepping was enabled before the call, \c false otherwise.
+ */
+static __attribute__((noinline)) bool Preempt_SetTrapFlag(const bool Enable)
+{
+	unsigned long Flags;
+
+	__asm__ __volatile__("pushf\n\tpop %0" : "=r" (Flags) :: "memory");
+
+	bool WasEnabled = ((Flags & 0x100) != 0);
+	Flags = Enable ? (Flags | 0x100) : (Flags & ~0x100UL);
+
+	__asm__ __volatile__("push %0\n\tpopf" :: "r" (Flags) : "memory", "cc");
+	return WasEnabled;
+}
+#endif
+
+/** Runs the simulated ISR with the interrupt mask cleared, and again for as long as another interrupt was raised
+ *  while it ran.
+ */
+static void Preempt_RunISR(void)
+{
+	do
+	{
+		Sim_InterruptsEnabled = false;
+		Sim_InterruptPending  = false;
+		GCC_MEMORY_BARRIER();
+
+		Preempt_ISR();
+
+		GCC_MEMORY_BARRIER();
+		Sim_InterruptsEnabled = true;
+	} while (Sim_InterruptPending);
+}
+
+/** Runs the interrupt held pending while the mask was cleared, called once the mask has been restored. */
+void Sim_RunPendingInterrupt(void)
+{
+	if (!(Preempt_ISR) || !(Sim_InterruptsEnabled) || !(Sim_InterruptPending))
+	  return;
+
+	Preempt_Deferred++;
+
+#if defined(PREEMPT_HAS_STEP_MODE)
+	/* The ISR runs to completion, so it is not stepped itself */
+	bool Stepping = Preempt_SetTrapFlag(false);
+	Preempt_RunISR();
+	Preempt_SetTrapFlag(Stepping);
+#else
+	Preempt_RunISR();
+#endif
+}
+
+/** Signal handler for the preemption timer and single step trap, standing in for the interrupt controller. */
+static void Preempt_Signal(int Signal)
+{
+	if (!(Preempt_ISR))
+	  return;
+
+	/* An interrupt left pending when the mask was restored is serviced at once, as on the AVR */
+	if (Sim_InterruptsEnabled && Sim_InterruptPending)
+	{
+		Preempt_Deferred++;
+		Preempt_RunISR();
+		return;
+	}
+
+	if (Signal == SIGTRAP)
+	{
+		if (--Preempt_StepsLeft)
+		  return;
+
+		Preempt_StrideRandom ^= (Preempt_StrideRandom << 13);
+		Preempt_StrideRandom ^= (Preempt_StrideRandom >> 17);
+		Preempt_StrideRandom ^= (Preempt_StrideRandom << 5);
+		Preempt_StepsLeft = (1 + (Preempt_StrideRandom % Preempt_MaxStride));
+	}
+
+	if (!(Sim_InterruptsEnabled))
+	{
+		Sim_InterruptPending = true;
+		return;
+	}
+
+	Preempt_Preemptions++;
+	Preempt_RunISR();
+}
+
+/** Starts raising the simulated interrupt, clearing the preemption counts. In \ref PREEMPT_MODE_Step the calling
+ *  thread is single stepped from here until \ref Preempt_Stop() is called, from the same function.
+ *
+ *  \param[in] ISR     Simulated ISR to run on each interrupt.
+ *  \param[in] Mode    Way the interrupt is raised, a value from \ref Preempt_Modes_t.
+ *  \param[in] Period  Period of the interrupt, in microseconds or in instructions depending on the mode.
+ */
+void Preempt_Start(const Preempt_ISR_t ISR,
+                   const uint8_t Mode,
+                   const uint32_t Period)
+{
+	struct sigaction Action = { .sa_handler = Preempt_Signal };
+	sigemptyset(&Action.sa_mask);
+	sigaction((Mode == PREEMPT_MODE_Step) ? SIGTRAP : SIGALRM, &Action, NULL);
+
+	Preempt_Preemptions  = 0;
+	Preempt_Deferred     = 0;
+	Sim_InterruptPending = false;
+	Preempt_Mode         = Mode;
+	Preempt_MaxStride    = Period;
+	Preempt_StepsLeft    = Period;
+	Preempt_ISR          = ISR;
+
+	if (Mode == PREEMPT_MODE_Step)
+	{
+#if defined(PREEMPT_HAS_STEP_MODE)
+		Preempt_SetTrapFlag(true);
+#endif
+		return;
+	}
+
+	struct itimerval Timer =
+		{
+			.it_interval = { .tv_sec = 0, .tv_usec = Period },
+			.it_value    = { .tv_sec = 0, .tv_usec = Period },
+		};
+
+	setitimer(ITIMER_REAL, &Timer, NULL);
+}
+
+/** Stops the simulated interrupt, after which the ISR is no longer run. */
+void Preempt_Stop(void)
+{
+	if (Preempt_Mode == PREEMPT_MODE_Step)
+	{
+#if defined(PREEMPT_HAS_STEP_MODE)
+		Preempt_SetTrapFlag(false);
+#endif
+	}
+	else
+	{
+		struct itimerval Timer = { { 0, 0 }, { 0, 0 } };
+		setitimer(ITIMER_REAL, &Timer, NULL);
+	}
+
+	Preempt_ISR          = NULL;
+	Sim_InterruptPending = false;
+}
+
+/** Retrieves the total number of simulated interrupts run since \ref Preempt_Start().
+ *
+ *  \return Sum of the preempting and deferred interrupt counts.
+ */
+uint64_t Preempt_GetTotal(void)
+{
+	return (Preempt_Preemptions + Preempt_Deferred);
+}
+
+/** Retrieves the counts of simulated interrupts run since \ref Preempt_Start().
+ *
+ *  \return Preempting and deferred interrupt counts.
+ */
+Preempt_Stats_t Preempt_GetStats(void)
+{
+	return (Preempt_Stats_t){ .Preemptions = Preempt_Preemptions, .Deferred = Preempt_Deferred };
+}
+
+/** Reads a monotonic clock, for timing the stress runs and benchmarks.
+ *
+ *  \return Monotonic time in seconds.
+ */
+double Preempt_Seconds(void)
+{
+	struct timespec Now;
+	clock_gettime(CLOCK_MONOTONIC, &Now);
+
+	return (Now.tv_sec + (Now.tv_nsec / 1e9));
+}
@@ -0,0 +1,82 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for Preempt.c.
+ */
+
+#ifndef _PREEMPT_H_
+#define _PREEMPT_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+
+	/* Macros: */
+		#if defined(__x86_64__) || defined(__i386__)
+			/** Indicates that \ref PREEMPT_MODE_Step is available, through the x86 trap flag. */
+			#define PREEMPT_HAS_STEP_MODE
+		#endif
+
+	/* Enums: */
+		/** Enum for the ways the simulated interrupt can be raised by \ref Preempt_Start(). */
+		enum Preempt_Modes_t
+		{
+			PREEMPT_MODE_Timer = 0, /**< Raised by a periodic \c SIGALRM, asynchronously to the main thread. The period
+			                         *   is given in microseconds.
+			                         */
+			PREEMPT_MODE_Step  = 1, /**< Raised between instructions of the main thread while single stepping it, after
+			                         *   a pseudo-random number of instructions up to the given period, so that every
+			                         *   instruction boundary is eventually preempted.
+			                         */
+		};
+
+	/* Type Defines: */
+		/** Type define for a simulated interrupt service routine, run by the preemption timer. */
+		typedef void (*Preempt_ISR_t)(void);
+
+		/** Type define for the counts of simulated interrupts run since \ref Preempt_Start(). */
+		typedef struct
+		{
+			uint64_t Preemptions; /**< Interrupts run at once, preempting the main thread at an arbitrary instruction. */
+			uint64_t Deferred; /**< Interrupts held pending by a cleared interrupt mask, run when it was restored. */
+		} Preempt_Stats_t;
+
+	/* Function Prototypes: */
+		void     Preempt_Start(const Preempt_ISR_t ISR,
+		                       const uint8_t Mode,
+		                       const uint32_t Period);
+		void     Preempt_Stop(void);
+		uint64_t Preempt_GetTotal(void);
+		Preempt_Stats_t Preempt_GetStats(void);
+		double   Preempt_Seconds(void);
+
+#endif
@@ -0,0 +1,687 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stress test and benchmark for the byte ring buffers. This file is built once against RingBuffer.h and
+ *  once against RingBufferSPSC.h (with \c RING_BUFFER_SPSC defined), as both headers define the same interface.
+ *
+ *  The exhaustive tests check every wrap position of the span and block operations, and for the lock-free
+ *  buffer every torn 16-bit index value an ISR can observe while the main thread is half way through storing
+ *  it, both by arithmetic and by single stepping the actual stores. The stress tests then move a known byte
+ *  stream through the buffer between the main thread and a simulated ISR preempting it at random points, from
+ *  a timer and between single stepped instructions, in both directions, checking every byte for order and
+ *  integrity. Finally the cost of each operation is measured without preemption.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "Preempt.h"
+#include "TestHelpers.h"
+
+#if defined(RING_BUFFER_SPSC)
+	#include "../../LUFA/Drivers/Misc/RingBufferSPSC.h"
+	#define BUFFER_VARIANT              "RingBufferSPSC.h"
+#else
+	#include "../../LUFA/Drivers/Misc/RingBuffer.h"
+	#define BUFFER_VARIANT              "RingBuffer.h"
+#endif
+
+/** Size of the buffer used by the stress tests, small so that it wraps around often. */
+#define STRESS_BUFFER_SIZE              64
+
+/** Size of the buffer used by the benchmarks. */
+#define BENCH_BUFFER_SIZE               4096
+
+/** Length of the blocks and spans moved by the block benchmarks. */
+#define BENCH_BLOCK_SIZE                64
+
+/** Largest burst of bytes moved by the simulated ISR at each interrupt. */
+#define STRESS_MAX_BURST                8
+
+/** Number of failed checks, reported at exit. */
+uint32_t Failures;
+
+/** Buffer and storage shared between the main thread and the simulated ISR during the stress tests. */
+static RingBuffer_t Stress_Buffer;
+static uint8_t      Stress_Buffer_Data[STRESS_BUFFER_SIZE];
+
+/** Sequence numbers of the next byte inserted into and removed from the stress buffer. */
+static volatile uint32_t Stress_InsertSequence;
+static volatile uint32_t Stress_RemoveSequence;
+
+/** Pseudo-random state of the simulated ISR, kept apart from the main thread's. */
+static uint32_t Stress_ISRRandom = 0x1234567;
+
+/** Moves the buffer's indices forward without data, so that the next operation starts at a given offset. */
+static void AdvanceTo(RingBuffer_t* const Buffer,
+                      const uint16_t Offset)
+{
+	for (uint16_t i = 0; i < Offset; i++)
+	{
+		RingBuffer_Insert(Buffer, 0);
+		(void)RingBuffer_Remove(Buffer);
+	}
+}
+
+/** Checks that the buffer holds exactly the given range of the test stream, removing it. */
+static void ExpectStream(RingBuffer_t* const Buffer,
+                         uint32_t Sequence,
+                         const uint16_t Count,
+                         const char* const Context)
+{
+	uint16_t Stored = RingBuffer_GetCount(Buffer);
+	CHECK(Stored == Count, "%s: %u bytes stored, expected %u", Context, Stored, Count);
+
+	for (uint16_t i = 0; i < Stored; i++, Sequence++)
+	{
+		uint8_t Data = RingBuffer_Remove(Buffer);
+		CHECK(Data == StreamByte(Sequence), "%s: byte %u is %02X, expected %02X", Context, i, Data, StreamByte(Sequence));
+	}
+}
+
+/** Checks every combination of starting offset, stored count and removed length for RingBuffer_RemoveSpan(),
+ *  including removals which end exactly at, or wrap past, the end of the storage array.
+ */
+static void Test_RemoveSpanWrap(const uint16_t Size)
+{
+	uint8_t      Data[Size];
+	RingBuffer_t Buffer;
+
+	for (uint16_t Offset = 0; Offset < Size; Offset++)
+	{
+		for (uint16_t Count = 1; Count <= Size; Count++)
+		{
+			for (uint16_t Length = 0; Length <= Count; Length++)
+			{
+				RingBuffer_InitBuffer(&Buffer, Data, Size);
+				AdvanceTo(&Buffer, Offset);
+
+				for (uint16_t i = 0; i < Count; i++)
+				  RingBuffer_Insert(&Buffer, StreamByte(i));
+
+				RingBuffer_RemoveSpan(&Buffer, Length);
+				ExpectStream(&Buffer, Length, (Count - Length), "RemoveSpan wrap");
+
+				/* The buffer must be usable to its full size again after the wrap */
+				for (uint16_t i = 0; i < Size; i++)
+				  RingBuffer_Insert(&Buffer, StreamByte(i));
+
+				ExpectStream(&Buffer, 0, Size, "RemoveSpan refill");
+			}
+		}
+	}
+}
+
+/** Checks RingBuffer_PeekSpan() and RingBuffer_PeekSegments() at every starting offset and stored count. */
+static void Test_PeekWrap(const uint16_t Size)
+{
+	uint8_t      Data[Size];
+	RingBuffer_t Buffer;
+
+	for (uint16_t Offset = 0; Offset < Size; Offset++)
+	{
+		for (uint16_t Count = 0; Count <= Size; Count++)
+		{
+			RingBuffer_InitBuffer(&Buffer, Data, Size);
+			AdvanceTo(&Buffer, Offset);
+
+			for (uint16_t i = 0; i < Count; i++)
+			  RingBuffer_Insert(&Buffer, StreamByte(i));
+
+			uint16_t SpanLength;
+			uint8_t* Span = RingBuffer_PeekSpan(&Buffer, &SpanLength);
+			uint16_t BytesToEnd = (Size - Offset);
+
+			CHECK(SpanLength == ((Count < BytesToEnd) ? Count : BytesToEnd),
+			      "PeekSpan at %u with %u stored: length %u", Offset, Count, SpanLength);
+
+			uint8_t* Second;
+			uint16_t FirstLength;
+			uint16_t SecondLength;
+			uint8_t* First = RingBuffer_PeekSegments(&Buffer, &FirstLength, &Second, &SecondLength);
+
+			CHECK((First == Span) && (FirstLength == SpanLength) && ((FirstLength + SecondLength) == Count),
+			      "PeekSegments at %u with %u stored: %u + %u", Offset, Count, FirstLength, SecondLength);
+
+			for (uint16_t i = 0; i < Count; i++)
+			{
+				uint8_t Byte = (i < FirstLength) ? First[i] : Second[i - FirstLength];
+				CHECK(Byte == StreamByte(i), "PeekSegments at %u with %u stored: byte %u", Offset, Count, i);
+			}
+		}
+	}
+}
+
+/** Checks RingBuffer_InsertBlock() and RingBuffer_RemoveBlock() at every starting offset and length, including
+ *  lengths beyond the free space and stored count which must be truncated.
+ */
+static void Test_BlockWrap(const uint16_t Size)
+{
+	uint8_t      Data[Size];
+	uint8_t      Block[Size + 1];
+	RingBuffer_t Buffer;
+
+	for (uint16_t i = 0; i <= Size; i++)
+	  Block[i] = StreamByte(i);
+
+	for (uint16_t Offset = 0; Offset < Size; Offset++)
+	{
+		for (uint16_t Length = 0; Length <= (Size + 1); Length++)
+		{
+			RingBuffer_InitBuffer(&Buffer, Data, Size);
+			AdvanceTo(&Buffer, Offset);
+
+			uint16_t Inserted = RingBuffer_InsertBlock(&Buffer, Block, Length);
+			uint16_t Expected = (Length > Size) ? Size : Length;
+			CHECK(Inserted == Expected, "InsertBlock at %u of %u: inserted %u", Offset, Length, Inserted);
+
+			uint8_t  Removed[Size + 1];
+			uint16_t RemovedCount = RingBuffer_RemoveBlock(&Buffer, Removed, (Size + 1));
+			CHECK(RemovedCount == Inserted, "RemoveBlock at %u of %u: removed %u", Offset, Length, RemovedCount);
+			CHECK(!(memcmp(Removed, Block, RemovedCount)), "RemoveBlock at %u of %u: data mismatch", Offset, Length);
+			CHECK(RingBuffer_IsEmpty(&Buffer), "RemoveBlock at %u of %u: buffer not empty", Offset, Length);
+		}
+	}
+}
+
+#if defined(RING_BUFFER_SPSC)
+/** Checks every torn index value that can be observed by the other thread while a 16-bit index is stored low
+ *  byte first, as \c RingBuffer_StoreIndex() does on 8-bit architectures. A torn removal index must never let the
+ *  inserting thread see more free space than there is, and a torn insertion index must never let the removing
+ *  thread see more stored bytes than there are.
+ */
+static void Test_TornIndex(const uint16_t Size,
+                           const uint16_t StepLimit)
+{
+	uint8_t      Data[Size];
+	RingBuffer_t Buffer;
+
+	RingBuffer_InitBuffer(&Buffer, Data, Size);
+
+	for (uint32_t Old = 0; Old <= 0xFFFF; Old++)
+	{
+		for (uint16_t Step = 1; Step <= StepLimit; Step++)
+		{
+			uint16_t New  = (Old + Step);
+			uint16_t Torn = ((Old & 0xFF00) | (New & 0x00FF));
+
+			/* Removal index torn, seen by the inserting thread with the fewest and the most bytes left stored */
+			for (uint16_t Left = 0; Left <= (Size - Step); Left += (Size - Step) ? (Size - Step) : 1)
+			{
+				Buffer.In  = (New + Left);
+				Buffer.Out = New;
+				uint16_t TrueFree = RingBuffer_GetFreeCount(&Buffer);
+
+				Buffer.Out = Torn;
+				uint16_t SeenFree = RingBuffer_GetFreeCount(&Buffer);
+
+				CHECK(SeenFree <= TrueFree, "Out %04X->%04X torn to %04X: %u free seen, %u free", (uint16_t)Old, New, Torn, SeenFree, TrueFree);
+
+				if (!(Size - Step))
+				  break;
+			}
+
+			/* Insertion index torn, seen by the removing thread with the fewest and the most bytes already stored */
+			for (uint16_t Held = 0; Held <= (Size - Step); Held += (Size - Step) ? (Size - Step) : 1)
+			{
+				Buffer.Out = (Old - Held);
+				Buffer.In  = New;
+				uint16_t TrueCount = RingBuffer_GetCount(&Buffer);
+
+				Buffer.In = Torn;
+				uint16_t SeenCount = RingBuffer_GetCount(&Buffer);
+
+				CHECK(SeenCount <= TrueCount, "In %04X->%04X torn to %04X: %u stored seen, %u stored", (uint16_t)Old, New, Torn, SeenCount, TrueCount);
+
+				if (!(Size - Step))
+				  break;
+			}
+		}
+	}
+}
+#endif
+
+#if defined(RING_BUFFER_SPSC) && defined(PREEMPT_HAS_STEP_MODE)
+/** Buffer observed by \ref Observe_ISR() while the main thread moves one of its indices. */
+static RingBuffer_t Observe_Buffer;
+
+/** Whether the observed operation is in progress, and whether it removes from the buffer. */
+static volatile bool Observe_Active;
+static volatile bool Observe_Removing;
+
+/** Largest free space or stored count the observing ISR may see during the operation. */
+static volatile uint16_t Observe_Limit;
+
+/** Simulated ISR run at every instruction of an index update, checking what the opposite thread would see. */
+static void Observe_ISR(void)
+{
+	if (!(Observe_Active))
+	  return;
+
+	if (Observe_Removing)
+	{
+		uint16_t SeenFree = RingBuffer_GetFreeCount(&Observe_Buffer);
+		CHECK(SeenFree <= Observe_Limit, "Out %04X mid-store: %u free seen, %u free", Observe_Buffer.Out, SeenFree, Observe_Limit);
+	}
+	else
+	{
+		uint16_t SeenCount = RingBuffer_GetCount(&Observe_Buffer);
+		CHECK(SeenCount <= Observe_Limit, "In %04X mid-store: %u stored seen, %u stored", Observe_Buffer.In, SeenCount, Observe_Limit);
+	}
+}
+
+/** Runs the ISR at every instruction of the actual index stores around each carry into the high index byte, so
+ *  that every partially stored value the implementation can expose is checked, whatever order it stores the
+ *  bytes in. A removal must never let the inserting ISR see more free space than it leaves, and an insertion must
+ *  never let the removing ISR see more stored bytes than it leaves.
+ */
+static void Test_TornIndexStepped(const uint16_t Size)
+{
+	uint8_t Data[Size];
+	uint8_t Block[4] = { 0 };
+
+	RingBuffer_InitBuffer(&Observe_Buffer, Data, Size);
+	Preempt_Start(Observe_ISR, PREEMPT_MODE_Step, 1);
+
+	for (uint32_t Carry = 0x100; Carry <= 0x10000; Carry += 0x100)
+	{
+		for (uint16_t Old = (Carry - 4); Old != (uint16_t)(Carry + 1); Old++)
+		{
+			for (uint16_t Step = 1; Step <= 4; Step++)
+			{
+				Observe_Buffer.Out = Old;
+				Observe_Buffer.In  = (Old + Size);
+				Observe_Removing   = true;
+				Observe_Limit      = Step;
+
+				Observe_Active = true;
+				RingBuffer_RemoveSpan(&Observe_Buffer, Step);
+				Observe_Active = false;
+
+				Observe_Buffer.Out = Old;
+				Observe_Buffer.In  = Old;
+				Observe_Removing   = false;
+
+				Observe_Active = true;
+				if (Step == 1)
+				  RingBuffer_Insert(&Observe_Buffer, 0);
+				else
+				  (void)RingBuffer_InsertBlock(&Observe_Buffer, Block, Step);
+				Observe_Active = false;
+			}
+		}
+	}
+
+	Preempt_Stats_t Stats = Preempt_GetStats();
+	Preempt_Stop();
+
+	printf("  %llu instruction boundaries observed\n", (unsigned long long)Stats.Preemptions);
+}
+#endif
+
+/** Simulated USART receive ISR for the stress test, inserting a burst of the test stream into the buffer. */
+static void Stress_InsertISR(void)
+{
+	uint32_t Random   = NextRandom(&Stress_ISRRandom);
+	uint16_t Burst    = (1 + (Random % STRESS_MAX_BURST));
+	uint32_t Sequence = Stress_InsertSequence;
+
+	if (Random & 0x100)
+	{
+		uint8_t Block[STRESS_MAX_BURST];
+
+		for (uint16_t i = 0; i < Burst; i++)
+		  Block[i] = StreamByte(Sequence + i);
+
+		Sequence += RingBuffer_InsertBlock(&Stress_Buffer, Block, Burst);
+	}
+	else
+	{
+		while (Burst-- && !(RingBuffer_IsFull(&Stress_Buffer)))
+		  RingBuffer_Insert(&Stress_Buffer, StreamByte(Sequence++));
+	}
+
+	Stress_InsertSequence = Sequence;
+}
+
+/** Simulated USART transmit ISR for the stress test, removing a burst of bytes and checking them against the
+ *  test stream.
+ */
+static void Stress_RemoveISR(void)
+{
+	uint32_t Random   = NextRandom(&Stress_ISRRandom);
+	uint16_t Burst    = (1 + (Random % STRESS_MAX_BURST));
+	uint32_t Sequence = Stress_RemoveSequence;
+
+	if (Random & 0x100)
+	{
+		uint8_t  Block[STRESS_MAX_BURST];
+		uint16_t Removed = RingBuffer_RemoveBlock(&Stress_Buffer, Block, Burst);
+
+		for (uint16_t i = 0; i < Removed; i++, Sequence++)
+		  CHECK(Block[i] == StreamByte(Sequence), "ISR RemoveBlock: byte %lu corrupt", (unsigned long)Sequence);
+	}
+	else
+	{
+		while (Burst-- && !(RingBuffer_IsEmpty(&Stress_Buffer)))
+		{
+			uint8_t Data = RingBuffer_Remove(&Stress_Buffer);
+			CHECK(Data == StreamByte(Sequence), "ISR Remove: byte %lu corrupt", (unsigned long)Sequence);
+			Sequence++;
+		}
+	}
+
+	Stress_RemoveSequence = Sequence;
+}
+
+/** Removes bytes from the stress buffer in the main thread with a randomly chosen operation, checking them
+ *  against the test stream.
+ */
+static void Stress_MainRemove(uint32_t* const Random)
+{
+	uint32_t Sequence = Stress_RemoveSequence;
+	uint32_t Choice   = NextRandom(Random);
+
+	switch (Choice & 3)
+	{
+		case 0:
+			if (!(RingBuffer_IsEmpty(&Stress_Buffer)))
+			{
+				uint8_t Data = RingBuffer_Remove(&Stress_Buffer);
+				CHECK(Data == StreamByte(Sequence), "Remove: byte %lu corrupt", (unsigned long)Sequence);
+				Sequence++;
+			}
+
+			break;
+		case 1:
+		{
+			uint8_t  Block[STRESS_BUFFER_SIZE];
+			uint16_t Removed = RingBuffer_RemoveBlock(&Stress_Buffer, Block, (1 + ((Choice >> 8) % STRESS_BUFFER_SIZE)));
+
+			for (uint16_t i = 0; i < Removed; i++, Sequence++)
+			  CHECK(Block[i] == StreamByte(Sequence), "RemoveBlock: byte %lu corrupt", (unsigned long)Sequence);
+
+			break;
+		}
+		case 2:
+		{
+			uint16_t SpanLength;
+			uint8_t* Span = RingBuffer_PeekSpan(&Stress_Buffer, &SpanLength);
+
+			for (uint16_t i = 0; i < SpanLength; i++, Sequence++)
+			  CHECK(Span[i] == StreamByte(Sequence), "PeekSpan: byte %lu corrupt", (unsigned long)Sequence);
+
+			RingBuffer_RemoveSpan(&Stress_Buffer, SpanLength);
+			break;
+		}
+		default:
+		{
+			uint8_t* Second;
+			uint16_t FirstLength;
+			uint16_t SecondLength;
+			uint8_t* First = RingBuffer_PeekSegments(&Stress_Buffer, &FirstLength, &Second, &SecondLength);
+
+			for (uint16_t i = 0; i < FirstLength; i++, Sequence++)
+			  CHECK(First[i] == StreamByte(Sequence), "PeekSegments: byte %lu corrupt", (unsigned long)Sequence);
+
+			for (uint16_t i = 0; i < SecondLength; i++, Sequence++)
+			  CHECK(Second[i] == StreamByte(Sequence), "PeekSegments: byte %lu corrupt", (unsigned long)Sequence);
+
+			RingBuffer_RemoveSpan(&Stress_Buffer, (FirstLength + SecondLength));
+			break;
+		}
+	}
+
+	Stress_RemoveSequence = Sequence;
+}
+
+/** Inserts bytes of the test stream into the stress buffer in the main thread with a randomly chosen operation. */
+static void Stress_MainInsert(uint32_t* const Random)
+{
+	uint32_t Sequence = Stress_InsertSequence;
+	uint32_t Choice   = NextRandom(Random);
+
+	if (Choice & 1)
+	{
+		uint8_t  Block[STRESS_BUFFER_SIZE];
+		uint16_t Length = (1 + ((Choice >> 8) % STRESS_BUFFER_SIZE));
+
+		for (uint16_t i = 0; i < Length; i++)
+		  Block[i] = StreamByte(Sequence + i);
+
+		Sequence += RingBuffer_InsertBlock(&Stress_Buffer, Block, Length);
+	}
+	else if (!(RingBuffer_IsFull(&Stress_Buffer)))
+	{
+		RingBuffer_Insert(&Stress_Buffer, StreamByte(Sequence++));
+	}
+
+	Stress_InsertSequence = Sequence;
+}
+
+/** Runs one stress test direction until the requested number of simulated interrupts has been taken, checking
+ *  that the buffer never reports more bytes than are in flight and that no byte is lost or duplicated.
+ */
+static void Stress_Run(const char* const Name,
+                       const bool ISRInserts,
+                       const uint8_t Mode,
+                       const uint32_t Period,
+                       const uint64_t Interrupts)
+{
+	uint32_t Random = 0xC0FFEE;
+
+	RingBuffer_InitBuffer(&Stress_Buffer, Stress_Buffer_Data, sizeof(Stress_Buffer_Data));
+	Stress_InsertSequence = 0;
+	Stress_RemoveSequence = 0;
+
+	double Start = Preempt_Seconds();
+	Preempt_Start(ISRInserts ? Stress_InsertISR : Stress_RemoveISR, Mode, Period);
+
+	while (Preempt_GetTotal() < Interrupts)
+	{
+		if (ISRInserts)
+		  Stress_MainRemove(&Random);
+		else
+		  Stress_MainInsert(&Random);
+
+		/* Only the ISR can have moved its own sequence number on, so the in-flight count is an upper bound */
+		uint16_t Count    = RingBuffer_GetCount(&Stress_Buffer);
+		uint32_t InFlight = (Stress_InsertSequence - Stress_RemoveSequence);
+
+		CHECK(Count <= STRESS_BUFFER_SIZE, "%s: count %u exceeds the buffer size", Name, Count);
+		CHECK(InFlight <= STRESS_BUFFER_SIZE, "%s: %lu bytes in flight", Name, (unsigned long)InFlight);
+
+		if (Failures >= 10)
+		  break;
+	}
+
+	Preempt_Stop();
+
+	/* Drain what is left from the main thread, then the stream must match end to end */
+	while (!(RingBuffer_IsEmpty(&Stress_Buffer)))
+	{
+		uint8_t Data = RingBuffer_Remove(&Stress_Buffer);
+		CHECK(Data == StreamByte(Stress_RemoveSequence), "%s drain: byte corrupt", Name);
+		Stress_RemoveSequence++;
+	}
+
+	CHECK(Stress_InsertSequence == Stress_RemoveSequence, "%s: %lu bytes inserted, %lu removed", Name,
+	      (unsigned long)Stress_InsertSequence, (unsigned long)Stress_RemoveSequence);
+
+	Preempt_Stats_t Stats   = Preempt_GetStats();
+	double          Elapsed = (Preempt_Seconds() - Start);
+
+	printf("  %-22s %10llu preemptions %8llu deferred %11lu bytes checked in %.1f s\n", Name,
+	       (unsigned long long)Stats.Preemptions, (unsigned long long)Stats.Deferred,
+	       (unsigned long)Stress_RemoveSequence, Elapsed);
+}
+
+/** Benchmark buffer and storage, and a sink which keeps the removed data live. */
+static RingBuffer_t     Bench_Buffer;
+static uint8_t          Bench_Buffer_Data[BENCH_BUFFER_SIZE];
+static volatile uint8_t Bench_Sink;
+
+/** Reports the rate of a benchmarked operation. */
+static void Bench_Report(const char* const Name,
+                         const uint64_t Operations,
+                         const uint64_t Bytes,
+                         const double Seconds)
+{
+	printf("  %-22s %8.1f Mops/s %9.1f MB/s\n", Name, (Operations / Seconds / 1e6), (Bytes / Seconds / 1e6));
+}
+
+/** Measures the rate of each buffer operation, filling and emptying the buffer in alternate phases so that the
+ *  insertion and removal operations are timed separately.
+ */
+static void Bench_Run(const uint32_t Rounds)
+{
+	uint8_t Block[BENCH_BLOCK_SIZE];
+	double  InsertTime = 0;
+	double  RemoveTime = 0;
+
+	memset(Block, 0x55, sizeof(Block));
+	RingBuffer_InitBuffer(&Bench_Buffer, Bench_Buffer_Data, sizeof(Bench_Buffer_Data));
+
+	for (uint32_t Round = 0; Round < Rounds; Round++)
+	{
+		double Start = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < BENCH_BUFFER_SIZE; i++)
+		  RingBuffer_Insert(&Bench_Buffer, i);
+
+		double Middle = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < BENCH_BUFFER_SIZE; i++)
+		  Bench_Sink = RingBuffer_Remove(&Bench_Buffer);
+
+		RemoveTime += (Preempt_Seconds() - Middle);
+		InsertTime += (Middle - Start);
+	}
+
+	uint64_t ByteOps = ((uint64_t)Rounds * BENCH_BUFFER_SIZE);
+	Bench_Report("Insert", ByteOps, ByteOps, InsertTime);
+	Bench_Report("Remove", ByteOps, ByteOps, RemoveTime);
+
+	uint64_t BlockOps = ((uint64_t)Rounds * (BENCH_BUFFER_SIZE / BENCH_BLOCK_SIZE));
+	InsertTime = 0;
+	RemoveTime = 0;
+
+	for (uint32_t Round = 0; Round < Rounds; Round++)
+	{
+		double Start = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < (BENCH_BUFFER_SIZE / BENCH_BLOCK_SIZE); i++)
+		  RingBuffer_InsertBlock(&Bench_Buffer, Block, BENCH_BLOCK_SIZE);
+
+		double Middle = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < (BENCH_BUFFER_SIZE / BENCH_BLOCK_SIZE); i++)
+		  RingBuffer_RemoveBlock(&Bench_Buffer, Block, BENCH_BLOCK_SIZE);
+
+		Bench_Sink = Block[0];
+
+		RemoveTime += (Preempt_Seconds() - Middle);
+		InsertTime += (Middle - Start);
+	}
+
+	Bench_Report("InsertBlock (64 B)", BlockOps, (BlockOps * BENCH_BLOCK_SIZE), InsertTime);
+	Bench_Report("RemoveBlock (64 B)", BlockOps, (BlockOps * BENCH_BLOCK_SIZE), RemoveTime);
+
+	RemoveTime = 0;
+
+	for (uint32_t Round = 0; Round < Rounds; Round++)
+	{
+		for (uint16_t i = 0; i < (BENCH_BUFFER_SIZE / BENCH_BLOCK_SIZE); i++)
+		  RingBuffer_InsertBlock(&Bench_Buffer, Block, BENCH_BLOCK_SIZE);
+
+		double Start = Preempt_Seconds();
+
+		for (uint16_t i = 0; i < (BENCH_BUFFER_SIZE / BENCH_BLOCK_SIZE); i++)
+		{
+			uint16_t SpanLength;
+			uint8_t* Span = RingBuffer_PeekSpan(&Bench_Buffer, &SpanLength);
+
+			if (SpanLength > BENCH_BLOCK_SIZE)
+			  SpanLength = BENCH_BLOCK_SIZE;
+
+			Bench_Sink = Span[0];
+			RingBuffer_RemoveSpan(&Bench_Buffer, SpanLength);
+		}
+
+		RemoveTime += (Preempt_Seconds() - Start);
+	}
+
+	Bench_Report("PeekSpan+RemoveSpan", BlockOps, (BlockOps * BENCH_BLOCK_SIZE), RemoveTime);
+}
+
+int main(int argc, char* argv[])
+{
+	uint64_t Interrupts = (argc > 1) ? strtoull(argv[1], NULL, 0) : 1000000;
+	uint32_t IntervalUS = (argc > 2) ? strtoul(argv[2], NULL, 0) : 10;
+	uint64_t Steps      = (argc > 3) ? strtoull(argv[3], NULL, 0) : 200000;
+	uint32_t MaxStride  = (argc > 4) ? strtoul(argv[4], NULL, 0) : 8;
+
+	printf("%s\n", BUFFER_VARIANT);
+
+	printf(" Exhaustive wrap tests\n");
+#if !defined(RING_BUFFER_SPSC)
+	Test_RemoveSpanWrap(13);
+	Test_PeekWrap(13);
+	Test_BlockWrap(13);
+#endif
+	Test_RemoveSpanWrap(16);
+	Test_PeekWrap(16);
+	Test_BlockWrap(16);
+
+#if defined(RING_BUFFER_SPSC)
+	printf(" Exhaustive torn index tests\n");
+	Test_TornIndex(64, 64);
+	Test_TornIndex(1024, 260);
+	#if defined(PREEMPT_HAS_STEP_MODE)
+	Test_TornIndexStepped(64);
+	#endif
+#endif
+
+	printf(" Preemption stress tests\n");
+	Stress_Run("timer: ISR Insert", true, PREEMPT_MODE_Timer, IntervalUS, Interrupts);
+	Stress_Run("timer: ISR Remove", false, PREEMPT_MODE_Timer, IntervalUS, Interrupts);
+#if defined(PREEMPT_HAS_STEP_MODE)
+	Stress_Run("step: ISR Insert", true, PREEMPT_MODE_Step, MaxStride, Steps);
+	Stress_Run("step: ISR Remove", false, PREEMPT_MODE_Step, MaxStride, Steps);
+#endif
+
+	printf(" Benchmarks\n");
+	Bench_Run(20000);
+
+	printf(" %s\n", Failures ? "FAILED" : "PASSED");
+	return (Failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
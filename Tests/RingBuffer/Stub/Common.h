@@ -0,0 +1,93 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host stand-in for LUFA/Common/Common.h, force-included ahead of the buffer headers so that they build with
+ *  the host compiler. The global interrupt mask is modelled by \ref Sim_InterruptsEnabled: while it is cleared,
+ *  a simulated interrupt raised by the preemption timer is held pending and then run from
+ *  \ref SetGlobalInterruptMask() as soon as the mask is restored, as the AVR I flag would.
+ */
+
+#ifndef __LUFA_COMMON_H__
+#define __LUFA_COMMON_H__
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdbool.h>
+		#include <string.h>
+		#include <signal.h>
+
+	/* Macros: */
+		#define ARCH_AVR8                  0
+		#define ARCH_UC3                   1
+		#define ARCH_XMEGA                 2
+
+		#if !defined(ARCH)
+			#define ARCH                   ARCH_AVR8
+		#endif
+
+		#define ATTR_ALWAYS_INLINE         __attribute__ ((always_inline))
+		#define ATTR_NON_NULL_PTR_ARG(...) __attribute__ ((nonnull (__VA_ARGS__)))
+		#define ATTR_WARN_UNUSED_RESULT    __attribute__ ((warn_unused_result))
+
+		#define GCC_MEMORY_BARRIER()       __asm__ __volatile__("" ::: "memory");
+		#define GCC_FORCE_POINTER_ACCESS(StructPtr) __asm__ __volatile__("" : "+r" (StructPtr))
+
+		#define GlobalInterruptEnable()    SetGlobalInterruptMask(true)
+		#define GlobalInterruptDisable()   do { Sim_InterruptsEnabled = false; GCC_MEMORY_BARRIER(); } while (0)
+
+	/* Type Defines: */
+		typedef uint8_t uint_reg_t;
+
+	/* External Variables: */
+		extern volatile sig_atomic_t Sim_InterruptsEnabled;
+		extern volatile sig_atomic_t Sim_InterruptPending;
+
+	/* Function Prototypes: */
+		void Sim_RunPendingInterrupt(void);
+
+	/* Inline Functions: */
+		static inline uint_reg_t GetGlobalInterruptMask(void)
+		{
+			GCC_MEMORY_BARRIER();
+			return Sim_InterruptsEnabled;
+		}
+
+		static inline void SetGlobalInterruptMask(const uint_reg_t GlobalIntState)
+		{
+			GCC_MEMORY_BARRIER();
+			Sim_InterruptsEnabled = GlobalIntState;
+
+			if (GlobalIntState && Sim_InterruptPending)
+			  Sim_RunPendingInterrupt();
+		}
+
+#endif
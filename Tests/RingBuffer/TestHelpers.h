@@ -0,0 +1,88 @@
+/*
+             LUFA Library
+     Copyright (C) Dean Camera, 2016.
+
+  dean [at] fourwalledcubicle [dot] com
+           www.lufa-lib.org
+*/
+
+/*
+  Copyright 2016  Dean Camera (dean [at] fourwalledcubicle [dot] com)
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Checking and test data helpers shared by the host ring buffer tests.
+ */
+
+#ifndef _TEST_HELPERS_H_
+#define _TEST_HELPERS_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stdio.h>
+
+	/* External Variables: */
+		extern uint32_t Failures;
+
+	/* Macros: */
+		/** Records a failed check and reports it, up to a limit. */
+		#define CHECK(Condition, ...)                                         \
+			do                                                                \
+			{                                                                 \
+				if (!(Condition) && (Failures++ < 10))                        \
+				{                                                             \
+					printf("  FAIL %s:%d: ", __FILE__, __LINE__);             \
+					printf(__VA_ARGS__);                                      \
+					printf("\n");                                             \
+				}                                                             \
+			} while (0)
+
+	/* Inline Functions: */
+		/** Advances a xorshift pseudo-random generator.
+		 *
+		 *  \param[in,out] State  Generator state, never zero.
+		 *
+		 *  \return Next pseudo-random value.
+		 */
+		static inline uint32_t NextRandom(uint32_t* const State)
+		{
+			uint32_t Value = *State;
+
+			Value ^= (Value << 13);
+			Value ^= (Value >> 17);
+			Value ^= (Value << 5);
+
+			return (*State = Value);
+		}
+
+		/** Computes the byte of the test stream at a given sequence number.
+		 *
+		 *  \param[in] Sequence  Position of the byte in the stream.
+		 *
+		 *  \return Expected value of the byte.
+		 */
+		static inline uint8_t StreamByte(const uint32_t Sequence)
+		{
+			return ((Sequence * 0x9E3779B1UL) >> 24);
+		}
+
+#endif
@@ -55,9 +55,13 @@ static bool _updatedLUFAbootloader = false;
 static RingBuffer_t USARTtoUSB_Buffer;
 
 /** Underlying data buffer for \ref USARTtoUSB_Buffer, where the stored bytes are located. */
-static uint8_t      USARTtoUSB_Buffer_Data[1024];
+static uint8_t      USARTtoUSB_Buffer_Data[USART_TO_USB_BUFFER_SIZE];
 
-static volatile uint8_t USART_Timeout = 0;
+/** Circular buffer to hold data from the host before it is sent to the serial port. */
+static RingBuffer_t USBtoUSART_Buffer;
+
+/** Underlying data buffer for \ref USBtoUSART_Buffer, where the stored bytes are located. */
+static uint8_t      USBtoUSART_Buffer_Data[USB_TO_USART_BUFFER_SIZE];
 
 /** LUFA CDC Class driver interface configuration and state information. This structure is
  *  passed to all CDC Class driver functions, so that multiple instances of the same class
@@ -72,13 +76,13 @@ USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface =
 					{
 						.Address                = CDC_TX_EPADDR,
 						.Size                   = CDC_TXRX_EPSIZE,
-						.Banks                  = 1,
+						.Banks                  = CDC_TXRX_EPBANKS,
 					},
 				.DataOUTEndpoint                =
 					{
 						.Address                = CDC_RX_EPADDR,
 						.Size                   = CDC_TXRX_EPSIZE,
-						.Banks                  = 1,
+						.Banks                  = CDC_TXRX_EPBANKS,
 					},
 				.NotificationEndpoint           =
 					{
@@ -90,6 +94,121 @@ USB_ClassInfo_CDC_Device_t VirtualSerial_CDC_Interface =
 	};
 
 
+/** Enables the USART data register empty interrupt, so that queued data from the host is sent to the serial port.
+ *  The read-modify-write of \c UCSR1B is made atomic, as the USART may be reconfigured from the USB interrupt.
+ */
+static inline void USART_EnableTransmitInterrupt(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	UCSR1B |= (1 << UDRIE1);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+#if defined(LATENCY_TRACE)
+/** Records the latency of the received bytes committed to the host so far, leaving out those still staged in the
+ *  partially filled IN endpoint bank.
+ */
+static void TraceCommittedUSARTData(void)
+{
+	uint8_t PrevEndpoint = Endpoint_GetCurrentEndpoint();
+
+	Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address);
+	LatencyTrace_BytesCommitted(Endpoint_IsINReady() ? Endpoint_BytesInEndpoint() : 0);
+
+	Endpoint_SelectEndpoint(PrevEndpoint);
+}
+#endif
+
+/** Copies contiguous spans of the USART receive buffer into the USB IN endpoint, until either runs out. Only the bytes
+ *  held when called are copied, so that a steady stream from the USART cannot keep the main loop from its other tasks.
+ */
+static void SendBufferedUSARTData(void)
+{
+	uint16_t BytesLeft = RingBuffer_GetCount(&USARTtoUSB_Buffer);
+
+	while (BytesLeft)
+	{
+		uint16_t SpanLength;
+		uint8_t* Span = RingBuffer_PeekSpan(&USARTtoUSB_Buffer, &SpanLength);
+
+		if (SpanLength > BytesLeft)
+		  SpanLength = BytesLeft;
+
+		uint16_t BytesSent = CDC_Device_SendSpan(&VirtualSerial_CDC_Interface, Span, SpanLength);
+		if (!(BytesSent))
+		  break;
+
+#if defined(LATENCY_TRACE)
+		LatencyTrace_BytesStaged(BytesSent, RingBuffer_GetCount(&USARTtoUSB_Buffer));
+		TraceCommittedUSARTData();
+#endif
+
+		RingBuffer_RemoveSpan(&USARTtoUSB_Buffer, BytesSent);
+		BytesLeft -= BytesSent;
+	}
+}
+
+/** Moves the next packet received from the host into the USART transmit buffer. The packet is only accepted once it
+ *  fits into the buffer, so that the host is NAKed instead of blocking on the USART. It is read out of the bank in one
+ *  stream pass and inserted as a block, with a single update of the buffer's count.
+ *
+ *  \return Boolean \c true if a packet was moved, \c false otherwise.
+ */
+static bool ReceiveHostPacket(void)
+{
+	if (RingBuffer_GetFreeCount(&USBtoUSART_Buffer) < CDC_TXRX_EPSIZE)
+	  return false;
+
+	uint16_t BytesReceived = CDC_Device_BytesReceived(&VirtualSerial_CDC_Interface);
+
+	if (!(BytesReceived))
+	  return false;
+
+	uint8_t Packet[CDC_TXRX_EPSIZE];
+
+	Endpoint_Read_Stream_LE(Packet, BytesReceived, NULL);
+	RingBuffer_InsertBlock(&USBtoUSART_Buffer, Packet, BytesReceived);
+
+	/* Release the bank, letting the host fill it while any other bank is drained */
+	Endpoint_ClearOUT();
+
+	if (!(FlowControl_IsTransmitPaused()))
+	  USART_EnableTransmitInterrupt();
+
+	return true;
+}
+
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+/** Enables the CDC data OUT endpoint's ready interrupt once the USART transmit buffer can accept a full packet, so
+ *  that the next packet from the host is received as soon as it arrives.
+ */
+static void ArmReceiveInterrupt(void)
+{
+	if ((USB_DeviceState != DEVICE_STATE_Configured) || (RingBuffer_GetFreeCount(&USBtoUSART_Buffer) < CDC_TXRX_EPSIZE))
+	  return;
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+
+	Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataOUTEndpoint.Address);
+	Endpoint_EnableReadyInterrupt();
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+#else
+/** Moves packets received from the host into the USART transmit buffer, until either runs out. */
+static void ReceiveHostData(void)
+{
+	while (ReceiveHostPacket());
+}
+#endif
+
 /** Main program entry point. This routine contains the overall program flow, including initial
  *  setup of all components and the main program loop.
  */
@@ -98,46 +217,90 @@ int main(void)
 	SetupHardware();
 
 	RingBuffer_InitBuffer(&USARTtoUSB_Buffer, USARTtoUSB_Buffer_Data, sizeof(USARTtoUSB_Buffer_Data));
+	RingBuffer_InitBuffer(&USBtoUSART_Buffer, USBtoUSART_Buffer_Data, sizeof(USBtoUSART_Buffer_Data));
 
 	LEDs_SetAllLEDs(LEDMASK_USB_NOTREADY);
 	GlobalInterruptEnable();
 
 	for (;;)
 	{
-		while (1)
-		{
-			int16_t ReceivedByte = CDC_Device_ReceiveByte(&VirtualSerial_CDC_Interface);
-			if (ReceivedByte < 0)
-			{
-				break;
-			}
-			while (!Serial_IsSendReady()) ;
-			Serial_SendByte(ReceivedByte);
-		}
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+		/* Host data is received from the endpoint interrupt, which is re-armed here once the buffer has room again, so
+		 * that a host streaming small packets takes at most one bank per pass of this loop */
+		ArmReceiveInterrupt();
+#else
+		ReceiveHostData();
+#endif
+
+#if (FLOW_CONTROL != FLOW_CONTROL_None)
+		/* Resume transmission of queued data once the attached device accepts it again */
+		if (!(FlowControl_IsTransmitPaused()) && !(RingBuffer_IsEmpty(&USBtoUSART_Buffer)) && !(UCSR1B & (1 << UDRIE1)))
+		  USART_EnableTransmitInterrupt();
+#endif
+
+		/* The receive ISR buffers bytes even before the host has configured the device, to keep its path short */
+		if (USB_DeviceState != DEVICE_STATE_Configured)
+		  RingBuffer_RemoveSpan(&USARTtoUSB_Buffer, RingBuffer_GetCount(&USARTtoUSB_Buffer));
+
+#if defined(EVENT_CHAR_FLUSH)
+		/* Taken before the receive buffer is read, so that the data up to the event character is sent along with it */
+		bool FlushNow = EventChar_TakeFlushRequest();
+#elif !defined(SOF_FLUSH_SCHEDULER)
+		bool FlushNow = false;
+#endif
+
+#if defined(SOF_FLUSH_SCHEDULER)
+		/* Stage received data into the IN bank as it arrives, partial banks are committed just before the next frame */
+		SendBufferedUSARTData();
+
+		if (FrameScheduler_IsCommitDue())
+		  FrameScheduler_CommitINBank(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address);
+	#if defined(EVENT_CHAR_FLUSH)
+		else if (FlushNow && !(EventChar_CommitINBank(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address)))
+		  EventChar_RequestFlush();
+	#endif
+
+	#if defined(LATENCY_TRACE)
+		TraceCommittedUSARTData();
+	#endif
 
+		/* Line encoding changes received from the USB interrupt are applied here, outside of any interrupt */
+		CDC_Device_ProcessDeferredRequests(&VirtualSerial_CDC_Interface);
+#else
 		uint16_t BufferCount = RingBuffer_GetCount(&USARTtoUSB_Buffer);
-		if ((BufferCount && TCNT1 >= USART_Timeout) // there is something to send and reception timeout fired
+		bool     TimeoutExpired = RxTimeout_IsExpired();
+		if ((BufferCount && (TimeoutExpired || FlushNow)) // there is something to send and reception timeout fired or event character received
 			|| BufferCount > sizeof(USARTtoUSB_Buffer_Data) / 2) // also send when buffer is half-full
 		{
-			Endpoint_SelectEndpoint(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address);
+			SendBufferedUSARTData();
 
-			if (Endpoint_IsINReady())
-			{
-				/* Read bytes from the USART receive buffer into the USB IN endpoint */
-				while (BufferCount--)
-				{
-					/* Try to send the next byte of data to the host, abort if there is an error without dequeuing */
-					if (CDC_Device_SendByte(&VirtualSerial_CDC_Interface,
-											RingBuffer_Peek(&USARTtoUSB_Buffer)) != ENDPOINT_READYWAIT_NoError)
-					{
-						break;
-					}
-					RingBuffer_Remove(&USARTtoUSB_Buffer);
-				}
-			}
+			if ((TimeoutExpired || FlushNow) && RingBuffer_IsEmpty(&USARTtoUSB_Buffer))
+			  RxTimeout_Flushed();
 		}
 
+	#if defined(EVENT_CHAR_FLUSH)
+		/* Send the partial bank holding the event character now, retrying while the endpoint has no bank free */
+		if (FlushNow && !(EventChar_CommitINBank(VirtualSerial_CDC_Interface.Config.DataINEndpoint.Address)))
+		  EventChar_RequestFlush();
+	#endif
+
 		CDC_Device_USBTask(&VirtualSerial_CDC_Interface);
+
+	#if defined(LATENCY_TRACE)
+		/* Both the event character commit and the CDC class flush above may have committed the partial IN bank */
+		TraceCommittedUSARTData();
+	#endif
+#endif
+
+#if (FLOW_CONTROL != FLOW_CONTROL_None)
+		/* Let the attached device transmit again once enough of the receive buffer has been sent to the host */
+		if (FlowControl_CheckLowWatermark(RingBuffer_GetCount(&USARTtoUSB_Buffer)))
+		  USART_EnableTransmitInterrupt();
+#endif
+#if defined(EVENT_CHAR_FLUSH)
+		EventChar_Task();
+#endif
+
 		USB_USBTask();
 	}
 }
@@ -154,7 +317,16 @@ void SetupHardware(void)
 	clock_prescale_set(clock_div_1);
 #endif
 
-	TCCR1B |= ((1 << CS10) | (1 << CS11)); // Set up timer at FCPU /64
+	Timestamp_Init();
+	RxTimeout_Init();
+	FlowControl_Init();
+	LineCoding_Init();
+#if defined(EVENT_CHAR_FLUSH)
+	EventChar_Init();
+#endif
+#if defined(LATENCY_TRACE)
+	LatencyTrace_Init();
+#endif
 
 #if MAGIC_KEY_POS != (RAMEND-1)
 	if (pgm_read_word(FLASHEND - 1) == NEW_LUFA_SIGNATURE) {
@@ -186,36 +358,283 @@ void EVENT_USB_Device_ConfigurationChanged(void)
 
 	ConfigSuccess &= CDC_Device_ConfigureEndpoints(&VirtualSerial_CDC_Interface);
 
+#if defined(SOF_FLUSH_SCHEDULER)
+	USB_Device_EnableSOFEvents();
+#endif
+
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+	ArmReceiveInterrupt();
+#endif
+
 	LEDs_SetAllLEDs(ConfigSuccess ? LEDMASK_USB_READY : LEDMASK_USB_ERROR);
 }
 
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+/** Event handler for the USB device endpoint ready event. Packets from the host are moved into the USART transmit
+ *  buffer straight from the USB interrupt, and the transmit interrupt started, without waiting for the main loop. One
+ *  bank is moved per event, and the interrupt is left for the main loop to re-arm: re-armed here, a host refilling
+ *  the banks as fast as they are freed would raise it again before the main loop could run.
+ */
+void EVENT_USB_Device_EndpointReady(const uint8_t EndpointAddress)
+{
+	if (EndpointAddress != VirtualSerial_CDC_Interface.Config.DataOUTEndpoint.Address)
+	  return;
+
+	ReceiveHostPacket();
+}
+#endif
+
+#if defined(SOF_FLUSH_SCHEDULER)
+/** Event handler for the USB device Start Of Frame event. */
+void EVENT_USB_Device_StartOfFrame(void)
+{
+	FrameScheduler_StartOfFrame();
+}
+#endif
+
+/** Processes the vendor specific control requests used by the host to read and reset the bridge statistics. The
+ *  USB interrupt re-enables interrupts while servicing the control endpoint, so the statistics may still change as
+ *  they are sent; a consistent snapshot of the requested block is taken with interrupts briefly held off instead.
+ */
+static void ProcessVendorRequest(void)
+{
+	if (!(Endpoint_IsSETUPReceived()))
+	  return;
+
+	switch (USB_ControlRequest.bRequest)
+	{
+		case VENDOR_REQ_GetStats:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_DEVICETOHOST | REQTYPE_VENDOR | REQREC_DEVICE))
+			{
+				static union
+				{
+#if defined(LATENCY_TRACE)
+					LatencyTrace_Stats_t   LatencyTrace;
+#endif
+					RxTimeout_Stats_t      RxTimeout[RX_TIMEOUT_POLICY_COUNT];
+#if defined(SOF_FLUSH_SCHEDULER)
+					FrameScheduler_Stats_t FrameScheduler;
+#endif
+					FlowControl_Stats_t    FlowControl;
+					LineCoding_Stats_t     LineCoding;
+#if defined(EVENT_CHAR_FLUSH)
+					EventChar_Stats_t      EventChar;
+#endif
+				} Snapshot;
+
+				const void* Stats;
+				uint16_t    StatsSize;
+
+				switch (USB_ControlRequest.wValue)
+				{
+#if defined(LATENCY_TRACE)
+					case STATS_BLOCK_LatencyTrace:
+						Stats     = &LatencyTrace_Stats;
+						StatsSize = sizeof(LatencyTrace_Stats);
+						break;
+#endif
+					case STATS_BLOCK_RxTimeout:
+						Stats     = RxTimeout_Stats;
+						StatsSize = sizeof(RxTimeout_Stats);
+						break;
+#if defined(SOF_FLUSH_SCHEDULER)
+					case STATS_BLOCK_FrameScheduler:
+						Stats     = &FrameScheduler_Stats;
+						StatsSize = sizeof(FrameScheduler_Stats);
+						break;
+#endif
+					case STATS_BLOCK_FlowControl:
+						Stats     = &FlowControl_Stats;
+						StatsSize = sizeof(FlowControl_Stats);
+						break;
+					case STATS_BLOCK_LineCoding:
+						Stats     = &LineCoding_Stats;
+						StatsSize = sizeof(LineCoding_Stats);
+						break;
+#if defined(EVENT_CHAR_FLUSH)
+					case STATS_BLOCK_EventChar:
+						Stats     = &EventChar_Stats;
+						StatsSize = sizeof(EventChar_Stats);
+						break;
+#endif
+					default:
+						return;
+				}
+
+				uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+				GlobalInterruptDisable();
+
+				memcpy(&Snapshot, Stats, StatsSize);
+
+				SetGlobalInterruptMask(CurrentGlobalInt);
+
+				Endpoint_ClearSETUP();
+				Endpoint_Write_Control_Stream_LE(&Snapshot, MIN(StatsSize, USB_ControlRequest.wLength));
+				Endpoint_ClearOUT();
+			}
+
+			break;
+		case VENDOR_REQ_ResetStats:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE))
+			{
+				Endpoint_ClearSETUP();
+				Endpoint_ClearStatusStage();
+
+#if defined(LATENCY_TRACE)
+				LatencyTrace_ResetStats();
+#endif
+				RxTimeout_ResetStats();
+#if defined(SOF_FLUSH_SCHEDULER)
+				FrameScheduler_ResetStats();
+#endif
+				FlowControl_ResetStats();
+				LineCoding_ResetStats();
+#if defined(EVENT_CHAR_FLUSH)
+				EventChar_ResetStats();
+#endif
+			}
+
+			break;
+		case VENDOR_REQ_SetTimeoutPolicy:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE))
+			{
+				if (USB_ControlRequest.wValue >= RX_TIMEOUT_POLICY_COUNT)
+				  return;
+
+				Endpoint_ClearSETUP();
+				Endpoint_ClearStatusStage();
+
+				RxTimeout_SetPolicy(USB_ControlRequest.wValue);
+			}
+
+			break;
+#if defined(EVENT_CHAR_FLUSH)
+		case VENDOR_REQ_SetEventChar:
+			if (USB_ControlRequest.bmRequestType == (REQDIR_HOSTTODEVICE | REQTYPE_VENDOR | REQREC_DEVICE))
+			{
+				Endpoint_ClearSETUP();
+				Endpoint_ClearStatusStage();
+
+				EventChar_Set(USB_ControlRequest.wValue);
+			}
+
+			break;
+#endif
+	}
+}
+
 /** Event handler for the library USB Control Request reception event. */
 void EVENT_USB_Device_ControlRequest(void)
 {
 	CDC_Device_ProcessControlRequest(&VirtualSerial_CDC_Interface);
+
+	ProcessVendorRequest();
+}
+
+/** Places a byte received from the serial port into the circular buffer for later transmission to the host, or
+ *  acts on it as a flow control character. This is called from the USART receive ISR, and with interrupts disabled
+ *  to drain the USART receiver before it is reconfigured.
+ *
+ *  \param[in] ReceivedByte  Byte read from the USART data register.
+ */
+static inline void USART_ProcessReceivedByte(const uint8_t ReceivedByte)
+{
+#if (FLOW_CONTROL == FLOW_CONTROL_XonXoff)
+	if (ReceivedByte == FLOW_CONTROL_XOFF_CHAR)
+	{
+		FlowControl_State.TransmitPaused = true;
+		FlowControl_Stats.UsbToUsartThrottled++;
+		return;
+	}
+	else if (ReceivedByte == FLOW_CONTROL_XON_CHAR)
+	{
+		FlowControl_State.TransmitPaused = false;
+
+		if (!(RingBuffer_IsEmpty(&USBtoUSART_Buffer)))
+		  UCSR1B |= (1 << UDRIE1);
+
+		return;
+	}
+#endif
+
+	/* Bytes are buffered whatever the device state, those received while the host has not configured the device are
+	 * discarded by the main loop instead of being checked for here */
+	if (RingBuffer_IsFull(&USARTtoUSB_Buffer))
+	{
+		FlowControl_Stats.UsartToUsbDropped++;
+		return;
+	}
+
+	RingBuffer_Insert(&USARTtoUSB_Buffer, ReceivedByte);
+
+	RxTimeout_ByteReceived();
+
+#if defined(EVENT_CHAR_FLUSH)
+	EventChar_ByteReceived(ReceivedByte);
+#endif
+
+#if defined(LATENCY_TRACE)
+	LatencyTrace_ByteReceived();
+#endif
+
+#if (FLOW_CONTROL != FLOW_CONTROL_None)
+	if (FlowControl_CheckHighWatermark(RingBuffer_GetCount(&USARTtoUSB_Buffer)))
+	  UCSR1B |= (1 << UDRIE1);
+#endif
 }
 
 /** ISR to manage the reception of data from the serial port, placing received bytes into a circular buffer
  *  for later transmission to the host.
+ *
+ *  With the default options each byte costs two register reads, \c UDR1 and \c TCNT1, plus \c TCNT1 and \c TIFR1
+ *  for the one byte in 2^LATENCY_TRACE_SAMPLE_SHIFT whose latency is traced; the lock-free buffer leaves interrupts
+ *  unmasked, and the Timer 1 compare unit is only armed for the first byte after a flush deadline. The native
+ *  simulation measures 60.6 cycles per byte, its 40 cycle ISR entry and exit included, against the 80 cycles between
+ *  two bytes at 2 Mbaud and 16MHz. The compare match interrupt adds 60 cycles once per deadline while bytes keep
+ *  arriving, see \ref RX_TIMEOUT_CHAR_TIMES.
  */
 ISR(USART1_RX_vect, ISR_BLOCK)
 {
-	uint8_t ReceivedByte = UDR1;
+	USART_ProcessReceivedByte(UDR1);
+}
 
-	if (USB_DeviceState != DEVICE_STATE_Configured || RingBuffer_IsFull(&USARTtoUSB_Buffer))
+/** ISR to manage the transmission of data to the serial port, sending bytes from the circular buffer filled
+ *  from the host until it is empty.
+ */
+ISR(USART1_UDRE_vect, ISR_BLOCK)
+{
+#if (FLOW_CONTROL == FLOW_CONTROL_XonXoff)
+	/* Flow control characters are sent ahead of queued data, even while transmission is paused */
+	if (FlowControl_State.PendingChar)
 	{
+		UDR1 = FlowControl_State.PendingChar;
+		LineCoding_CharacterQueued();
+		FlowControl_State.PendingChar = 0;
+
+		if (FlowControl_IsTransmitPaused() || RingBuffer_IsEmpty(&USBtoUSART_Buffer))
+		  UCSR1B &= ~(1 << UDRIE1);
+
 		return;
 	}
+#endif
 
-	if (RingBuffer_GetCount(&USARTtoUSB_Buffer))
+#if (FLOW_CONTROL != FLOW_CONTROL_None)
+	if (FlowControl_IsTransmitPaused())
 	{
-		// the timeout is twice the byte reception interval
-		USART_Timeout = TCNT1 << 2;
+		UCSR1B &= ~(1 << UDRIE1);
+
+	#if (FLOW_CONTROL == FLOW_CONTROL_RtsCts)
+		FlowControl_Stats.UsbToUsartThrottled++;
+	#endif
+		return;
 	}
+#endif
 
-	TCNT1 = 0;
+	UDR1 = RingBuffer_Remove(&USBtoUSART_Buffer);
+	LineCoding_CharacterQueued();
 
-	RingBuffer_Insert(&USARTtoUSB_Buffer, ReceivedByte);
+	if (RingBuffer_IsEmpty(&USBtoUSART_Buffer))
+	  UCSR1B &= ~(1 << UDRIE1);
 }
 
 /* Borrowed from the Arduino source code:
@@ -249,11 +668,11 @@ static void handleResetToBootloader(USB_ClassInfo_CDC_Device_t* const CDCInterfa
 		// Backup ram value if its not a newer bootloader.
 		// This should avoid memory corruption at least a bit, not fully
 		if (magic_key_pos != (RAMEND-1)) {
-			*(uint16_t *)(RAMEND-1) = *(uint16_t *)magic_key_pos;
+			_MMIO_WORD(RAMEND-1) = _MMIO_WORD(magic_key_pos);
 		}
 #endif
 		// Store boot key
-		*(uint16_t *)magic_key_pos = MAGIC_KEY;
+		_MMIO_WORD(magic_key_pos) = MAGIC_KEY;
 		wdt_enable(WDTO_120MS);
 	}
 	else
@@ -268,12 +687,12 @@ static void handleResetToBootloader(USB_ClassInfo_CDC_Device_t* const CDCInterfa
 #if MAGIC_KEY_POS != (RAMEND-1)
 		// Restore backed up (old bootloader) magic key data
 		if (magic_key_pos != (RAMEND-1)) {
-			*(uint16_t *)magic_key_pos = *(uint16_t *)(RAMEND-1);
+			_MMIO_WORD(magic_key_pos) = _MMIO_WORD(RAMEND-1);
 		} else
 #endif
 		{
 			// Clean up RAMEND key
-			*(uint16_t *)magic_key_pos = 0x0000;
+			_MMIO_WORD(magic_key_pos) = 0x0000;
 		}
 	}
 }
@@ -289,53 +708,57 @@ void EVENT_CDC_Device_ControLineStateChanged(USB_ClassInfo_CDC_Device_t* const C
  */
 void EVENT_CDC_Device_LineEncodingChanged(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo)
 {
-	handleResetToBootloader(CDCInterfaceInfo);
+	LineCoding_BeginSwitch();
 
-	uint8_t ConfigMask = 0;
+	handleResetToBootloader(CDCInterfaceInfo);
 
-	switch (CDCInterfaceInfo->State.LineEncoding.ParityType)
+	/* Keep the current settings if the requested baud rate cannot be generated accurately enough */
+	LineCoding_Registers_t Registers;
+	if (!(LineCoding_Compute(&CDCInterfaceInfo->State.LineEncoding, &Registers)))
 	{
-		case CDC_PARITY_Odd:
-			ConfigMask = ((1 << UPM11) | (1 << UPM10));
-			break;
-		case CDC_PARITY_Even:
-			ConfigMask = (1 << UPM11);
-			break;
+		LineCoding_Revert(&CDCInterfaceInfo->State.LineEncoding);
+		return;
 	}
 
-	if (CDCInterfaceInfo->State.LineEncoding.CharFormat == CDC_LINEENCODING_TwoStopBits)
-	  ConfigMask |= (1 << USBS1);
+	RxTimeout_SetLineEncoding(&CDCInterfaceInfo->State.LineEncoding);
 
-	switch (CDCInterfaceInfo->State.LineEncoding.DataBits)
-	{
-		case 6:
-			ConfigMask |= (1 << UCSZ10);
-			break;
-		case 7:
-			ConfigMask |= (1 << UCSZ11);
-			break;
-		case 8:
-			ConfigMask |= ((1 << UCSZ11) | (1 << UCSZ10));
-			break;
-	}
+	/* Send the data queued for the attached device before the change at the old settings */
+	if (!(RingBuffer_IsEmpty(&USBtoUSART_Buffer)) && !(FlowControl_IsTransmitPaused()))
+	  USART_EnableTransmitInterrupt();
 
-	/* Keep the TX line held high (idle) while the USART is reconfigured */
-	PORTD |= (1 << 3);
+	LineCoding_DrainQueued(RingBuffer_GetCount(&USBtoUSART_Buffer));
 
-	/* Must turn off USART before reconfiguring it, otherwise incorrect operation may occur */
-	UCSR1B = 0;
-	UCSR1A = 0;
-	UCSR1C = 0;
+	/* Stop queueing data for the attached device, and let the characters already written finish at the old settings */
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+	UCSR1B &= ~(1 << UDRIE1);
+	SetGlobalInterruptMask(CurrentGlobalInt);
 
-	/* Set the new baud rate before configuring the USART */
-	UBRR1  = SERIAL_2X_UBBRVAL(CDCInterfaceInfo->State.LineEncoding.BaudRateBPS);
+	LineCoding_WaitTransmitIdle();
 
-	/* Reconfigure the USART in double speed mode for a wider baud rate range at the expense of accuracy */
-	UCSR1C = ConfigMask;
-	UCSR1A = (1 << U2X1);
-	UCSR1B = ((1 << RXCIE1) | (1 << TXEN1) | (1 << RXEN1));
+	GlobalInterruptDisable();
 
-	/* Release the TX line after the USART has been reconfigured */
-	PORTD &= ~(1 << 3);
-}
+	/* Keep the bytes still held in the USART receiver, which are lost when it is reset */
+	while (UCSR1A & (1 << RXC1))
+	  USART_ProcessReceivedByte(UDR1);
+
+	LineCoding_Apply(&Registers);
 
+	/* Resume transmission of any data still queued from the host */
+	if (!(RingBuffer_IsEmpty(&USBtoUSART_Buffer)) && !(FlowControl_IsTransmitPaused()))
+	  UCSR1B |= (1 << UDRIE1);
+
+#if (FLOW_CONTROL == FLOW_CONTROL_XonXoff)
+	if (FlowControl_State.PendingChar)
+	  UCSR1B |= (1 << UDRIE1);
+#endif
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	/* Stage the data received at the old settings for the host ahead of anything received at the new settings */
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+	SendBufferedUSARTData();
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+	LineCoding_RecordSwitch();
+}
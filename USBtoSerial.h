@@ -43,14 +43,72 @@
 		#include <avr/power.h>
 
 		#include "Descriptors.h"
+		#include "Config/AppConfig.h"
+		#include "Lib/Timestamp.h"
+		#include "Lib/RxTimeout.h"
+		#include "Lib/FrameScheduler.h"
+		#include "Lib/FlowControl.h"
+		#include "Lib/LatencyTrace.h"
+		#include "Lib/LineCoding.h"
+		#include "Lib/EventChar.h"
 
 		#include <LUFA/Drivers/Board/LEDs.h>
 		#include <LUFA/Drivers/Peripheral/Serial.h>
-		#include <LUFA/Drivers/Misc/RingBuffer.h>
+		#if defined(USE_LOCKFREE_RING_BUFFER)
+			#include <LUFA/Drivers/Misc/RingBufferSPSC.h>
+		#else
+			#include <LUFA/Drivers/Misc/RingBuffer.h>
+		#endif
 		#include <LUFA/Drivers/USB/USB.h>
 		#include <LUFA/Platform/Platform.h>
 
+	/* Preprocessor Checks: */
+		#if defined(USE_LOCKFREE_RING_BUFFER)
+			#if ((USART_TO_USB_BUFFER_SIZE & (USART_TO_USB_BUFFER_SIZE - 1)) || (USART_TO_USB_BUFFER_SIZE > 16384))
+				#error USART_TO_USB_BUFFER_SIZE must be a power of two no larger than 16384 when USE_LOCKFREE_RING_BUFFER is defined.
+			#elif ((USB_TO_USART_BUFFER_SIZE & (USB_TO_USART_BUFFER_SIZE - 1)) || (USB_TO_USART_BUFFER_SIZE > 16384))
+				#error USB_TO_USART_BUFFER_SIZE must be a power of two no larger than 16384 when USE_LOCKFREE_RING_BUFFER is defined.
+			#endif
+		#endif
+
 	/* Macros: */
+		/** Size in bytes of the default control endpoint's bank. */
+		#if defined(FIXED_CONTROL_ENDPOINT_SIZE)
+			#define CONTROL_EPSIZE            FIXED_CONTROL_ENDPOINT_SIZE
+		#else
+			#define CONTROL_EPSIZE            ENDPOINT_CONTROLEP_DEFAULT_SIZE
+		#endif
+
+		/** Bytes of the USB controller's DPRAM used by all of the device's endpoints, for the given number of banks
+		 *  on each CDC data endpoint.
+		 */
+		#define CDC_DPRAM_USAGE(DataBanks) (ENDPOINT_DPRAM_USAGE(CONTROL_EPSIZE, 1) +                 \
+		                                    ENDPOINT_DPRAM_USAGE(CDC_NOTIFICATION_EPSIZE, 1) +        \
+		                                    ENDPOINT_DPRAM_USAGE(CDC_TXRX_EPSIZE, DataBanks) * 2)
+
+		#if !defined(CDC_TXRX_EPBANKS)
+			/** Number of banks of the CDC data endpoints, double banked when the device's DPRAM can hold them. */
+			#if (CDC_DPRAM_USAGE(2) <= ENDPOINT_DPRAM_SIZE)
+				#define CDC_TXRX_EPBANKS      2
+			#else
+				#define CDC_TXRX_EPBANKS      1
+			#endif
+		#endif
+
+		#if (CDC_DPRAM_USAGE(CDC_TXRX_EPBANKS) > ENDPOINT_DPRAM_SIZE)
+			#error The CDC endpoints do not fit in the USB controller DPRAM, reduce CDC_TXRX_EPBANKS or CDC_TXRX_EPSIZE.
+		#endif
+
+		#if defined(ORDERED_EP_CONFIG) && \
+		    (((CDC_TX_EPADDR & ENDPOINT_EPNUM_MASK) >= (CDC_RX_EPADDR & ENDPOINT_EPNUM_MASK)) || \
+		     ((CDC_RX_EPADDR & ENDPOINT_EPNUM_MASK) >= (CDC_NOTIFICATION_EPADDR & ENDPOINT_EPNUM_MASK)))
+			#error The CDC endpoints must be numbered in the order they are configured when ORDERED_EP_CONFIG is defined.
+		#endif
+
+		#if defined(LATENCY_TRACE) && (USART_TO_USB_BUFFER_SIZE < CDC_TXRX_EPSIZE)
+			#error USART_TO_USB_BUFFER_SIZE must be at least CDC_TXRX_EPSIZE when LATENCY_TRACE is defined.
+		#endif
+
 		/** LED mask for the library LED driver, to indicate that the USB interface is not ready. */
 		#define LEDMASK_USB_NOTREADY      LEDS_LED1
 
@@ -63,6 +121,36 @@
 		/** LED mask for the library LED driver, to indicate that an error has occurred in the USB interface. */
 		#define LEDMASK_USB_ERROR        (LEDS_LED1 | LEDS_LED3)
 
+	/* Enums: */
+		/** Enum for the vendor specific control requests handled by the device, addressed to the device recipient. */
+		enum USBtoSerial_VendorRequests_t
+		{
+			VENDOR_REQ_GetStats         = 0x01, /**< Device-to-host request, reading the statistics block selected by \c wValue,
+			                                     *   a value from \ref USBtoSerial_StatsBlocks_t.
+			                                     */
+			VENDOR_REQ_ResetStats       = 0x02, /**< Host-to-device request, clearing all statistics. */
+			VENDOR_REQ_SetTimeoutPolicy = 0x03, /**< Host-to-device request, selecting the receive timeout policy given in
+			                                     *   \c wValue, a value from \ref RxTimeout_Policies_t.
+			                                     */
+			VENDOR_REQ_SetEventChar     = 0x04, /**< Host-to-device request, setting the event character to the low byte of
+			                                     *   \c wValue, enabled when \ref EVENT_CHAR_ENABLE_MASK is set, when
+			                                     *   \c EVENT_CHAR_FLUSH is defined.
+			                                     */
+		};
+
+		/** Enum for the statistics blocks which can be read with \ref VENDOR_REQ_GetStats. Each block is sent as the
+		 *  little endian in-memory image of its structure.
+		 */
+		enum USBtoSerial_StatsBlocks_t
+		{
+			STATS_BLOCK_LatencyTrace    = 0, /**< \ref LatencyTrace_Stats_t, when \c LATENCY_TRACE is defined. */
+			STATS_BLOCK_RxTimeout       = 1, /**< Array of \ref RxTimeout_Stats_t, one for each receive timeout policy. */
+			STATS_BLOCK_FrameScheduler  = 2, /**< \ref FrameScheduler_Stats_t, when \c SOF_FLUSH_SCHEDULER is defined. */
+			STATS_BLOCK_FlowControl     = 3, /**< \ref FlowControl_Stats_t. */
+			STATS_BLOCK_LineCoding      = 4, /**< \ref LineCoding_Stats_t. */
+			STATS_BLOCK_EventChar       = 5, /**< \ref EventChar_Stats_t, when \c EVENT_CHAR_FLUSH is defined. */
+		};
+
 	/* Function Prototypes: */
 		void SetupHardware(void);
 
@@ -70,6 +158,8 @@
 		void EVENT_USB_Device_Disconnect(void);
 		void EVENT_USB_Device_ConfigurationChanged(void);
 		void EVENT_USB_Device_ControlRequest(void);
+		void EVENT_USB_Device_StartOfFrame(void);
+		void EVENT_USB_Device_EndpointReady(const uint8_t EndpointAddress);
 
 		void EVENT_CDC_Device_LineEncodingChanged(USB_ClassInfo_CDC_Device_t* const CDCInterfaceInfo);
 